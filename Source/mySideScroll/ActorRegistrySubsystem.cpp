@@ -0,0 +1,212 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ActorRegistrySubsystem.h"
+#include "mySideScroll.h"
+#include "GameFramework/PlayerStart.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "Engine/Engine.h"
+#include "EngineUtils.h"
+
+bool UActorRegistrySubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UActorRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// player starts in streamed levels come and go with their level
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UActorRegistrySubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UActorRegistrySubsystem::OnLevelRemoved);
+}
+
+void UActorRegistrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// player starts are engine actors, so gather them instead of having them register themselves
+	for (TActorIterator<APlayerStart> It(&InWorld); It; ++It)
+	{
+		RegisterActor(*It, EActorRegistryCategory::PlayerStart);
+	}
+}
+
+void UActorRegistrySubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	// levels added before begin play are gathered by OnWorldBeginPlay
+	if (!Level || World != GetWorld() || !World->HasBegunPlay())
+	{
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (APlayerStart* PlayerStart = Cast<APlayerStart>(Actor))
+		{
+			RegisterActor(PlayerStart, EActorRegistryCategory::PlayerStart);
+		}
+	}
+}
+
+void UActorRegistrySubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	// a null level means every level is being removed
+	FActorRegistryBucket& Bucket = GetBucket(EActorRegistryCategory::PlayerStart);
+
+	for (int32 i = Bucket.Actors.Num() - 1; i >= 0; --i)
+	{
+		const AActor* Actor = Bucket.Actors[i];
+
+		if (!Level || !Actor || Actor->GetLevel() == Level)
+		{
+			RemoveAt(Bucket, i);
+		}
+	}
+}
+
+void UActorRegistrySubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	for (FActorRegistryBucket& Bucket : Buckets)
+	{
+		Bucket.Actors.Empty();
+		Bucket.Keys.Empty();
+		Bucket.Indices.Empty();
+	}
+
+	Super::Deinitialize();
+}
+
+void UActorRegistrySubsystem::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UActorRegistrySubsystem* This = CastChecked<UActorRegistrySubsystem>(InThis);
+
+	for (FActorRegistryBucket& Bucket : This->Buckets)
+	{
+		Collector.AddReferencedObjects(Bucket.Actors);
+	}
+
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+void UActorRegistrySubsystem::RegisterActor(AActor* Actor, EActorRegistryCategory Category)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	FActorRegistryBucket& Bucket = GetBucket(Category);
+
+	// is the actor already registered?
+	if (Bucket.Indices.Contains(Actor))
+	{
+		return;
+	}
+
+	Bucket.Indices.Add(Actor, Bucket.Actors.Add(Actor));
+	Bucket.Keys.Add(Actor);
+
+	if (Category == EActorRegistryCategory::Enemy)
+	{
+		PublishEnemiesAlive();
+	}
+}
+
+void UActorRegistrySubsystem::UnregisterActor(AActor* Actor, EActorRegistryCategory Category)
+{
+	FActorRegistryBucket& Bucket = GetBucket(Category);
+
+	if (const int32* Index = Bucket.Indices.Find(Actor))
+	{
+		RemoveAt(Bucket, *Index);
+
+		if (Category == EActorRegistryCategory::Enemy)
+		{
+			PublishEnemiesAlive();
+		}
+	}
+}
+
+void UActorRegistrySubsystem::PublishEnemiesAlive() const
+{
+	// clients see the same enemies as their server, so only the world running the game reports them
+	if (GetWorld()->GetNetMode() != NM_Client)
+	{
+		SideScrollCounters::SetEnemiesAlive(GetNumEnemiesAlive());
+	}
+}
+
+void UActorRegistrySubsystem::RemoveAt(FActorRegistryBucket& Bucket, int32 Index)
+{
+	Bucket.Indices.Remove(Bucket.Keys[Index]);
+
+	// swap the last actor into the freed slot to keep the array compact
+	Bucket.Actors.RemoveAtSwap(Index, EAllowShrinking::No);
+	Bucket.Keys.RemoveAtSwap(Index, EAllowShrinking::No);
+
+	if (Bucket.Keys.IsValidIndex(Index))
+	{
+		Bucket.Indices[Bucket.Keys[Index]] = Index;
+	}
+}
+
+const TArray<TObjectPtr<AActor>>& UActorRegistrySubsystem::GetActors(EActorRegistryCategory Category) const
+{
+	return GetBucket(Category).Actors;
+}
+
+AActor* UActorRegistrySubsystem::GetFirstActor(EActorRegistryCategory Category) const
+{
+	const TArray<TObjectPtr<AActor>>& Actors = GetBucket(Category).Actors;
+
+	return Actors.Num() > 0 ? Actors[0].Get() : nullptr;
+}
+
+APawn* UActorRegistrySubsystem::GetPlayerPawn() const
+{
+	return GetFirstActor<APawn>(EActorRegistryCategory::Player);
+}
+
+APawn* UActorRegistrySubsystem::GetNearestPlayerPawn(const FVector& Location) const
+{
+	APawn* NearestPawn = nullptr;
+	double NearestDistSquared = TNumericLimits<double>::Max();
+
+	for (AActor* Actor : GetActors(EActorRegistryCategory::Player))
+	{
+		APawn* Pawn = Cast<APawn>(Actor);
+
+		if (!IsValid(Pawn))
+		{
+			continue;
+		}
+
+		const double DistSquared = FVector::DistSquared(Location, Pawn->GetActorLocation());
+
+		if (DistSquared < NearestDistSquared)
+		{
+			NearestPawn = Pawn;
+			NearestDistSquared = DistSquared;
+		}
+	}
+
+	return NearestPawn;
+}
+
+UActorRegistrySubsystem* UActorRegistrySubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<UActorRegistrySubsystem>() : nullptr;
+}
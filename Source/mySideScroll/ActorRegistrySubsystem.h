@@ -0,0 +1,132 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "ActorRegistrySubsystem.generated.h"
+
+class APawn;
+class ULevel;
+
+/**
+ *  Categories of actors tracked by the actor registry
+ */
+UENUM(BlueprintType)
+enum class EActorRegistryCategory : uint8
+{
+	PlayerStart		UMETA(DisplayName = "Player Start"),
+	Spawner			UMETA(DisplayName = "Spawner"),
+	Checkpoint		UMETA(DisplayName = "Checkpoint"),
+	Interactable	UMETA(DisplayName = "Interactable"),
+	Player			UMETA(DisplayName = "Player"),
+	Enemy			UMETA(DisplayName = "Enemy"),
+
+	Num				UMETA(Hidden)
+};
+
+/**
+ *  Compact list of registered actors for a single category
+ */
+struct FActorRegistryBucket
+{
+	/** Registered actors, in no particular order */
+	TArray<TObjectPtr<AActor>> Actors;
+
+	/** Object key of each registered actor, parallel to the Actors array. Still valid after the actor is collected */
+	TArray<TObjectKey<AActor>> Keys;
+
+	/** Index of each actor in the Actors array, for constant time removal. Keyed on the object key so collected actors can't alias new ones */
+	TMap<TObjectKey<AActor>, int32> Indices;
+};
+
+/**
+ *  Keeps track of gameplay actors by category so they can be looked up without scanning the world
+ *  Actors register on BeginPlay and unregister on EndPlay. Player starts are gathered when the world begins play
+ *  and whenever a streamed level is added to or removed from the world
+ *  Players are registered by their player controllers on possession
+ *  Enemies are registered while they're alive, which also keeps the per world enemy count
+ */
+UCLASS()
+class MYSIDESCROLL_API UActorRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Registered actors for each category */
+	FActorRegistryBucket Buckets[static_cast<uint8>(EActorRegistryCategory::Num)];
+
+	/** Streamed level delegate handles */
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Subscribes to streamed level changes */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Gathers the placed player starts */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Used to reference the registered actors */
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
+public:
+
+	/** Adds an actor to the provided category. Does nothing if it's already registered */
+	void RegisterActor(AActor* Actor, EActorRegistryCategory Category);
+
+	/** Removes an actor from the provided category */
+	void UnregisterActor(AActor* Actor, EActorRegistryCategory Category);
+
+	/** Returns all actors registered in the provided category */
+	const TArray<TObjectPtr<AActor>>& GetActors(EActorRegistryCategory Category) const;
+
+	/** Returns the first registered actor in the provided category, or nullptr if there's none */
+	AActor* GetFirstActor(EActorRegistryCategory Category) const;
+
+	/** Returns the first registered actor in the provided category cast to the requested type */
+	template<typename T>
+	T* GetFirstActor(EActorRegistryCategory Category) const
+	{
+		return Cast<T>(GetFirstActor(Category));
+	}
+
+	/** Returns the first registered player pawn */
+	APawn* GetPlayerPawn() const;
+
+	/** Returns the registered player pawn closest to the provided location, so enemies can pick a target in multiplayer games */
+	APawn* GetNearestPlayerPawn(const FVector& Location) const;
+
+	/** Returns the number of living enemies in this world */
+	int32 GetNumEnemiesAlive() const { return GetBucket(EActorRegistryCategory::Enemy).Actors.Num(); }
+
+	/** Convenience accessor from any world context object */
+	static UActorRegistrySubsystem* Get(const UObject* WorldContextObject);
+
+protected:
+
+	/** Registers the player starts placed in a streamed level */
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+
+	/** Unregisters the player starts placed in a streamed level */
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+
+	/** Publishes the enemy count to the SideScroll counters */
+	void PublishEnemiesAlive() const;
+
+	/** Removes the actor at the provided index from a bucket */
+	static void RemoveAt(FActorRegistryBucket& Bucket, int32 Index);
+
+	/** Returns the bucket for a category */
+	FActorRegistryBucket& GetBucket(EActorRegistryCategory Category) { return Buckets[static_cast<uint8>(Category)]; }
+	const FActorRegistryBucket& GetBucket(EActorRegistryCategory Category) const { return Buckets[static_cast<uint8>(Category)]; }
+};
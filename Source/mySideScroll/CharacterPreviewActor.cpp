@@ -1,29 +1,35 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CharacterPreviewActor.h"
+#include "SideScrollMemory.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/SceneComponent.h"
+#include "GameFramework/RotatingMovementComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Animation/AnimInstance.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 
 ACharacterPreviewActor::ACharacterPreviewActor()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	LLM_SCOPE_BYTAG(SideScroll_Preview);
+
+	// Rotation is handled by the rotating movement component
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Create root component
 	RootSceneComponent = CreateDefaultSubobject<USceneComponent>(TEXT("RootSceneComponent"));
 	RootComponent = RootSceneComponent;
 
-	// Create skeletal mesh components for each character type
-	SideScrollingMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("SideScrollingMesh"));
-	SideScrollingMesh->SetupAttachment(RootComponent);
-	SideScrollingMesh->SetVisibility(false);
-
-	PlatformingMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("PlatformingMesh"));
-	PlatformingMesh->SetupAttachment(RootComponent);
-	PlatformingMesh->SetVisibility(false);
+	// Create the single preview mesh. Its assets are streamed in on selection
+	PreviewMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("PreviewMesh"));
+	PreviewMesh->SetupAttachment(RootComponent);
+	PreviewMesh->SetVisibility(false);
+	PreviewMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	PreviewMesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
 
-	CombatMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("CombatMesh"));
-	CombatMesh->SetupAttachment(RootComponent);
-	CombatMesh->SetVisibility(false);
+	// Create the rotating movement component
+	RotatingMovement = CreateDefaultSubobject<URotatingMovementComponent>(TEXT("RotatingMovement"));
 
 	// Set default values
 	CurrentCharacterType = ECharacterType::SideScrolling;
@@ -34,22 +40,29 @@ ACharacterPreviewActor::ACharacterPreviewActor()
 void ACharacterPreviewActor::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// Set up the preview rotation
+	RotatingMovement->RotationRate = FRotator(0.0f, RotationSpeed, 0.0f);
+	SetAutoRotate(bAutoRotate);
 	
 	// Set initial character type
 	SetCharacterType(CurrentCharacterType);
 }
 
-void ACharacterPreviewActor::Tick(float DeltaTime)
+void ACharacterPreviewActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	Super::EndPlay(EndPlayReason);
 
-	// Auto-rotate the character if enabled
-	if (bAutoRotate)
+	// Release all streamed preview assets
+	for (FCharacterPreviewCacheEntry& Entry : PreviewCache)
 	{
-		FRotator CurrentRotation = GetActorRotation();
-		CurrentRotation.Yaw += RotationSpeed * DeltaTime;
-		SetActorRotation(CurrentRotation);
+		if (Entry.Handle.IsValid())
+		{
+			Entry.Handle->CancelHandle();
+		}
 	}
+
+	PreviewCache.Empty();
 }
 
 void ACharacterPreviewActor::SetCharacterType(ECharacterType CharacterType)
@@ -58,28 +71,135 @@ void ACharacterPreviewActor::SetCharacterType(ECharacterType CharacterType)
 	UpdateVisibleMesh();
 }
 
+void ACharacterPreviewActor::SetAutoRotate(bool bEnabled)
+{
+	bAutoRotate = bEnabled;
+	RotatingMovement->RotationRate = FRotator(0.0f, RotationSpeed, 0.0f);
+	RotatingMovement->SetActive(bEnabled);
+}
+
 void ACharacterPreviewActor::UpdateVisibleMesh()
 {
-	// Hide all meshes first
-	SideScrollingMesh->SetVisibility(false);
-	PlatformingMesh->SetVisibility(false);
-	CombatMesh->SetVisibility(false);
+	LLM_SCOPE_BYTAG(SideScroll_Preview);
+
+	// Is this character already in the cache?
+	const int32 CacheIndex = PreviewCache.IndexOfByPredicate([this](const FCharacterPreviewCacheEntry& Entry) { return Entry.CharacterType == CurrentCharacterType; });
 
-	// Show the appropriate mesh based on character type
-	switch (CurrentCharacterType)
+	if (CacheIndex != INDEX_NONE)
+	{
+		// Move it to the most recently used slot
+		FCharacterPreviewCacheEntry Entry = MoveTemp(PreviewCache[CacheIndex]);
+		PreviewCache.RemoveAt(CacheIndex);
+
+		const bool bLoaded = !Entry.Handle.IsValid() || Entry.Handle->HasLoadCompleted();
+		PreviewCache.Add(MoveTemp(Entry));
+
+		// Show it right away if it's done streaming, otherwise hide the previous character until the pending load shows it
+		if (bLoaded)
+		{
+			ApplyPreviewAssets(GetPreviewAssets(CurrentCharacterType));
+		}
+		else
+		{
+			PreviewMesh->SetVisibility(false);
+		}
+
+		return;
+	}
+
+	// Hide the previous character while the new one streams in
+	PreviewMesh->SetVisibility(false);
+
+	// Gather the assets to stream
+	const FCharacterPreviewAssets& Assets = GetPreviewAssets(CurrentCharacterType);
+
+	TArray<FSoftObjectPath> AssetsToLoad;
+
+	if (!Assets.Mesh.IsNull())
+	{
+		AssetsToLoad.Add(Assets.Mesh.ToSoftObjectPath());
+	}
+
+	if (!Assets.AnimClass.IsNull())
+	{
+		AssetsToLoad.Add(Assets.AnimClass.ToSoftObjectPath());
+	}
+
+	FCharacterPreviewCacheEntry& NewEntry = PreviewCache.AddDefaulted_GetRef();
+	NewEntry.CharacterType = CurrentCharacterType;
+
+	if (AssetsToLoad.Num() > 0)
+	{
+		FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+		NewEntry.Handle = StreamableManager.RequestAsyncLoad(AssetsToLoad, FStreamableDelegate::CreateUObject(this, &ACharacterPreviewActor::OnPreviewAssetsLoaded, CurrentCharacterType));
+	}
+
+	TrimPreviewCache();
+}
+
+void ACharacterPreviewActor::OnPreviewAssetsLoaded(ECharacterType CharacterType)
+{
+	// Ignore loads for characters that are no longer selected. They stay in the cache
+	if (CharacterType != CurrentCharacterType)
+	{
+		return;
+	}
+
+	ApplyPreviewAssets(GetPreviewAssets(CharacterType));
+}
+
+void ACharacterPreviewActor::ApplyPreviewAssets(const FCharacterPreviewAssets& Assets)
+{
+	LLM_SCOPE_BYTAG(SideScroll_Preview);
+
+	USkeletalMesh* Mesh = Assets.Mesh.Get();
+
+	if (!Mesh)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No preview mesh loaded for character type: %d"), (int32)CurrentCharacterType);
+
+		PreviewMesh->SetVisibility(false);
+		return;
+	}
+
+	// Swap the mesh and animation
+	PreviewMesh->SetSkeletalMesh(Mesh);
+
+	if (UClass* AnimClass = Assets.AnimClass.Get())
+	{
+		PreviewMesh->SetAnimInstanceClass(AnimClass);
+	}
+
+	PreviewMesh->SetVisibility(true);
+}
+
+const FCharacterPreviewAssets& ACharacterPreviewActor::GetPreviewAssets(ECharacterType CharacterType) const
+{
+	switch (CharacterType)
 	{
-	case ECharacterType::SideScrolling:
-		SideScrollingMesh->SetVisibility(true);
-		break;
 	case ECharacterType::Platforming:
-		PlatformingMesh->SetVisibility(true);
-		break;
+		return PlatformingPreview;
 	case ECharacterType::Combat:
-		CombatMesh->SetVisibility(true);
-		break;
+		return CombatPreview;
 	default:
 		// Default to side scrolling character
-		SideScrollingMesh->SetVisibility(true);
-		break;
+		return SideScrollingPreview;
+	}
+}
+
+void ACharacterPreviewActor::TrimPreviewCache()
+{
+	// Keep the current character plus the configured number of previous ones
+	const int32 MaxEntries = FMath::Max(PreviewCacheSize, 0) + 1;
+
+	while (PreviewCache.Num() > MaxEntries)
+	{
+		// Release the least recently used assets
+		if (PreviewCache[0].Handle.IsValid())
+		{
+			PreviewCache[0].Handle->CancelHandle();
+		}
+
+		PreviewCache.RemoveAt(0);
 	}
-} 
\ No newline at end of file
+}
@@ -6,12 +6,49 @@
 #include "GameFramework/Actor.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/SceneComponent.h"
+#include "UObject/SoftObjectPtr.h"
 #include "CharacterSelectionWidget.h"
 #include "CharacterPreviewActor.generated.h"
 
+class URotatingMovementComponent;
+class USkeletalMesh;
+class UAnimInstance;
+struct FStreamableHandle;
+
+/**
+ * Assets used to preview a character type. Soft referenced so they're only streamed in when the type is selected
+ */
+USTRUCT(BlueprintType)
+struct FCharacterPreviewAssets
+{
+	GENERATED_BODY()
+
+	/** Skeletal mesh to display */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Preview")
+	TSoftObjectPtr<USkeletalMesh> Mesh;
+
+	/** Animation class to run on the mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Preview")
+	TSoftClassPtr<UAnimInstance> AnimClass;
+};
+
+/**
+ * Cached streaming handle for a previously displayed character type
+ */
+struct FCharacterPreviewCacheEntry
+{
+	/** Character type the assets belong to */
+	ECharacterType CharacterType = ECharacterType::None;
+
+	/** Handle keeping the assets loaded */
+	TSharedPtr<FStreamableHandle> Handle;
+};
+
 /**
  * Actor that displays character previews in the selection menu
  * Shows the different character meshes for players to see before selecting
+ * A single mesh component is used; each character's assets are streamed in on selection
+ * and the most recently displayed ones are kept in a small LRU cache
  */
 UCLASS()
 class MYSIDESCROLL_API ACharacterPreviewActor : public AActor
@@ -24,23 +61,34 @@ public:
 protected:
 	virtual void BeginPlay() override;
 
-public:	
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 protected:
 	/** Root scene component */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USceneComponent* RootSceneComponent;
 
-	/** Skeletal mesh components for different character types */
+	/** Skeletal mesh component that displays the current character */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
-	USkeletalMeshComponent* SideScrollingMesh;
+	USkeletalMeshComponent* PreviewMesh;
 
+	/** Rotates the preview without requiring an actor tick */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
-	USkeletalMeshComponent* PlatformingMesh;
+	URotatingMovementComponent* RotatingMovement;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
-	USkeletalMeshComponent* CombatMesh;
+	/** Preview assets for each character type */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Preview")
+	FCharacterPreviewAssets SideScrollingPreview;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Preview")
+	FCharacterPreviewAssets PlatformingPreview;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Preview")
+	FCharacterPreviewAssets CombatPreview;
+
+	/** Number of previously displayed characters to keep loaded, in addition to the current one */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Preview", meta = (ClampMin = 0, ClampMax = 2))
+	int32 PreviewCacheSize = 1;
 
 	/** Current character being displayed */
 	UPROPERTY(BlueprintReadOnly, Category = "Preview")
@@ -54,6 +102,9 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Preview")
 	bool bAutoRotate;
 
+	/** Streaming handles for the current and recently displayed characters, least recently used first */
+	TArray<FCharacterPreviewCacheEntry> PreviewCache;
+
 public:
 	/** Set which character type to display */
 	UFUNCTION(BlueprintCallable, Category = "Preview")
@@ -63,7 +114,23 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Preview")
 	ECharacterType GetCurrentCharacterType() const { return CurrentCharacterType; }
 
+	/** Enables or disables the automatic preview rotation */
+	UFUNCTION(BlueprintCallable, Category = "Preview")
+	void SetAutoRotate(bool bEnabled);
+
 protected:
-	/** Update which mesh is visible */
+	/** Streams in the assets for the current character type, reusing the cache when possible */
 	void UpdateVisibleMesh();
-}; 
\ No newline at end of file
+
+	/** Called when a character type's preview assets finish streaming */
+	void OnPreviewAssetsLoaded(ECharacterType CharacterType);
+
+	/** Applies the loaded preview assets to the mesh component */
+	void ApplyPreviewAssets(const FCharacterPreviewAssets& Assets);
+
+	/** Get the preview assets for a character type */
+	const FCharacterPreviewAssets& GetPreviewAssets(ECharacterType CharacterType) const;
+
+	/** Releases the least recently used handles over the cache budget */
+	void TrimPreviewCache();
+};
@@ -144,6 +144,9 @@ void UCharacterSelectionWidget::NavigateLeft()
 	CurrentSelection = CharacterTypes[CurrentSelectionIndex];
 	UpdateCharacterInfo(CurrentSelection);
 	UpdateButtonHighlight();
+
+	// Let listeners start preloading the highlighted character
+	OnCharacterHighlighted.Broadcast(CurrentSelection);
 }
 
 void UCharacterSelectionWidget::NavigateRight()
@@ -157,6 +160,9 @@ void UCharacterSelectionWidget::NavigateRight()
 	CurrentSelection = CharacterTypes[CurrentSelectionIndex];
 	UpdateCharacterInfo(CurrentSelection);
 	UpdateButtonHighlight();
+
+	// Let listeners start preloading the highlighted character
+	OnCharacterHighlighted.Broadcast(CurrentSelection);
 }
 
 void UCharacterSelectionWidget::ConfirmSelection()
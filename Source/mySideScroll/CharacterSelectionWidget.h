@@ -21,6 +21,7 @@ enum class ECharacterType : uint8
 };
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCharacterSelected, ECharacterType, SelectedCharacter);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCharacterHighlighted, ECharacterType, HighlightedCharacter);
 
 /**
  * Character Selection Menu Widget
@@ -43,6 +44,10 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Character Selection")
 	FOnCharacterSelected OnCharacterSelected;
 
+	/** Delegate called when the highlighted character changes, before it is confirmed */
+	UPROPERTY(BlueprintAssignable, Category = "Character Selection")
+	FOnCharacterHighlighted OnCharacterHighlighted;
+
 protected:
 	/** Character selection buttons */
 	UPROPERTY(meta = (BindWidget))
@@ -1,7 +1,8 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CustomSideScrollCharacter.h"
-#include "GameFramework/CharacterMovementComponent.h"
+#include "mySideScroll.h"
+#include "SideScrollingMovementComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Components/InputComponent.h"
@@ -11,9 +12,11 @@
 #include "Engine/World.h"
 #include "Variant_SideScrolling/SideScrollingInteractable.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "TimerManager.h"
+#include "Variant_SideScrolling/SideScrollingPlayerController.h"
+#include "InputLatencyTracker.h"
 
-ACustomSideScrollCharacter::ACustomSideScrollCharacter()
+ACustomSideScrollCharacter::ACustomSideScrollCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USideScrollingMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -51,9 +54,6 @@ ACustomSideScrollCharacter::ACustomSideScrollCharacter()
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 750.0f, 0.0f);
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 
-	GetCharacterMovement()->SetPlaneConstraintNormal(FVector(0.0f, 1.0f, 0.0f));
-	GetCharacterMovement()->bConstrainToPlane = true;
-
 	// enable double jump
 	JumpMaxCount = 2;
 }
@@ -63,7 +63,10 @@ void ACustomSideScrollCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 
 	// clear the wall jump timer
-	GetWorld()->GetTimerManager().ClearTimer(WallJumpTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(WallJumpTimer);
+	}
 }
 
 void ACustomSideScrollCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent)
@@ -119,6 +122,17 @@ void ACustomSideScrollCharacter::Landed(const FHitResult& Hit)
 	bHasDoubleJumped = false;
 }
 
+void ACustomSideScrollCharacter::OnJumped_Implementation()
+{
+	Super::OnJumped_Implementation();
+
+	// the jump has executed on the movement component. Only our own input is being measured, not remote players or AI
+	if (IsLocallyControlled() && IsPlayerControlled())
+	{
+		FInputLatencyTracker::EndAction(EInputLatencyAction::Jump);
+	}
+}
+
 void ACustomSideScrollCharacter::Move(const FInputActionValue& Value)
 {
 	FVector2D MoveVector = Value.Get<FVector2D>();
@@ -163,8 +177,17 @@ void ACustomSideScrollCharacter::DoDrop(float Value)
 
 void ACustomSideScrollCharacter::DoJumpStart()
 {
+	// start measuring the jump input latency
+	FInputLatencyTracker::BeginAction(EInputLatencyAction::Jump);
+
 	// handle advanced jump behaviors
 	MultiJump();
+
+	// the jump is measured once the movement component executes it, drop the sample if no jump is coming
+	if (!bPressedJump || !CanJump())
+	{
+		FInputLatencyTracker::CancelAction(EInputLatencyAction::Jump);
+	}
 }
 
 void ACustomSideScrollCharacter::DoJumpEnd()
@@ -174,6 +197,9 @@ void ACustomSideScrollCharacter::DoJumpEnd()
 
 void ACustomSideScrollCharacter::DoInteract()
 {
+	// start measuring the interact input latency
+	FInputLatencyTracker::BeginAction(EInputLatencyAction::Interact);
+
 	// do a sphere trace to look for interactive objects
 	FHitResult OutHit;
 
@@ -196,16 +222,24 @@ void ACustomSideScrollCharacter::DoInteract()
 		if (ISideScrollingInteractable* Interactable = Cast<ISideScrollingInteractable>(OutHit.GetActor()))
 		{
 			// interact
+			FInputLatencyTracker::EndAction(EInputLatencyAction::Interact);
 			Interactable->Interaction(this);
+			return;
 		}
 	}
+
+	// nothing to interact with
+	FInputLatencyTracker::CancelAction(EInputLatencyAction::Interact);
 }
 
 void ACustomSideScrollCharacter::MultiJump()
 {
+	SIDESCROLL_SCOPE(CustomSideScrollMultiJump);
+
 	// does the user want to drop to a lower platform?
 	if (DropValue > 0.0f)
 	{
+		FInputLatencyTracker::CancelAction(EInputLatencyAction::Jump);
 		CheckForSoftCollision();
 		return;
 	}
@@ -223,35 +257,25 @@ void ACustomSideScrollCharacter::MultiJump()
 	// if we have a horizontal input, try for wall jump first
 	if (!bHasWallJumped && !FMath::IsNearlyZero(ActionValueY))
 	{
-		// trace ahead of the character for walls
-		FHitResult OutHit;
-
-		const FVector Start = GetActorLocation();
-		const FVector End = Start + (FVector(ActionValueY > 0.0f ? 1.0f : -1.0f, 0.0f, 0.0f) * WallJumpTraceDistance);
+		// let the movement component find the wall and launch us away from it
+		FVector WallNormal;
 
-		FCollisionQueryParams QueryParams;
-		QueryParams.AddIgnoredActor(this);
-
-		GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
-
-		if (OutHit.bBlockingHit)
+		if (CastChecked<USideScrollingMovementComponent>(GetCharacterMovement())->TryWallJump(ActionValueY, WallJumpTraceDistance, WallJumpHorizontalImpulse, WallJumpVerticalMultiplier, WallNormal))
 		{
 			// rotate to the bounce direction
-			const FRotator BounceRot = UKismetMathLibrary::MakeRotFromX(OutHit.ImpactNormal);
+			const FRotator BounceRot = UKismetMathLibrary::MakeRotFromX(WallNormal);
 			SetActorRotation(FRotator(0.0f, BounceRot.Yaw, 0.0f));
 
-			// calculate the impulse vector
-			FVector WallJumpImpulse = OutHit.ImpactNormal * WallJumpHorizontalImpulse;
-			WallJumpImpulse.Z = GetCharacterMovement()->JumpZVelocity * WallJumpVerticalMultiplier;
-
-			// launch the character away from the wall
-			LaunchCharacter(WallJumpImpulse, true, true);
+			FInputLatencyTracker::EndAction(EInputLatencyAction::Jump);
 
 			// enable wall jump lockout for a bit
 			bHasWallJumped = true;
 
 			// schedule wall jump lockout reset
-			GetWorld()->GetTimerManager().SetTimer(WallJumpTimer, this, &ACustomSideScrollCharacter::ResetWallJump, DelayBetweenWallJumps, false);
+			if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+			{
+				Timers->SetTimer(WallJumpTimer, this, &ACustomSideScrollCharacter::ResetWallJump, DelayBetweenWallJumps);
+			}
 
 			return;
 		}
@@ -277,22 +301,8 @@ void ACustomSideScrollCharacter::CheckForSoftCollision()
 	// reset the drop value
 	DropValue = 0.0f;
 
-	// trace down 
-	FHitResult OutHit;
-
-	const FVector Start = GetActorLocation();
-	const FVector End = Start + (FVector::DownVector * SoftCollisionTraceDistance);
-
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(SoftCollisionObjectType);
-
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-
-	GetWorld()->LineTraceSingleByObjectType(OutHit, Start, End, ObjectParams, QueryParams);
-
-	// did we hit a soft floor?
-	if (OutHit.GetActor())
+	// are we standing over a soft floor?
+	if (CastChecked<USideScrollingMovementComponent>(GetCharacterMovement())->IsAboveSoftPlatform(SoftCollisionObjectType, SoftCollisionTraceDistance))
 	{
 		// drop through the floor
 		SetSoftCollision(true);
@@ -305,10 +315,45 @@ void ACustomSideScrollCharacter::ResetWallJump()
 	bHasWallJumped = false;
 }
 
+void ACustomSideScrollCharacter::FellOutOfWorld(const UDamageType& DamageType)
+{
+	// let the player controller move us back to the start instead of destroying and re-spawning us
+	if (ASideScrollingPlayerController* PC = Cast<ASideScrollingPlayerController>(GetController()))
+	{
+		if (PC->RespawnPawnInPlace(this))
+		{
+			ResetForRespawn();
+			return;
+		}
+	}
+
+	Super::FellOutOfWorld(DamageType);
+}
+
+void ACustomSideScrollCharacter::ResetForRespawn()
+{
+	// clear the wall jump timer
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(WallJumpTimer);
+	}
+
+	// reset the jump state
+	bHasWallJumped = false;
+	bHasDoubleJumped = false;
+	StopJumping();
+
+	// reset the captured inputs
+	ActionValueY = 0.0f;
+	DropValue = 0.0f;
+
+	// block soft collision platforms again
+	SetSoftCollision(false);
+}
+
 void ACustomSideScrollCharacter::SetSoftCollision(bool bEnabled)
 {
-	// enable or disable collision response to the soft collision channel
-	GetCapsuleComponent()->SetCollisionResponseToChannel(SoftCollisionObjectType, bEnabled ? ECR_Ignore : ECR_Block);
+	CastChecked<USideScrollingMovementComponent>(GetCharacterMovement())->SetPassThroughSoftPlatforms(SoftCollisionObjectType, bEnabled);
 }
 
 bool ACustomSideScrollCharacter::HasDoubleJumped() const
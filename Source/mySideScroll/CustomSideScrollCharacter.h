@@ -4,9 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "GameplayTimerSubsystem.h"
 #include "CustomSideScrollCharacter.generated.h"
 
 class UCameraComponent;
+class USideScrollingMovementComponent;
 class UInputAction;
 struct FInputActionValue;
 
@@ -74,7 +76,7 @@ protected:
 	float SoftCollisionTraceDistance = 1000.0f;
 
 	/** Wall jump lockout timer */
-	FTimerHandle WallJumpTimer;
+	FGameplayTimerHandle WallJumpTimer;
 
 	/** Last captured horizontal movement input value */
 	float ActionValueY = 0.0f;
@@ -93,8 +95,8 @@ protected:
 
 public:
 	
-	/** Constructor */
-	ACustomSideScrollCharacter();
+	/** Constructor. Uses the side scrolling movement component */
+	ACustomSideScrollCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
@@ -110,6 +112,12 @@ protected:
 	/** Landing handling */
 	virtual void Landed(const FHitResult& Hit) override;
 
+	/** Records the jump input latency once the jump actually executes */
+	virtual void OnJumped_Implementation() override;
+
+	/** Respawns in place instead of being destroyed when falling out of the level */
+	virtual void FellOutOfWorld(const class UDamageType& DamageType) override;
+
 protected:
 
 	/** Called for movement input */
@@ -154,6 +162,9 @@ protected:
 	/** Resets wall jump lockout. Called from timer after a wall jump */
 	void ResetWallJump();
 
+	/** Resets the jump and drop state so the character can be reused after respawning */
+	void ResetForRespawn();
+
 public:
 
 	/** Sets the soft collision response. True passes, False blocks */
@@ -0,0 +1,518 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "GameplayTimerSubsystem.h"
+#include "mySideScroll.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "TimerManager.h"
+#include "CoreGlobals.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+DEFINE_LOG_CATEGORY(LogGameplayTimers);
+
+DECLARE_CYCLE_STAT(TEXT("Gameplay Timers"), STAT_GameplayTimers, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gameplay Timers Active"), STAT_GameplayTimersActive, STATGROUP_SideScroll);
+
+TRACE_DECLARE_INT_COUNTER(GameplayTimersActive, TEXT("GameplayTimers/Active"));
+
+static TAutoConsoleVariable<int32> CVarGameplayTimersTickRate(
+	TEXT("GameplayTimers.TickRate"),
+	60,
+	TEXT("Number of gameplay timer steps per second. Read when a world starts."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld CCmdGameplayTimersStats(
+	TEXT("GameplayTimers.Stats"),
+	TEXT("Logs the number of active and fired gameplay timers."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UGameplayTimerSubsystem* Timers = World ? World->GetSubsystem<UGameplayTimerSubsystem>() : nullptr)
+		{
+			Timers->LogStats();
+		}
+	}));
+
+static FAutoConsoleCommand CCmdGameplayTimersBenchmark(
+	TEXT("GameplayTimers.Benchmark"),
+	TEXT("Compares the timing wheel against the timer manager. Sets timers with random delays up to a second, clears half and expires the rest over a second of 60 Hz frames.\n")
+	TEXT("Usage: GameplayTimers.Benchmark [NumTimers=10000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumTimers = FMath::Max(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000, 1);
+		constexpr int32 TickRate = 60;
+
+		// use the same delays for both
+		FRandomStream Random(NumTimers);
+
+		TArray<float> Delays;
+		Delays.SetNumUninitialized(NumTimers);
+
+		for (float& Delay : Delays)
+		{
+			Delay = Random.FRandRange(0.05f, 1.0f);
+		}
+
+		int32 NumFired = 0;
+
+		// timing wheel
+		double WheelSetMs, WheelClearMs, WheelExpireMs;
+		int32 WheelFired;
+		{
+			FGameplayTimerWheel Wheel;
+
+			TArray<FGameplayTimerHandle> Handles;
+			Handles.SetNum(NumTimers);
+
+			double StartTime = FPlatformTime::Seconds();
+
+			for (int32 i = 0; i < NumTimers; ++i)
+			{
+				Wheel.SetTimer(Handles[i], FMath::CeilToInt(Delays[i] * TickRate), [&NumFired]() { ++NumFired; });
+			}
+
+			WheelSetMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			StartTime = FPlatformTime::Seconds();
+
+			for (int32 i = 0; i < NumTimers; i += 2)
+			{
+				Wheel.ClearTimer(Handles[i]);
+			}
+
+			WheelClearMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			StartTime = FPlatformTime::Seconds();
+
+			// one step per frame, like the subsystem does at the default tick rate
+			for (int32 Frame = 0; Frame < TickRate; ++Frame)
+			{
+				Wheel.Advance(1);
+			}
+
+			WheelExpireMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			WheelFired = NumFired;
+		}
+
+		NumFired = 0;
+
+		// timer manager
+		double ManagerSetMs, ManagerClearMs, ManagerExpireMs;
+		int32 ManagerFired;
+		{
+			FTimerManager TimerManager;
+
+			TArray<FTimerHandle> Handles;
+			Handles.SetNum(NumTimers);
+
+			double StartTime = FPlatformTime::Seconds();
+
+			for (int32 i = 0; i < NumTimers; ++i)
+			{
+				TimerManager.SetTimer(Handles[i], FTimerDelegate::CreateLambda([&NumFired]() { ++NumFired; }), Delays[i], false);
+			}
+
+			ManagerSetMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			StartTime = FPlatformTime::Seconds();
+
+			for (int32 i = 0; i < NumTimers; i += 2)
+			{
+				TimerManager.ClearTimer(Handles[i]);
+			}
+
+			ManagerClearMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			StartTime = FPlatformTime::Seconds();
+
+			// the same second of frames the wheel went through. The timer manager only ticks once per engine frame,
+			// so step the frame counter like the engine would and put it back afterwards
+			const uint64 SavedFrameCounter = GFrameCounter;
+
+			for (int32 Frame = 0; Frame < TickRate; ++Frame)
+			{
+				++GFrameCounter;
+				TimerManager.Tick(1.0f / TickRate);
+			}
+
+			GFrameCounter = SavedFrameCounter;
+
+			ManagerExpireMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+			ManagerFired = NumFired;
+		}
+
+		UE_LOG(LogGameplayTimers, Log, TEXT("Benchmark with %d timers:"), NumTimers);
+		UE_LOG(LogGameplayTimers, Log, TEXT("  timing wheel:  set %.3f ms, clear %.3f ms, expire %.3f ms over %d frames, %d fired"), WheelSetMs, WheelClearMs, WheelExpireMs, TickRate, WheelFired);
+		UE_LOG(LogGameplayTimers, Log, TEXT("  timer manager: set %.3f ms, clear %.3f ms, expire %.3f ms over %d frames, %d fired"), ManagerSetMs, ManagerClearMs, ManagerExpireMs, TickRate, ManagerFired);
+	}));
+
+////////////////////////////////////////////////////////////////////
+
+FGameplayTimerWheel::FGameplayTimerWheel()
+{
+	// one list per slot, plus the firing list
+	FiringList = NumLevels * NumSlots;
+
+	Heads.Init(INDEX_NONE, FiringList + 1);
+	Tails.Init(INDEX_NONE, FiringList + 1);
+}
+
+void FGameplayTimerWheel::SetTimer(FGameplayTimerHandle& InOutHandle, uint64 DelayTicks, FCallback&& Callback)
+{
+	ClearTimer(InOutHandle);
+
+	// reuse a free node if we have one
+	int32 NodeIndex = FreeHead;
+
+	if (NodeIndex != INDEX_NONE)
+	{
+		FreeHead = Nodes[NodeIndex].Next;
+	}
+	else
+	{
+		NodeIndex = Nodes.AddDefaulted();
+	}
+
+	// the wheel covers 2^32 ticks
+	constexpr uint64 MaxDelayTicks = (uint64(1) << (SlotBits * NumLevels)) - 1;
+
+	FNode& Node = Nodes[NodeIndex];
+	Node.Callback = MoveTemp(Callback);
+	Node.ExpireTick = CurrentTick + FMath::Clamp<uint64>(DelayTicks, 1, MaxDelayTicks);
+
+	Schedule(NodeIndex);
+
+	++NumActive;
+
+	InOutHandle.Index = NodeIndex;
+	InOutHandle.Serial = Node.Serial;
+}
+
+void FGameplayTimerWheel::ClearTimer(FGameplayTimerHandle& InOutHandle)
+{
+	if (FindNode(InOutHandle))
+	{
+		UnlinkNode(InOutHandle.Index);
+		FreeNode(InOutHandle.Index);
+
+		--NumActive;
+	}
+
+	InOutHandle.Invalidate();
+}
+
+bool FGameplayTimerWheel::IsTimerActive(const FGameplayTimerHandle& Handle) const
+{
+	return FindNode(Handle) != nullptr;
+}
+
+int64 FGameplayTimerWheel::GetTicksRemaining(const FGameplayTimerHandle& Handle) const
+{
+	const FNode* Node = FindNode(Handle);
+
+	return Node ? int64(Node->ExpireTick - CurrentTick) : INDEX_NONE;
+}
+
+void FGameplayTimerWheel::Advance(uint64 NumTicks)
+{
+	// timers can't be advanced from their own callbacks
+	check(Heads[FiringList] == INDEX_NONE);
+
+	for (uint64 i = 0; i < NumTicks; ++i)
+	{
+		// nothing to expire or cascade, so skip ahead
+		if (NumActive == 0)
+		{
+			CurrentTick += NumTicks - i;
+			break;
+		}
+
+		Step();
+	}
+}
+
+void FGameplayTimerWheel::Reset()
+{
+	// free the nodes so outstanding handles go stale
+	for (int32 i = 0; i < Nodes.Num(); ++i)
+	{
+		if (Nodes[i].List != INDEX_NONE)
+		{
+			FreeNode(i);
+		}
+	}
+
+	for (int32 List = 0; List < Heads.Num(); ++List)
+	{
+		Heads[List] = INDEX_NONE;
+		Tails[List] = INDEX_NONE;
+	}
+
+	NumActive = 0;
+}
+
+const FGameplayTimerWheel::FNode* FGameplayTimerWheel::FindNode(const FGameplayTimerHandle& Handle) const
+{
+	if (!Nodes.IsValidIndex(Handle.Index))
+	{
+		return nullptr;
+	}
+
+	const FNode& Node = Nodes[Handle.Index];
+
+	return Node.Serial == Handle.Serial && Node.List != INDEX_NONE ? &Node : nullptr;
+}
+
+void FGameplayTimerWheel::Schedule(int32 NodeIndex)
+{
+	const uint64 ExpireTick = Nodes[NodeIndex].ExpireTick;
+	const uint64 Delta = ExpireTick > CurrentTick ? ExpireTick - CurrentTick : 0;
+
+	// pick the lowest level whose range covers the delay
+	int32 Level = 0;
+
+	while (Level < NumLevels - 1 && Delta >= (uint64(1) << (SlotBits * (Level + 1))))
+	{
+		++Level;
+	}
+
+	const int32 Slot = int32((ExpireTick >> (SlotBits * Level)) & (NumSlots - 1));
+
+	LinkNode(NodeIndex, Level * NumSlots + Slot);
+}
+
+void FGameplayTimerWheel::LinkNode(int32 NodeIndex, int32 List)
+{
+	FNode& Node = Nodes[NodeIndex];
+	Node.List = List;
+	Node.Prev = Tails[List];
+	Node.Next = INDEX_NONE;
+
+	if (Tails[List] != INDEX_NONE)
+	{
+		Nodes[Tails[List]].Next = NodeIndex;
+	}
+	else
+	{
+		Heads[List] = NodeIndex;
+	}
+
+	Tails[List] = NodeIndex;
+}
+
+void FGameplayTimerWheel::UnlinkNode(int32 NodeIndex)
+{
+	FNode& Node = Nodes[NodeIndex];
+
+	if (Node.Prev != INDEX_NONE)
+	{
+		Nodes[Node.Prev].Next = Node.Next;
+	}
+	else
+	{
+		Heads[Node.List] = Node.Next;
+	}
+
+	if (Node.Next != INDEX_NONE)
+	{
+		Nodes[Node.Next].Prev = Node.Prev;
+	}
+	else
+	{
+		Tails[Node.List] = Node.Prev;
+	}
+
+	Node.List = INDEX_NONE;
+	Node.Prev = INDEX_NONE;
+	Node.Next = INDEX_NONE;
+}
+
+void FGameplayTimerWheel::FreeNode(int32 NodeIndex)
+{
+	FNode& Node = Nodes[NodeIndex];
+	Node.Callback = nullptr;
+	Node.List = INDEX_NONE;
+	Node.Prev = INDEX_NONE;
+
+	// skip zero so a default handle never matches
+	Node.Serial = Node.Serial + 1 != 0 ? Node.Serial + 1 : 1;
+
+	Node.Next = FreeHead;
+	FreeHead = NodeIndex;
+}
+
+void FGameplayTimerWheel::Cascade(int32 Level, int32 Slot)
+{
+	const int32 List = Level * NumSlots + Slot;
+
+	// detach the slot and reschedule its timers. They're now close enough to land in a lower level
+	int32 NodeIndex = Heads[List];
+
+	Heads[List] = INDEX_NONE;
+	Tails[List] = INDEX_NONE;
+
+	while (NodeIndex != INDEX_NONE)
+	{
+		const int32 Next = Nodes[NodeIndex].Next;
+
+		Schedule(NodeIndex);
+
+		NodeIndex = Next;
+	}
+}
+
+void FGameplayTimerWheel::Step()
+{
+	++CurrentTick;
+
+	constexpr uint64 SlotMask = NumSlots - 1;
+
+	// did the first level wrap? Cascade the upper levels, top down
+	if ((CurrentTick & SlotMask) == 0)
+	{
+		int32 Level = 1;
+
+		while (Level < NumLevels - 1 && ((CurrentTick >> (SlotBits * Level)) & SlotMask) == 0)
+		{
+			++Level;
+		}
+
+		for (; Level > 0; --Level)
+		{
+			Cascade(Level, int32((CurrentTick >> (SlotBits * Level)) & SlotMask));
+		}
+	}
+
+	// move the expired slot to the firing list, so callbacks can freely set and clear timers
+	const int32 ExpiredList = int32(CurrentTick & SlotMask);
+
+	if (Heads[ExpiredList] == INDEX_NONE)
+	{
+		return;
+	}
+
+	for (int32 NodeIndex = Heads[ExpiredList]; NodeIndex != INDEX_NONE; NodeIndex = Nodes[NodeIndex].Next)
+	{
+		Nodes[NodeIndex].List = FiringList;
+	}
+
+	Heads[FiringList] = Heads[ExpiredList];
+	Tails[FiringList] = Tails[ExpiredList];
+	Heads[ExpiredList] = INDEX_NONE;
+	Tails[ExpiredList] = INDEX_NONE;
+
+	// fire the timers in order
+	while (Heads[FiringList] != INDEX_NONE)
+	{
+		const int32 NodeIndex = Heads[FiringList];
+
+		FCallback Callback = MoveTemp(Nodes[NodeIndex].Callback);
+
+		UnlinkNode(NodeIndex);
+		FreeNode(NodeIndex);
+
+		--NumActive;
+		++NumFired;
+
+		// the callback may add nodes, so don't hold on to any node references
+		if (Callback)
+		{
+			Callback();
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool UGameplayTimerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGameplayTimerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	StepTime = 1.0 / FMath::Max(CVarGameplayTimersTickRate.GetValueOnGameThread(), 1);
+}
+
+void UGameplayTimerSubsystem::Deinitialize()
+{
+	Wheel.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UGameplayTimerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGameplayTimerSubsystem, STATGROUP_Tickables);
+}
+
+void UGameplayTimerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_GameplayTimers);
+
+	// advance in whole steps, carrying the remainder over to the next frame
+	AccumulatedTime += DeltaTime;
+
+	const uint64 NumSteps = uint64(FMath::FloorToDouble(AccumulatedTime / StepTime));
+	AccumulatedTime -= NumSteps * StepTime;
+
+	Wheel.Advance(NumSteps);
+
+	SET_DWORD_STAT(STAT_GameplayTimersActive, Wheel.GetNumActiveTimers());
+	TRACE_COUNTER_SET(GameplayTimersActive, Wheel.GetNumActiveTimers());
+}
+
+void UGameplayTimerSubsystem::SetTimer(FGameplayTimerHandle& InOutHandle, FGameplayTimerWheel::FCallback&& Callback, float Delay)
+{
+	// match the timer manager, which clears the timer on a non positive delay
+	if (Delay <= 0.0f)
+	{
+		ClearTimer(InOutHandle);
+		return;
+	}
+
+	Wheel.SetTimer(InOutHandle, DelayToTicks(Delay), MoveTemp(Callback));
+}
+
+void UGameplayTimerSubsystem::ClearTimer(FGameplayTimerHandle& InOutHandle)
+{
+	Wheel.ClearTimer(InOutHandle);
+}
+
+bool UGameplayTimerSubsystem::IsTimerActive(const FGameplayTimerHandle& Handle) const
+{
+	return Wheel.IsTimerActive(Handle);
+}
+
+float UGameplayTimerSubsystem::GetTimerRemaining(const FGameplayTimerHandle& Handle) const
+{
+	const int64 TicksRemaining = Wheel.GetTicksRemaining(Handle);
+
+	if (TicksRemaining == INDEX_NONE)
+	{
+		return -1.0f;
+	}
+
+	return float(FMath::Max(TicksRemaining * StepTime - AccumulatedTime, 0.0));
+}
+
+void UGameplayTimerSubsystem::LogStats() const
+{
+	UE_LOG(LogGameplayTimers, Log, TEXT("%d active timers, %llu fired, tick %llu at %.0f steps per second"), Wheel.GetNumActiveTimers(), Wheel.GetNumFiredTimers(), Wheel.GetCurrentTick(), 1.0 / StepTime);
+}
+
+UGameplayTimerSubsystem* UGameplayTimerSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<UGameplayTimerSubsystem>() : nullptr;
+}
+
+uint64 UGameplayTimerSubsystem::DelayToTicks(float Delay) const
+{
+	// the next step happens once the accumulated time reaches a full step
+	return uint64(FMath::Max(FMath::CeilToDouble((Delay + AccumulatedTime) / StepTime), 1.0));
+}
@@ -0,0 +1,230 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameplayTimerSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogGameplayTimers, Log, All);
+
+/**
+ *  Handle to a gameplay timer
+ *  Stays safe to use after the timer has fired or been cleared
+ */
+struct FGameplayTimerHandle
+{
+	/** Index of the timer node */
+	int32 Index = INDEX_NONE;
+
+	/** Serial of the timer node when the timer was set. Nodes bump their serial when they're freed */
+	uint32 Serial = 0;
+
+	/** Returns true if the handle was ever set */
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	/** Resets the handle */
+	void Invalidate() { Index = INDEX_NONE; Serial = 0; }
+};
+
+/**
+ *  Hierarchical timing wheel
+ *  Time advances in whole ticks, so expiry order only depends on the tick count and stays deterministic.
+ *  - Four levels of 256 slots cover 2^32 ticks. Timers are kept in intrusive lists, so setting and clearing are O(1)
+ *  - Each tick expires a whole slot at once. Timers further out cascade down a level every 256 ticks of the level below
+ *  Timers due on the same tick fire in the order they reached the slot.
+ */
+class MYSIDESCROLL_API FGameplayTimerWheel
+{
+public:
+
+	/** Callback run when a timer expires */
+	using FCallback = TUniqueFunction<void()>;
+
+	/** Bits per level and number of levels */
+	static constexpr int32 SlotBits = 8;
+	static constexpr int32 NumSlots = 1 << SlotBits;
+	static constexpr int32 NumLevels = 4;
+
+	/** Constructor */
+	FGameplayTimerWheel();
+
+	/** Sets a timer to expire after the given number of ticks, clearing any timer the handle was pointing to */
+	void SetTimer(FGameplayTimerHandle& InOutHandle, uint64 DelayTicks, FCallback&& Callback);
+
+	/** Clears the timer and invalidates the handle */
+	void ClearTimer(FGameplayTimerHandle& InOutHandle);
+
+	/** Returns true if the timer is waiting to expire */
+	bool IsTimerActive(const FGameplayTimerHandle& Handle) const;
+
+	/** Returns the ticks left until the timer expires, or INDEX_NONE if it's not active */
+	int64 GetTicksRemaining(const FGameplayTimerHandle& Handle) const;
+
+	/** Advances the wheel by a number of ticks, running the callbacks of expired timers */
+	void Advance(uint64 NumTicks);
+
+	/** Clears all timers without running them */
+	void Reset();
+
+	/** Returns the current tick */
+	uint64 GetCurrentTick() const { return CurrentTick; }
+
+	/** Returns the number of active timers */
+	int32 GetNumActiveTimers() const { return NumActive; }
+
+	/** Returns the number of timers fired since the wheel was created */
+	uint64 GetNumFiredTimers() const { return NumFired; }
+
+protected:
+
+	/** Timer node */
+	struct FNode
+	{
+		/** Callback to run on expiry */
+		FCallback Callback;
+
+		/** Tick the timer expires on */
+		uint64 ExpireTick = 0;
+
+		/** Intrusive list links */
+		int32 Prev = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+
+		/** List the node is in, or INDEX_NONE if it's free */
+		int32 List = INDEX_NONE;
+
+		/** Bumped every time the node is freed, so stale handles can be detected */
+		uint32 Serial = 1;
+	};
+
+	/** Timer nodes. Freed nodes are chained through their Next link */
+	TArray<FNode> Nodes;
+
+	/** Head of the free node chain */
+	int32 FreeHead = INDEX_NONE;
+
+	/** Head and tail of every slot list, followed by the list of timers being fired */
+	TArray<int32> Heads;
+	TArray<int32> Tails;
+
+	/** Index of the list of timers being fired */
+	int32 FiringList = 0;
+
+	/** Current tick */
+	uint64 CurrentTick = 0;
+
+	/** Stats */
+	int32 NumActive = 0;
+	uint64 NumFired = 0;
+
+protected:
+
+	/** Returns the node for a handle if the handle is still current */
+	const FNode* FindNode(const FGameplayTimerHandle& Handle) const;
+
+	/** Puts a node in the slot for its expiry tick */
+	void Schedule(int32 NodeIndex);
+
+	/** Appends a node to a list */
+	void LinkNode(int32 NodeIndex, int32 List);
+
+	/** Removes a node from its list */
+	void UnlinkNode(int32 NodeIndex);
+
+	/** Returns a node to the free chain */
+	void FreeNode(int32 NodeIndex);
+
+	/** Moves every timer in a slot down to the levels below */
+	void Cascade(int32 Level, int32 Slot);
+
+	/** Advances a single tick */
+	void Step();
+};
+
+/**
+ *  Gameplay timer subsystem
+ *  Runs gameplay cooldowns and delays on a timing wheel ticked at a fixed rate, instead of the world timer manager.
+ *  Delays are rounded up to whole steps. Time is taken from the world delta, so it follows time dilation and pausing.
+ *  Timers bound to an object don't fire if the object has been destroyed.
+ */
+UCLASS()
+class MYSIDESCROLL_API UGameplayTimerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Timing wheel */
+	FGameplayTimerWheel Wheel;
+
+	/** Length of a wheel tick */
+	double StepTime = 1.0 / 60.0;
+
+	/** Time accumulated towards the next wheel tick */
+	double AccumulatedTime = 0.0;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Reads the tick rate */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Advances the wheel */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat id for the tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Sets a timer calling a method on an object after a delay in seconds */
+	template<typename UserClass>
+	void SetTimer(FGameplayTimerHandle& InOutHandle, UserClass* Object, void (UserClass::*Method)(), float Delay)
+	{
+		// match the timer manager, which clears the timer on a non positive delay
+		if (Delay <= 0.0f)
+		{
+			ClearTimer(InOutHandle);
+			return;
+		}
+
+		TWeakObjectPtr<UserClass> WeakObject(Object);
+
+		Wheel.SetTimer(InOutHandle, DelayToTicks(Delay), [WeakObject, Method]()
+		{
+			if (UserClass* StrongObject = WeakObject.Get())
+			{
+				(StrongObject->*Method)();
+			}
+		});
+	}
+
+	/** Sets a timer running a callback after a delay in seconds */
+	void SetTimer(FGameplayTimerHandle& InOutHandle, FGameplayTimerWheel::FCallback&& Callback, float Delay);
+
+	/** Clears the timer and invalidates the handle */
+	void ClearTimer(FGameplayTimerHandle& InOutHandle);
+
+	/** Returns true if the timer is waiting to expire */
+	bool IsTimerActive(const FGameplayTimerHandle& Handle) const;
+
+	/** Returns the time left until the timer expires, or -1 if it's not active */
+	float GetTimerRemaining(const FGameplayTimerHandle& Handle) const;
+
+	/** Logs the timer counts */
+	void LogStats() const;
+
+	/** Convenience accessor from any world context object */
+	static UGameplayTimerSubsystem* Get(const UObject* WorldContextObject);
+
+protected:
+
+	/** Converts a delay in seconds to wheel ticks, rounding up */
+	uint64 DelayToTicks(float Delay) const;
+};
@@ -0,0 +1,375 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InputLatencyTracker.h"
+#include "mySideScroll.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY(LogInputLatency);
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Jump Input Latency (ms)"), STAT_InputLatencyJump, STATGROUP_SideScroll);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Dash Input Latency (ms)"), STAT_InputLatencyDash, STATGROUP_SideScroll);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Attack Input Latency (ms)"), STAT_InputLatencyAttack, STATGROUP_SideScroll);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Interact Input Latency (ms)"), STAT_InputLatencyInteract, STATGROUP_SideScroll);
+
+TRACE_DECLARE_FLOAT_COUNTER(InputLatencyJump, TEXT("Input/Latency/Jump (ms)"));
+TRACE_DECLARE_FLOAT_COUNTER(InputLatencyDash, TEXT("Input/Latency/Dash (ms)"));
+TRACE_DECLARE_FLOAT_COUNTER(InputLatencyAttack, TEXT("Input/Latency/Attack (ms)"));
+TRACE_DECLARE_FLOAT_COUNTER(InputLatencyInteract, TEXT("Input/Latency/Interact (ms)"));
+
+FInputLatencyTracker::FPendingInput FInputLatencyTracker::PendingInputs[static_cast<int32>(EInputLatencyAction::Num)];
+FInputLatencyHistogram FInputLatencyTracker::Histograms[static_cast<int32>(EInputLatencyAction::Num)];
+
+static FAutoConsoleCommand CCmdInputLatencyDump(
+	TEXT("Input.Latency.Dump"),
+	TEXT("Logs the input to action latency histograms for every tracked action."),
+	FConsoleCommandDelegate::CreateStatic(&FInputLatencyTracker::DumpHistograms));
+
+static FAutoConsoleCommand CCmdInputLatencyReset(
+	TEXT("Input.Latency.Reset"),
+	TEXT("Clears the input to action latency histograms."),
+	FConsoleCommandDelegate::CreateStatic(&FInputLatencyTracker::Reset));
+
+static FAutoConsoleCommand CCmdInputLatencyCheck(
+	TEXT("Input.Latency.Check"),
+	TEXT("Logs an error if any action's worst input latency exceeds the bounds, or if any action has no samples. For automated runs with -ExecCmds.\n")
+	TEXT("Usage: Input.Latency.Check [MaxFrames=2] [MaxMs=50]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const uint64 MaxFrames = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 0) : 2;
+		const double MaxMs = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 50.0;
+
+		FInputLatencyTracker::CheckUpperBounds(MaxFrames, MaxMs);
+	}));
+
+namespace InputLatencyDriver
+{
+	/** Input function called on the pawn at a point of the driver cycle */
+	struct FDriverStep
+	{
+		int32 Frame;
+		const TCHAR* FunctionName;
+
+		/** Action measured by this step. Num for release steps that aren't measured */
+		EInputLatencyAction Action;
+	};
+
+	/** Frames in one driver cycle. Long enough for a jump to land so the dash and jump are available again */
+	constexpr int32 CycleFrames = 60;
+
+	/** Press and release steps for every action, spread over the cycle so they don't overlap */
+	constexpr FDriverStep Steps[] =
+	{
+		{ 0, TEXT("DoJumpStart"), EInputLatencyAction::Jump },
+		{ 2, TEXT("DoJumpEnd"), EInputLatencyAction::Num },
+		{ 10, TEXT("DoDash"), EInputLatencyAction::Dash },
+		{ 30, TEXT("DoComboAttackStart"), EInputLatencyAction::Attack },
+		{ 32, TEXT("DoComboAttackEnd"), EInputLatencyAction::Num },
+		{ 45, TEXT("DoInteract"), EInputLatencyAction::Interact },
+	};
+
+	/** State of a running driver */
+	struct FDriverState
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		UFunction* Functions[UE_ARRAY_COUNT(Steps)] = {};
+		TArray<EInputLatencyAction> RequiredActions;
+		int32 Frame = 0;
+		int32 NumFrames = 0;
+		uint64 MaxFrames = 0;
+		double MaxMs = 0.0;
+	};
+
+	/** Calls the input functions due this frame. Returns false once the driver is complete */
+	static bool TickDriver(FDriverState& State)
+	{
+		APawn* Pawn = State.Pawn.Get();
+
+		if (!Pawn)
+		{
+			UE_LOG(LogInputLatency, Error, TEXT("Input latency driver stopped after %d frames: the pawn was destroyed"), State.Frame);
+			return false;
+		}
+
+		if (State.Frame < State.NumFrames)
+		{
+			const int32 CycleFrame = State.Frame % CycleFrames;
+
+			for (int32 i = 0; i < UE_ARRAY_COUNT(Steps); ++i)
+			{
+				if (Steps[i].Frame == CycleFrame && State.Functions[i])
+				{
+					Pawn->ProcessEvent(State.Functions[i], nullptr);
+				}
+			}
+
+			++State.Frame;
+			return true;
+		}
+
+		FInputLatencyTracker::DumpHistograms();
+		FInputLatencyTracker::CheckUpperBounds(State.MaxFrames, State.MaxMs, State.RequiredActions);
+
+		return false;
+	}
+
+	/** Injects the tracked actions on the first local player's pawn for a number of frames, then checks the latency bounds */
+	static void StartDriver(UWorld* World, int32 NumFrames, uint64 MaxFrames, double MaxMs)
+	{
+		const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+		if (!Pawn || !Pawn->IsLocallyControlled())
+		{
+			UE_LOG(LogInputLatency, Error, TEXT("The input latency driver needs a locally controlled player pawn"));
+			return;
+		}
+
+		TSharedRef<FDriverState> State = MakeShared<FDriverState>();
+		State->Pawn = Pawn;
+		State->NumFrames = NumFrames;
+		State->MaxFrames = MaxFrames;
+		State->MaxMs = MaxMs;
+
+		// the input functions are spread over the character variants, only drive the ones this pawn has
+		for (int32 i = 0; i < UE_ARRAY_COUNT(Steps); ++i)
+		{
+			State->Functions[i] = Pawn->FindFunction(Steps[i].FunctionName);
+
+			if (State->Functions[i] && Steps[i].Action != EInputLatencyAction::Num)
+			{
+				State->RequiredActions.Add(Steps[i].Action);
+			}
+		}
+
+		if (State->RequiredActions.IsEmpty())
+		{
+			UE_LOG(LogInputLatency, Error, TEXT("%s has none of the tracked input actions"), *Pawn->GetClass()->GetName());
+			return;
+		}
+
+		UE_LOG(LogInputLatency, Log, TEXT("Driving %d tracked actions on %s for %d frames"), State->RequiredActions.Num(), *Pawn->GetName(), NumFrames);
+
+		FInputLatencyTracker::Reset();
+
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([State](float DeltaTime)
+		{
+			return TickDriver(*State);
+		}));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CCmdInputLatencyDrive(
+	TEXT("Input.Latency.Drive"),
+	TEXT("Injects jump, dash, attack and interact inputs on the player's pawn for a number of frames, then dumps the histograms and runs the latency check.\n")
+	TEXT("Every action the pawn supports must collect samples, so run it on a map where the pawn starts in reach of an interactable.\n")
+	TEXT("Usage: Input.Latency.Drive [Frames=600] [MaxFrames=2] [MaxMs=50], e.g. -ExecCmds=\"Input.Latency.Drive 600\""),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 NumFrames = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 600;
+		const uint64 MaxFrames = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 0) : 2;
+		const double MaxMs = Args.Num() > 2 ? FCString::Atod(*Args[2]) : 50.0;
+
+		InputLatencyDriver::StartDriver(World, NumFrames, MaxFrames, MaxMs);
+	}));
+
+void FInputLatencyHistogram::Add(double Ms, uint64 Frames)
+{
+	// find the millisecond bucket
+	int32 MsBucket = 0;
+
+	while (MsBucket < NumMsBuckets - 1 && Ms > MsBucketBounds[MsBucket])
+	{
+		++MsBucket;
+	}
+
+	++MsBuckets[MsBucket];
+	++FrameBuckets[FMath::Min<uint64>(Frames, NumFrameBuckets - 1)];
+
+	++Count;
+	TotalMs += Ms;
+	MaxMs = FMath::Max(MaxMs, Ms);
+	MaxFrames = FMath::Max(MaxFrames, Frames);
+}
+
+void FInputLatencyTracker::BeginAction(EInputLatencyAction Action)
+{
+	FPendingInput& Pending = PendingInputs[static_cast<int32>(Action)];
+
+	Pending.StartTime = FPlatformTime::Seconds();
+	Pending.StartFrame = GFrameCounter;
+	Pending.bPending = true;
+}
+
+void FInputLatencyTracker::EndAction(EInputLatencyAction Action)
+{
+	FPendingInput& Pending = PendingInputs[static_cast<int32>(Action)];
+
+	// only the first effect of an input counts
+	if (!Pending.bPending)
+	{
+		return;
+	}
+
+	Pending.bPending = false;
+
+	const double LatencyMs = (FPlatformTime::Seconds() - Pending.StartTime) * 1000.0;
+	const uint64 LatencyFrames = GFrameCounter - Pending.StartFrame;
+
+	Histograms[static_cast<int32>(Action)].Add(LatencyMs, LatencyFrames);
+
+	// publish the latest sample
+	switch (Action)
+	{
+	case EInputLatencyAction::Jump:
+		SET_FLOAT_STAT(STAT_InputLatencyJump, LatencyMs);
+		TRACE_COUNTER_SET(InputLatencyJump, LatencyMs);
+		break;
+	case EInputLatencyAction::Dash:
+		SET_FLOAT_STAT(STAT_InputLatencyDash, LatencyMs);
+		TRACE_COUNTER_SET(InputLatencyDash, LatencyMs);
+		break;
+	case EInputLatencyAction::Attack:
+		SET_FLOAT_STAT(STAT_InputLatencyAttack, LatencyMs);
+		TRACE_COUNTER_SET(InputLatencyAttack, LatencyMs);
+		break;
+	case EInputLatencyAction::Interact:
+		SET_FLOAT_STAT(STAT_InputLatencyInteract, LatencyMs);
+		TRACE_COUNTER_SET(InputLatencyInteract, LatencyMs);
+		break;
+	default:
+		break;
+	}
+}
+
+void FInputLatencyTracker::CancelAction(EInputLatencyAction Action)
+{
+	PendingInputs[static_cast<int32>(Action)].bPending = false;
+}
+
+const FInputLatencyHistogram& FInputLatencyTracker::GetHistogram(EInputLatencyAction Action)
+{
+	return Histograms[static_cast<int32>(Action)];
+}
+
+void FInputLatencyTracker::Reset()
+{
+	for (int32 i = 0; i < static_cast<int32>(EInputLatencyAction::Num); ++i)
+	{
+		PendingInputs[i] = FPendingInput();
+		Histograms[i] = FInputLatencyHistogram();
+	}
+}
+
+void FInputLatencyTracker::DumpHistograms()
+{
+	for (int32 i = 0; i < static_cast<int32>(EInputLatencyAction::Num); ++i)
+	{
+		const FInputLatencyHistogram& Histogram = Histograms[i];
+
+		if (Histogram.Count == 0)
+		{
+			continue;
+		}
+
+		// build the bucket lists
+		FString MsBuckets;
+
+		for (int32 Bucket = 0; Bucket < FInputLatencyHistogram::NumMsBuckets; ++Bucket)
+		{
+			if (Bucket < FInputLatencyHistogram::NumMsBuckets - 1)
+			{
+				MsBuckets += FString::Printf(TEXT("<=%.1f:%u "), FInputLatencyHistogram::MsBucketBounds[Bucket], Histogram.MsBuckets[Bucket]);
+			}
+			else
+			{
+				MsBuckets += FString::Printf(TEXT(">%.1f:%u"), FInputLatencyHistogram::MsBucketBounds[Bucket - 1], Histogram.MsBuckets[Bucket]);
+			}
+		}
+
+		FString FrameBuckets;
+
+		for (int32 Bucket = 0; Bucket < FInputLatencyHistogram::NumFrameBuckets; ++Bucket)
+		{
+			FrameBuckets += FString::Printf(Bucket < FInputLatencyHistogram::NumFrameBuckets - 1 ? TEXT("%d:%u ") : TEXT("%d+:%u"), Bucket, Histogram.FrameBuckets[Bucket]);
+		}
+
+		UE_LOG(LogInputLatency, Log, TEXT("%s: %u samples, mean %.2f ms, max %.2f ms / %llu frames | ms [%s] | frames [%s]"),
+			GetActionName(static_cast<EInputLatencyAction>(i)),
+			Histogram.Count,
+			Histogram.GetMeanMs(),
+			Histogram.MaxMs,
+			Histogram.MaxFrames,
+			*MsBuckets,
+			*FrameBuckets);
+	}
+}
+
+bool FInputLatencyTracker::CheckUpperBounds(uint64 MaxFrames, double MaxMs)
+{
+	const EInputLatencyAction AllActions[] = { EInputLatencyAction::Jump, EInputLatencyAction::Dash, EInputLatencyAction::Attack, EInputLatencyAction::Interact };
+
+	return CheckUpperBounds(MaxFrames, MaxMs, AllActions);
+}
+
+bool FInputLatencyTracker::CheckUpperBounds(uint64 MaxFrames, double MaxMs, TConstArrayView<EInputLatencyAction> RequiredActions)
+{
+	bool bWithinBounds = true;
+
+	// an action that was never measured can't pass the check
+	for (EInputLatencyAction Action : RequiredActions)
+	{
+		if (Histograms[static_cast<int32>(Action)].Count == 0)
+		{
+			UE_LOG(LogInputLatency, Error, TEXT("%s input latency has no samples"), GetActionName(Action));
+
+			bWithinBounds = false;
+		}
+	}
+
+	for (int32 i = 0; i < static_cast<int32>(EInputLatencyAction::Num); ++i)
+	{
+		const FInputLatencyHistogram& Histogram = Histograms[i];
+
+		if (Histogram.Count > 0 && (Histogram.MaxFrames > MaxFrames || Histogram.MaxMs > MaxMs))
+		{
+			UE_LOG(LogInputLatency, Error, TEXT("%s input latency over budget: max %.2f ms / %llu frames, allowed %.2f ms / %llu frames"),
+				GetActionName(static_cast<EInputLatencyAction>(i)),
+				Histogram.MaxMs,
+				Histogram.MaxFrames,
+				MaxMs,
+				MaxFrames);
+
+			bWithinBounds = false;
+		}
+	}
+
+	if (bWithinBounds)
+	{
+		UE_LOG(LogInputLatency, Log, TEXT("Input latency within bounds (%.2f ms / %llu frames)"), MaxMs, MaxFrames);
+	}
+
+	return bWithinBounds;
+}
+
+const TCHAR* FInputLatencyTracker::GetActionName(EInputLatencyAction Action)
+{
+	switch (Action)
+	{
+	case EInputLatencyAction::Jump:
+		return TEXT("Jump");
+	case EInputLatencyAction::Dash:
+		return TEXT("Dash");
+	case EInputLatencyAction::Attack:
+		return TEXT("Attack");
+	case EInputLatencyAction::Interact:
+		return TEXT("Interact");
+	default:
+		return TEXT("Unknown");
+	}
+}
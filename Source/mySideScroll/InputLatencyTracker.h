@@ -0,0 +1,101 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogInputLatency, Log, All);
+
+/**
+ *  Player actions whose input latency is tracked
+ */
+enum class EInputLatencyAction : uint8
+{
+	Jump,
+	Dash,
+	Attack,
+	Interact,
+	Num
+};
+
+/**
+ *  Latency histogram for a single action, in milliseconds and in frames
+ */
+struct FInputLatencyHistogram
+{
+	/** Upper bounds of the millisecond buckets. The last bucket holds everything above the last bound */
+	static constexpr double MsBucketBounds[] = { 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 66.7 };
+	static constexpr int32 NumMsBuckets = UE_ARRAY_COUNT(MsBucketBounds) + 1;
+
+	/** Frame buckets: same frame, 1, 2, 3 frames, and 4 or more frames */
+	static constexpr int32 NumFrameBuckets = 5;
+
+	uint32 MsBuckets[NumMsBuckets] = {};
+	uint32 FrameBuckets[NumFrameBuckets] = {};
+
+	/** Sample count and totals */
+	uint32 Count = 0;
+	double TotalMs = 0.0;
+	double MaxMs = 0.0;
+	uint64 MaxFrames = 0;
+
+	/** Adds a latency sample */
+	void Add(double Ms, uint64 Frames);
+
+	/** Returns the mean latency in milliseconds */
+	double GetMeanMs() const { return Count > 0 ? TotalMs / Count : 0.0; }
+};
+
+/**
+ *  Measures the time between an Enhanced Input callback and the first gameplay effect of the action
+ *  (a jump or launch, a montage starting to play, an interaction being called).
+ *  Samples are collected into per-action histograms, published to the SideScroll stat group and to Insights counters,
+ *  and can be dumped or checked against upper bounds with the Input.Latency console commands.
+ *  Input.Latency.Drive injects the actions on the player's pawn for a number of frames and then runs the check, for automated runs.
+ *  Only the locally controlled player's actions are tracked; actions by remote players or AI must not end a pending input.
+ *  Game thread only.
+ */
+class MYSIDESCROLL_API FInputLatencyTracker
+{
+public:
+
+	/** Marks the input callback for an action */
+	static void BeginAction(EInputLatencyAction Action);
+
+	/** Marks the first effect of an action. Ignored if the action has no pending input */
+	static void EndAction(EInputLatencyAction Action);
+
+	/** Drops the pending input for an action that had no effect */
+	static void CancelAction(EInputLatencyAction Action);
+
+	/** Returns the histogram for an action */
+	static const FInputLatencyHistogram& GetHistogram(EInputLatencyAction Action);
+
+	/** Clears all histograms */
+	static void Reset();
+
+	/** Logs all histograms */
+	static void DumpHistograms();
+
+	/** Returns false and logs an error if any action's worst latency is over the bounds, or if any action has no samples */
+	static bool CheckUpperBounds(uint64 MaxFrames, double MaxMs);
+
+	/** Returns false and logs an error if any action's worst latency is over the bounds, or if any of the required actions has no samples */
+	static bool CheckUpperBounds(uint64 MaxFrames, double MaxMs, TConstArrayView<EInputLatencyAction> RequiredActions);
+
+	/** Returns the display name for an action */
+	static const TCHAR* GetActionName(EInputLatencyAction Action);
+
+private:
+
+	/** Input that has been received but hasn't had an effect yet */
+	struct FPendingInput
+	{
+		double StartTime = 0.0;
+		uint64 StartFrame = 0;
+		bool bPending = false;
+	};
+
+	static FPendingInput PendingInputs[static_cast<int32>(EInputLatencyAction::Num)];
+	static FInputLatencyHistogram Histograms[static_cast<int32>(EInputLatencyAction::Num)];
+};
@@ -0,0 +1,162 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MapPreloadSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/Pawn.h"
+#include "Misc/PackageName.h"
+
+void UMapPreloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UMapPreloadSubsystem::OnPostLoadMap);
+}
+
+void UMapPreloadSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	Release();
+
+	Super::Deinitialize();
+}
+
+void UMapPreloadSubsystem::Preload(const FString& MapName, const TSoftClassPtr<APawn>& PawnClass)
+{
+	// drop the previous preload so we only keep one level's worth of assets in memory
+	Release();
+
+	// load the map package in the background
+	const FName MapPackageName = ResolveMapPackageName(MapName);
+
+	if (!MapPackageName.IsNone())
+	{
+		UE_LOG(LogTemp, Log, TEXT("Preloading map %s"), *MapPackageName.ToString());
+
+		PreloadedMapPackageName = MapPackageName;
+		bMapPreloadComplete = false;
+
+		LoadPackageAsync(MapPackageName.ToString(), FLoadPackageAsyncDelegate::CreateUObject(this, &UMapPreloadSubsystem::OnMapPackageLoaded));
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not find map %s to preload"), *MapName);
+	}
+
+	// load the pawn class in the background
+	if (!PawnClass.IsNull())
+	{
+		FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+		PreloadedClassHandle = StreamableManager.RequestAsyncLoad(PawnClass.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &UMapPreloadSubsystem::OnClassLoaded));
+
+		// the class may already be in memory, in which case the handle completes synchronously
+		bClassPreloadComplete = !PreloadedClassHandle.IsValid() || PreloadedClassHandle->HasLoadCompleted();
+	}
+}
+
+FName UMapPreloadSubsystem::ResolveMapPackageName(const FString& MapName)
+{
+	if (MapName.IsEmpty())
+	{
+		return NAME_None;
+	}
+
+	// long names don't need resolving
+	if (!FPackageName::IsShortPackageName(MapName))
+	{
+		return FName(*MapName);
+	}
+
+	if (const FName* ResolvedName = ResolvedMapPackageNames.Find(MapName))
+	{
+		return *ResolvedName;
+	}
+
+	// search the disk once, failures are cached too
+	FName ResolvedName = NAME_None;
+	FString LongPackageName;
+
+	if (FPackageName::SearchForPackageOnDisk(MapName + FPackageName::GetMapPackageExtension(), &LongPackageName))
+	{
+		ResolvedName = FName(*LongPackageName);
+	}
+
+	ResolvedMapPackageNames.Add(MapName, ResolvedName);
+
+	return ResolvedName;
+}
+
+void UMapPreloadSubsystem::Release()
+{
+	++PreloadSerial;
+
+	PreloadedMapPackage = nullptr;
+	PreloadedMapPackageName = NAME_None;
+	bMapPreloadComplete = true;
+	bClassPreloadComplete = true;
+
+	if (PreloadedClassHandle.IsValid())
+	{
+		PreloadedClassHandle->CancelHandle();
+		PreloadedClassHandle.Reset();
+	}
+}
+
+void UMapPreloadSubsystem::OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	// ignore stale requests from a previous preload
+	if (PackageName != PreloadedMapPackageName)
+	{
+		return;
+	}
+
+	if (Result == EAsyncLoadingResult::Succeeded)
+	{
+		// keep the package referenced so it isn't garbage collected before we travel
+		PreloadedMapPackage = LoadedPackage;
+	}
+	else
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to preload map %s, it will be loaded during the transition"), *PackageName.ToString());
+	}
+
+	bMapPreloadComplete = true;
+
+	if (IsPreloadComplete())
+	{
+		OnPreloadComplete.Broadcast();
+	}
+}
+
+void UMapPreloadSubsystem::OnClassLoaded()
+{
+	bClassPreloadComplete = true;
+
+	if (IsPreloadComplete())
+	{
+		OnPreloadComplete.Broadcast();
+	}
+}
+
+void UMapPreloadSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	// is there anything to hold on to?
+	if (!LoadedWorld || (!PreloadedMapPackage && !PreloadedClassHandle.IsValid()))
+	{
+		return;
+	}
+
+	// the new map's actors may still need the preloaded class while they begin play, so release it afterwards.
+	// Skip the release if a new preload was started in the meantime
+	const uint32 Serial = PreloadSerial;
+
+	LoadedWorld->OnWorldBeginPlay.AddWeakLambda(this, [this, Serial]()
+	{
+		if (Serial == PreloadSerial)
+		{
+			Release();
+		}
+	});
+}
@@ -0,0 +1,87 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/SoftObjectPtr.h"
+#include "UObject/UObjectGlobals.h"
+#include "MapPreloadSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ *  Keeps a preloaded map package and pawn class in memory across a level transition.
+ *  The menu starts the preload, the references are held by the game instance so the garbage collection
+ *  during OpenLevel doesn't throw them away, and they are released once the new map has begun play.
+ */
+UCLASS()
+class MYSIDESCROLL_API UMapPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Map package kept in memory so the level transition doesn't hit the disk */
+	UPROPERTY(Transient)
+	TObjectPtr<UPackage> PreloadedMapPackage;
+
+	/** Streaming handle keeping the preloaded pawn class in memory */
+	TSharedPtr<FStreamableHandle> PreloadedClassHandle;
+
+	/** Long package name of the map currently being preloaded */
+	FName PreloadedMapPackageName;
+
+	/** Long package names resolved from short map names, so the disk is only searched once per map */
+	TMap<FString, FName> ResolvedMapPackageNames;
+
+	/** Incremented every time a new preload starts or the preload is released */
+	uint32 PreloadSerial = 0;
+
+	/** Set when the preloaded map package has finished loading, successfully or not */
+	bool bMapPreloadComplete = true;
+
+	/** Set when the preloaded pawn class has finished loading */
+	bool bClassPreloadComplete = true;
+
+	/** Map load delegate handle */
+	FDelegateHandle PostLoadMapHandle;
+
+public:
+
+	/** Broadcast when both the map package and the pawn class of the current preload have finished loading */
+	FSimpleMulticastDelegate OnPreloadComplete;
+
+public:
+
+	/** Subscribes to map loads */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Releases the preload */
+	virtual void Deinitialize() override;
+
+public:
+
+	/** Drops the previous preload and starts asynchronously loading the map package and pawn class */
+	void Preload(const FString& MapName, const TSoftClassPtr<APawn>& PawnClass);
+
+	/** Returns true if the current preload has finished loading */
+	bool IsPreloadComplete() const { return bMapPreloadComplete && bClassPreloadComplete; }
+
+	/** Returns the long package name for a map. Short names are searched for on disk the first time they are requested */
+	FName ResolveMapPackageName(const FString& MapName);
+
+	/** Releases the preloaded map package and pawn class */
+	void Release();
+
+protected:
+
+	/** Called when the async map package load completes */
+	void OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+
+	/** Called when the async pawn class load completes */
+	void OnClassLoaded();
+
+	/** Holds the preload until the loaded world has begun play */
+	void OnPostLoadMap(UWorld* LoadedWorld);
+};
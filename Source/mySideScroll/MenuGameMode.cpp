@@ -5,6 +5,12 @@
 #include "Kismet/GameplayStatics.h"
 #include "Engine/Engine.h"
 #include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/PlatformTime.h"
+#include "StartupProfiler.h"
+#include "ProgressSaveSubsystem.h"
+#include "MapPreloadSubsystem.h"
+#include "Engine/GameInstance.h"
 
 // Initialize static variable
 ECharacterType AMenuGameMode::StaticSelectedCharacterType = ECharacterType::SideScrolling;
@@ -42,11 +48,14 @@ void AMenuGameMode::BeginPlay()
 		// Create and display the character selection widget
 		if (CharacterSelectionWidgetClass)
 		{
+			SIDESCROLL_STARTUP_SCOPE("WidgetCreation");
+
 			CharacterSelectionWidget = CreateWidget<UCharacterSelectionWidget>(PlayerController, CharacterSelectionWidgetClass);
 			if (CharacterSelectionWidget)
 			{
 				CharacterSelectionWidget->AddToViewport();
 				CharacterSelectionWidget->OnCharacterSelected.AddDynamic(this, &AMenuGameMode::OnCharacterSelected);
+				CharacterSelectionWidget->OnCharacterHighlighted.AddDynamic(this, &AMenuGameMode::OnCharacterHighlighted);
 				
 				// Set widget focus for controller input
 				CharacterSelectionWidget->SetKeyboardFocus();
@@ -57,6 +66,39 @@ void AMenuGameMode::BeginPlay()
 			UE_LOG(LogTemp, Warning, TEXT("CharacterSelectionWidgetClass is not set in MenuGameMode"));
 		}
 	}
+
+	// Resolve every map's package name up front, so highlighting doesn't search the disk
+	if (UMapPreloadSubsystem* MapPreload = GetGameInstance()->GetSubsystem<UMapPreloadSubsystem>())
+	{
+		MapPreload->ResolveMapPackageName(SideScrollingMapName);
+		MapPreload->ResolveMapPackageName(PlatformingMapName);
+		MapPreload->ResolveMapPackageName(CombatMapName);
+
+		PreloadCompleteHandle = MapPreload->OnPreloadComplete.AddUObject(this, &AMenuGameMode::TryStartPendingTransition);
+	}
+
+	// Start from the character selected in the last session
+	SelectedCharacterType = GetSelectedCharacterType();
+
+	// Start preloading the initially highlighted character right away
+	PreloadCharacter(SelectedCharacterType);
+
+	// Record the first frame the menu is interactive
+	FStartupProfiler::MarkFirstPlayableFrameNextTick(GetWorld());
+}
+
+void AMenuGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// clear the transition timer
+	GetWorld()->GetTimerManager().ClearTimer(TransitionTimer);
+
+	// the preload itself is kept by the game instance until the new level begins play
+	if (UMapPreloadSubsystem* MapPreload = GetGameInstance()->GetSubsystem<UMapPreloadSubsystem>())
+	{
+		MapPreload->OnPreloadComplete.Remove(PreloadCompleteHandle);
+	}
 }
 
 void AMenuGameMode::OnCharacterSelected(ECharacterType CharacterType)
@@ -65,13 +107,95 @@ void AMenuGameMode::OnCharacterSelected(ECharacterType CharacterType)
 	
 	SelectedCharacterType = CharacterType;
 	SetSelectedCharacterType(CharacterType);
+
+	// Remember the selection between sessions
+	if (UProgressSaveSubsystem* ProgressSave = GetGameInstance()->GetSubsystem<UProgressSaveSubsystem>())
+	{
+		ProgressSave->SetSelectedCharacter(CharacterType);
+	}
+
+	// Start measuring the time it takes to get into gameplay
+	SelectionTime = FPlatformTime::Seconds();
+	FStartupProfiler::MarkSelectionConfirmed();
+
+	// Make sure the selected character is the one being preloaded
+	PreloadCharacter(CharacterType);
 	
-	// Add a small delay before transitioning to make the selection feel more responsive
-	FTimerHandle TimerHandle;
-	GetWorld()->GetTimerManager().SetTimer(TimerHandle, [this, CharacterType]()
+	// Add a small delay before transitioning to make the selection feel more responsive.
+	// The level is only opened once the preload has also completed
+	bTransitionPending = false;
+
+	GetWorld()->GetTimerManager().SetTimer(TransitionTimer, [this]()
 	{
-		StartGameWithCharacter(CharacterType);
-	}, 0.5f, false);
+		bTransitionPending = true;
+		TryStartPendingTransition();
+	}, FMath::Max(TransitionDelay, KINDA_SMALL_NUMBER), false);
+}
+
+void AMenuGameMode::OnCharacterHighlighted(ECharacterType CharacterType)
+{
+	// Don't switch preloads once a selection has been confirmed
+	if (TransitionTimer.IsValid() || bTransitionPending)
+	{
+		return;
+	}
+
+	PreloadCharacter(CharacterType);
+}
+
+void AMenuGameMode::PreloadCharacter(ECharacterType CharacterType)
+{
+	// Is this character already preloading?
+	if (CharacterType == PreloadedCharacterType)
+	{
+		return;
+	}
+
+	PreloadedCharacterType = CharacterType;
+
+	UE_LOG(LogTemp, Log, TEXT("Preloading character type: %d"), (int32)CharacterType);
+
+	if (UMapPreloadSubsystem* MapPreload = GetGameInstance()->GetSubsystem<UMapPreloadSubsystem>())
+	{
+		MapPreload->Preload(GetMapNameForCharacter(CharacterType), GetPreloadClassForCharacter(CharacterType));
+	}
+}
+
+bool AMenuGameMode::IsPreloadComplete(ECharacterType CharacterType) const
+{
+	const UMapPreloadSubsystem* MapPreload = GetGameInstance()->GetSubsystem<UMapPreloadSubsystem>();
+
+	return CharacterType == PreloadedCharacterType && (!MapPreload || MapPreload->IsPreloadComplete());
+}
+
+TSoftClassPtr<APawn> AMenuGameMode::GetPreloadClassForCharacter(ECharacterType CharacterType) const
+{
+	switch (CharacterType)
+	{
+	case ECharacterType::SideScrolling:
+		return SideScrollingPreloadClass;
+	case ECharacterType::Platforming:
+		return PlatformingPreloadClass;
+	case ECharacterType::Combat:
+		return CombatPreloadClass;
+	default:
+		return TSoftClassPtr<APawn>();
+	}
+}
+
+void AMenuGameMode::TryStartPendingTransition()
+{
+	// Has the transition delay elapsed and is the selected character ready?
+	if (!bTransitionPending || !IsPreloadComplete(SelectedCharacterType))
+	{
+		return;
+	}
+
+	bTransitionPending = false;
+
+	UE_LOG(LogTemp, Log, TEXT("Preload complete %.3f s after selection, opening level"), FPlatformTime::Seconds() - SelectionTime);
+
+	StartGameWithCharacter(SelectedCharacterType);
 }
 
 void AMenuGameMode::StartGameWithCharacter(ECharacterType CharacterType)
@@ -118,4 +242,4 @@ ECharacterType AMenuGameMode::GetSelectedCharacterType()
 void AMenuGameMode::SetSelectedCharacterType(ECharacterType CharacterType)
 {
 	StaticSelectedCharacterType = CharacterType;
-} 
\ No newline at end of file
+} 
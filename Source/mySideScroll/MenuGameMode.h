@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
 #include "CharacterSelectionWidget.h"
+#include "UObject/SoftObjectPtr.h"
 #include "MenuGameMode.generated.h"
 
 /**
@@ -22,6 +23,9 @@ public:
 protected:
 	virtual void BeginPlay() override;
 
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	/** Character selection widget class */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "UI")
@@ -41,6 +45,20 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game")
 	FString CombatMapName;
 
+	/** Character classes to preload while each character type is highlighted */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Game|Preload")
+	TSoftClassPtr<APawn> SideScrollingPreloadClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Game|Preload")
+	TSoftClassPtr<APawn> PlatformingPreloadClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Game|Preload")
+	TSoftClassPtr<APawn> CombatPreloadClass;
+
+	/** Minimum time between confirming a selection and opening the level, so the selection feels responsive */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game|Preload", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
+	float TransitionDelay = 0.5f;
+
 	/** Currently selected character type */
 	UPROPERTY(BlueprintReadOnly, Category = "Game")
 	ECharacterType SelectedCharacterType;
@@ -58,6 +76,23 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Game")
 	FString GetMapNameForCharacter(ECharacterType CharacterType) const;
 
+	/** Called when a character is highlighted in the selection widget */
+	UFUNCTION()
+	void OnCharacterHighlighted(ECharacterType CharacterType);
+
+	/** Starts asynchronously loading the map package and character class for the character type */
+	UFUNCTION(BlueprintCallable, Category = "Game")
+	void PreloadCharacter(ECharacterType CharacterType);
+
+	/** Returns true if the preload for the character type has finished */
+	bool IsPreloadComplete(ECharacterType CharacterType) const;
+
+	/** Get the character class to preload for the character type */
+	TSoftClassPtr<APawn> GetPreloadClassForCharacter(ECharacterType CharacterType) const;
+
+	/** Opens the level once both the transition delay has elapsed and the preload has completed */
+	void TryStartPendingTransition();
+
 public:
 	/** Static function to get the selected character from anywhere */
 	UFUNCTION(BlueprintCallable, Category = "Game")
@@ -67,6 +102,22 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Game")
 	static void SetSelectedCharacterType(ECharacterType CharacterType);
 
+protected:
+	/** Character type currently being preloaded */
+	ECharacterType PreloadedCharacterType = ECharacterType::None;
+
+	/** Platform time at which the character was confirmed */
+	double SelectionTime = 0.0;
+
+	/** Set after the transition delay has elapsed while waiting for the preload */
+	bool bTransitionPending = false;
+
+	/** Transition delay timer */
+	FTimerHandle TransitionTimer;
+
+	/** Preload completion delegate handle */
+	FDelegateHandle PreloadCompleteHandle;
+
 private:
 	/** Static variable to store selected character across level transitions */
 	static ECharacterType StaticSelectedCharacterType;
@@ -0,0 +1,425 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "PhysicsPropSubsystem.h"
+#include "mySideScroll.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+
+DEFINE_LOG_CATEGORY(LogPhysicsProps);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Physics Props Active"), STAT_PhysicsPropsActive, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Physics Props Sleeping"), STAT_PhysicsPropsSleeping, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Physics Props Kinematic"), STAT_PhysicsPropsKinematic, STATGROUP_SideScroll);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Physics Frame Time (ms)"), STAT_PhysicsPropsFrameTime, STATGROUP_SideScroll);
+
+TRACE_DECLARE_INT_COUNTER(PhysicsPropsActive, TEXT("Physics/Props/Active"));
+TRACE_DECLARE_INT_COUNTER(PhysicsPropsSleeping, TEXT("Physics/Props/Sleeping"));
+TRACE_DECLARE_INT_COUNTER(PhysicsPropsKinematic, TEXT("Physics/Props/Kinematic"));
+TRACE_DECLARE_FLOAT_COUNTER(PhysicsPropsFrameTime, TEXT("Physics/Props/Frame Time (ms)"));
+
+static TAutoConsoleVariable<bool> CVarPhysicsPropsEnabled(
+	TEXT("PhysicsProps.Enabled"),
+	true,
+	TEXT("If true, physics props far from the players are put to sleep or stop simulating."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPhysicsPropsWakeDistance(
+	TEXT("PhysicsProps.WakeDistance"),
+	1000.0f,
+	TEXT("Distance in cm from a player at which props are brought back into the simulation and woken up."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPhysicsPropsSleepDistance(
+	TEXT("PhysicsProps.SleepDistance"),
+	2000.0f,
+	TEXT("Distance in cm from the nearest player beyond which props are put to sleep."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPhysicsPropsKinematicDistance(
+	TEXT("PhysicsProps.KinematicDistance"),
+	4000.0f,
+	TEXT("Distance in cm from the nearest player beyond which props stop simulating."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarPhysicsPropsMaxActive(
+	TEXT("PhysicsProps.MaxActive"),
+	32,
+	TEXT("Max number of awake prop bodies. The farthest ones beyond the wake distance are put to sleep when over budget."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPhysicsPropsUpdateInterval(
+	TEXT("PhysicsProps.UpdateInterval"),
+	0.25f,
+	TEXT("Time in seconds between prop significance updates."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld CCmdPhysicsPropsStats(
+	TEXT("PhysicsProps.Stats"),
+	TEXT("Logs the number of active, sleeping and kinematic physics props and the physics frame time."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UPhysicsPropSubsystem* PhysicsProps = World ? World->GetSubsystem<UPhysicsPropSubsystem>() : nullptr)
+		{
+			PhysicsProps->LogStats();
+		}
+	}));
+
+bool UPhysicsPropSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UPhysicsPropSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPhysicsPropSubsystem, STATGROUP_Tickables);
+}
+
+void UPhysicsPropSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// props in streamed levels come and go with their level
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UPhysicsPropSubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UPhysicsPropSubsystem::OnLevelRemoved);
+}
+
+void UPhysicsPropSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// pick up the simulating props placed in the level
+	for (TActorIterator<AActor> It(&InWorld); It; ++It)
+	{
+		RegisterPlacedProps(*It);
+	}
+
+	// time the physics frame
+	if (FPhysScene* PhysScene = InWorld.GetPhysicsScene())
+	{
+		PhysicsPreTickHandle = PhysScene->OnPhysScenePreTick.AddUObject(this, &UPhysicsPropSubsystem::OnPhysicsPreTick);
+		PhysicsPostTickHandle = PhysScene->OnPhysScenePostTick.AddUObject(this, &UPhysicsPropSubsystem::OnPhysicsPostTick);
+	}
+
+	UE_LOG(LogPhysicsProps, Log, TEXT("Managing %d physics props"), Props.Num());
+}
+
+void UPhysicsPropSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	// levels added before begin play are gathered by OnWorldBeginPlay
+	if (!Level || World != GetWorld() || !World->HasBegunPlay())
+	{
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor)
+		{
+			RegisterPlacedProps(Actor);
+		}
+	}
+}
+
+void UPhysicsPropSubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	// a null level means every level is being removed
+	Props.RemoveAllSwap([Level](const FPhysicsPropEntry& Entry)
+	{
+		const UPrimitiveComponent* Body = Entry.Body.Get();
+		return !Level || !Body || Body->GetComponentLevel() == Level;
+	}, EAllowShrinking::No);
+}
+
+void UPhysicsPropSubsystem::RegisterPlacedProps(AActor* Actor)
+{
+	// characters and ragdolls are handled elsewhere
+	if (Actor->IsA<APawn>())
+	{
+		return;
+	}
+
+	Actor->ForEachComponent<UPrimitiveComponent>(false, [this](UPrimitiveComponent* Primitive)
+	{
+		if (Primitive->Mobility == EComponentMobility::Movable && Primitive->IsSimulatingPhysics() && !Primitive->IsA<USkeletalMeshComponent>())
+		{
+			RegisterProp(Primitive);
+		}
+	});
+}
+
+void UPhysicsPropSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	if (FPhysScene* PhysScene = GetWorld()->GetPhysicsScene())
+	{
+		PhysScene->OnPhysScenePreTick.Remove(PhysicsPreTickHandle);
+		PhysScene->OnPhysScenePostTick.Remove(PhysicsPostTickHandle);
+	}
+
+	Props.Reset();
+
+	Super::Deinitialize();
+}
+
+void UPhysicsPropSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!CVarPhysicsPropsEnabled.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	// props don't need to react every frame
+	TimeUntilUpdate -= DeltaTime;
+
+	if (TimeUntilUpdate > 0.0f)
+	{
+		return;
+	}
+
+	TimeUntilUpdate = CVarPhysicsPropsUpdateInterval.GetValueOnGameThread();
+
+	UpdateSignificance();
+}
+
+void UPhysicsPropSubsystem::RegisterProp(UPrimitiveComponent* Body)
+{
+	if (!IsValid(Body) || IsConstrained(Body) || Props.ContainsByPredicate([Body](const FPhysicsPropEntry& Entry) { return Entry.Body.Get() == Body; }))
+	{
+		return;
+	}
+
+	FPhysicsPropEntry& Entry = Props.AddDefaulted_GetRef();
+	Entry.Body = Body;
+}
+
+void UPhysicsPropSubsystem::UnregisterProp(UPrimitiveComponent* Body)
+{
+	Props.RemoveAllSwap([Body](const FPhysicsPropEntry& Entry) { return Entry.Body.Get() == Body; }, EAllowShrinking::No);
+}
+
+bool UPhysicsPropSubsystem::IsConstrained(UPrimitiveComponent* Body)
+{
+	const AActor* Owner = Body->GetOwner();
+
+	if (!Owner)
+	{
+		return false;
+	}
+
+	// toggling the simulation or sleeping one side of a constraint breaks it, so leave jointed bodies alone
+	bool bConstrained = false;
+
+	Owner->ForEachComponent<UPhysicsConstraintComponent>(false, [Body, &bConstrained](UPhysicsConstraintComponent* Constraint)
+	{
+		UPrimitiveComponent* Component1 = nullptr;
+		UPrimitiveComponent* Component2 = nullptr;
+		FName BoneName1, BoneName2;
+
+		Constraint->GetConstrainedComponents(Component1, BoneName1, Component2, BoneName2);
+
+		bConstrained |= (Component1 == Body || Component2 == Body);
+	});
+
+	return bConstrained;
+}
+
+void UPhysicsPropSubsystem::WakeProp(UPrimitiveComponent* Body)
+{
+	FPhysicsPropEntry* Entry = Props.FindByPredicate([Body](const FPhysicsPropEntry& Entry) { return Entry.Body.Get() == Body; });
+
+	if (!Entry || !IsValid(Body))
+	{
+		return;
+	}
+
+	// bring the body back into the simulation
+	if (Entry->bMadeKinematic)
+	{
+		Body->SetSimulatePhysics(true);
+		Entry->bMadeKinematic = false;
+	}
+
+	Body->WakeRigidBody();
+	Entry->bForcedAsleep = false;
+}
+
+void UPhysicsPropSubsystem::UpdateSignificance()
+{
+	// find the players
+	TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* Pawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	const double WakeDistSquared = FMath::Square(double(CVarPhysicsPropsWakeDistance.GetValueOnGameThread()));
+	const double SleepDistSquared = FMath::Square(double(CVarPhysicsPropsSleepDistance.GetValueOnGameThread()));
+	const double KinematicDistSquared = FMath::Square(double(CVarPhysicsPropsKinematicDistance.GetValueOnGameThread()));
+
+	Props.RemoveAllSwap([](const FPhysicsPropEntry& Entry) { return !Entry.Body.IsValid(); }, EAllowShrinking::No);
+
+	NumSleeping = 0;
+	NumKinematic = 0;
+
+	// awake props within the wake distance always stay awake, only the ones past it can be put to sleep by the budget
+	int32 NumNearby = 0;
+	TArray<int32, TInlineAllocator<64>> AwakeProps;
+
+	for (int32 i = 0; i < Props.Num(); ++i)
+	{
+		FPhysicsPropEntry& Entry = Props[i];
+		UPrimitiveComponent* Body = Entry.Body.Get();
+
+		// someone else turned the simulation back on, e.g. a checkpoint restore
+		if (Entry.bMadeKinematic && Body->IsSimulatingPhysics())
+		{
+			Entry.bMadeKinematic = false;
+		}
+
+		// leave props alone while their owner has switched them off
+		if (!Entry.bMadeKinematic && !Body->IsSimulatingPhysics())
+		{
+			continue;
+		}
+
+		// distance to the nearest player. Without players, everything is far away
+		Entry.DistanceSquared = TNumericLimits<double>::Max();
+
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			Entry.DistanceSquared = FMath::Min(Entry.DistanceSquared, FVector::DistSquared(PlayerLocation, Body->GetComponentLocation()));
+		}
+
+		if (Entry.bMadeKinematic)
+		{
+			// stay out of the simulation until a player comes close
+			if (Entry.DistanceSquared > WakeDistSquared)
+			{
+				++NumKinematic;
+				continue;
+			}
+
+			Body->SetSimulatePhysics(true);
+			Entry.bMadeKinematic = false;
+		}
+		else if (Entry.DistanceSquared > KinematicDistSquared)
+		{
+			// take the body out of the simulation
+			Body->SetSimulatePhysics(false);
+			Entry.bMadeKinematic = true;
+			Entry.bForcedAsleep = false;
+
+			++NumKinematic;
+			continue;
+		}
+
+		if (Body->RigidBodyIsAwake())
+		{
+			if (Entry.DistanceSquared > SleepDistSquared)
+			{
+				Body->PutRigidBodyToSleep();
+				Entry.bForcedAsleep = true;
+
+				++NumSleeping;
+			}
+			else if (Entry.DistanceSquared <= WakeDistSquared)
+			{
+				++NumNearby;
+			}
+			else
+			{
+				AwakeProps.Add(i);
+			}
+		}
+		else if (Entry.bForcedAsleep && Entry.DistanceSquared <= WakeDistSquared)
+		{
+			// we may have frozen it midair, so let it carry on now that it can be seen
+			Body->WakeRigidBody();
+			Entry.bForcedAsleep = false;
+
+			++NumNearby;
+		}
+		else
+		{
+			++NumSleeping;
+		}
+	}
+
+	// over budget? put the farthest awake bodies to sleep. Nearby props can't be put to sleep, or they'd be woken right back up
+	const int32 MaxActive = FMath::Max(CVarPhysicsPropsMaxActive.GetValueOnGameThread() - NumNearby, 0);
+
+	if (AwakeProps.Num() > MaxActive)
+	{
+		AwakeProps.Sort([this](int32 A, int32 B) { return Props[A].DistanceSquared < Props[B].DistanceSquared; });
+
+		for (int32 i = MaxActive; i < AwakeProps.Num(); ++i)
+		{
+			FPhysicsPropEntry& Entry = Props[AwakeProps[i]];
+
+			Entry.Body->PutRigidBodyToSleep();
+			Entry.bForcedAsleep = true;
+		}
+
+		NumSleeping += AwakeProps.Num() - MaxActive;
+		AwakeProps.SetNum(MaxActive, EAllowShrinking::No);
+	}
+
+	NumActive = NumNearby + AwakeProps.Num();
+
+	SET_DWORD_STAT(STAT_PhysicsPropsActive, NumActive);
+	SET_DWORD_STAT(STAT_PhysicsPropsSleeping, NumSleeping);
+	SET_DWORD_STAT(STAT_PhysicsPropsKinematic, NumKinematic);
+
+	TRACE_COUNTER_SET(PhysicsPropsActive, NumActive);
+	TRACE_COUNTER_SET(PhysicsPropsSleeping, NumSleeping);
+	TRACE_COUNTER_SET(PhysicsPropsKinematic, NumKinematic);
+}
+
+void UPhysicsPropSubsystem::OnPhysicsPreTick(FPhysScene_Chaos* PhysScene, float DeltaTime)
+{
+	PhysicsStartCycles = FPlatformTime::Cycles64();
+}
+
+void UPhysicsPropSubsystem::OnPhysicsPostTick(FPhysScene_Chaos* PhysScene)
+{
+	if (PhysicsStartCycles == 0)
+	{
+		return;
+	}
+
+	// time from kicking off the physics frame to its results being available on the game thread
+	LastPhysicsTimeMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - PhysicsStartCycles);
+	PhysicsStartCycles = 0;
+
+	SET_FLOAT_STAT(STAT_PhysicsPropsFrameTime, LastPhysicsTimeMs);
+	TRACE_COUNTER_SET(PhysicsPropsFrameTime, LastPhysicsTimeMs);
+}
+
+void UPhysicsPropSubsystem::LogStats() const
+{
+	UE_LOG(LogPhysicsProps, Log, TEXT("Physics props: %d managed, %d active, %d sleeping, %d kinematic, physics frame %.2f ms"), Props.Num(), NumActive, NumSleeping, NumKinematic, LastPhysicsTimeMs);
+}
@@ -0,0 +1,127 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "PhysicsPropSubsystem.generated.h"
+
+class UPrimitiveComponent;
+class ULevel;
+class FPhysScene_Chaos;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPhysicsProps, Log, All);
+
+/**
+ *  Physics prop managed by the subsystem
+ */
+struct FPhysicsPropEntry
+{
+	/** Simulated body */
+	TWeakObjectPtr<UPrimitiveComponent> Body;
+
+	/** True if the subsystem turned off the simulation, so it knows to turn it back on */
+	bool bMadeKinematic = false;
+
+	/** True if the subsystem put the body to sleep, so it knows to wake it back up */
+	bool bForcedAsleep = false;
+
+	/** Squared distance to the nearest player at the last update */
+	double DistanceSquared = 0.0;
+};
+
+/**
+ *  Keeps the number of simulating rigid bodies in check
+ *  - Props away from the players are put to sleep
+ *  - Props far from the players stop simulating until a player gets close again
+ *  - The number of awake bodies is capped, putting the farthest ones beyond the wake distance to sleep first
+ *  Props wake on player proximity, or when they take damage through WakeProp.
+ *  Bodies held by a physics constraint are never managed.
+ *  Simulating movable props in the level and in streamed levels are picked up automatically, actors spawned later register themselves.
+ *  Active, sleeping and kinematic counts and the physics frame time are published to the SideScroll stat group.
+ */
+UCLASS()
+class MYSIDESCROLL_API UPhysicsPropSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Managed props */
+	TArray<FPhysicsPropEntry> Props;
+
+	/** Time left until the next significance update */
+	float TimeUntilUpdate = 0.0f;
+
+	/** Body counts at the last update */
+	int32 NumActive = 0;
+	int32 NumSleeping = 0;
+	int32 NumKinematic = 0;
+
+	/** Physics frame timing */
+	uint64 PhysicsStartCycles = 0;
+	double LastPhysicsTimeMs = 0.0;
+
+	/** Physics scene delegate handles */
+	FDelegateHandle PhysicsPreTickHandle;
+	FDelegateHandle PhysicsPostTickHandle;
+
+	/** Streamed level delegate handles */
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Subscribes to streamed level changes */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Picks up the simulating props placed in the level */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Updates prop significance */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat id for the tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Adds a simulated body to the manager */
+	void RegisterProp(UPrimitiveComponent* Body);
+
+	/** Removes a body from the manager */
+	void UnregisterProp(UPrimitiveComponent* Body);
+
+	/** Makes sure the body is simulating and awake, e.g. before applying a damage impulse */
+	void WakeProp(UPrimitiveComponent* Body);
+
+	/** Logs the body counts */
+	void LogStats() const;
+
+protected:
+
+	/** Picks up the simulating props placed in a streamed level */
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+
+	/** Drops the props of a streamed level */
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+
+	/** Registers the simulating bodies of an actor placed in a level */
+	void RegisterPlacedProps(AActor* Actor);
+
+	/** Returns true if the body is held by one of its owner's physics constraints */
+	static bool IsConstrained(UPrimitiveComponent* Body);
+
+	/** Puts distant props to sleep or turns off their simulation, and wakes the ones close to players */
+	void UpdateSignificance();
+
+	/** Measures the physics frame time */
+	void OnPhysicsPreTick(FPhysScene_Chaos* PhysScene, float DeltaTime);
+	void OnPhysicsPostTick(FPhysScene_Chaos* PhysScene);
+};
@@ -0,0 +1,771 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "PlatformGraphSubsystem.h"
+#include "SideScrollMemory.h"
+#include "SideScrollingJumpPad.h"
+#include "SideScrollingSoftPlatform.h"
+#include "SideScrollingMovingPlatform.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerStart.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+#include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Tasks/Task.h"
+#include "Algo/Reverse.h"
+#include "Math/RandomStream.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY(LogPlatformGraph);
+
+static TAutoConsoleVariable<float> CVarPlatformGraphStepHeight(
+	TEXT("SideScrolling.PlatformGraph.StepHeight"),
+	45.0f,
+	TEXT("Max height difference between two platforms that can be walked across, in cm."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPlatformGraphMaxJumpHeight(
+	TEXT("SideScrolling.PlatformGraph.MaxJumpHeight"),
+	250.0f,
+	TEXT("Max height an AI character can jump up to another platform, in cm."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPlatformGraphMaxJumpDistance(
+	TEXT("SideScrolling.PlatformGraph.MaxJumpDistance"),
+	400.0f,
+	TEXT("Max horizontal gap an AI character can jump across, in cm."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPlatformGraphMaxDropHeight(
+	TEXT("SideScrolling.PlatformGraph.MaxDropHeight"),
+	1500.0f,
+	TEXT("Max height an AI character will drop down from, in cm."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarPlatformGraphMaxCachedPaths(
+	TEXT("SideScrolling.PlatformGraph.MaxCachedPaths"),
+	1024,
+	TEXT("Max number of node to node paths kept in the shared path cache. The cache is flushed when full."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs CCmdPlatformGraphDraw(
+	TEXT("SideScrolling.PlatformGraph.Draw"),
+	TEXT("Draws the AI platform graph. Usage: SideScrolling.PlatformGraph.Draw [Duration=10]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (const UPlatformGraphSubsystem* PlatformGraph = World ? World->GetSubsystem<UPlatformGraphSubsystem>() : nullptr)
+		{
+			PlatformGraph->DrawDebugGraph(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 10.0f);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs CCmdPlatformGraphBenchmark(
+	TEXT("SideScrolling.PlatformGraph.Benchmark"),
+	TEXT("Measures platform graph path query latency. Usage: SideScrolling.PlatformGraph.Benchmark [NumQueries=10000]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const UPlatformGraphSubsystem* PlatformGraph = World ? World->GetSubsystem<UPlatformGraphSubsystem>() : nullptr;
+		const TSharedPtr<const FPlatformGraph, ESPMode::ThreadSafe> Graph = PlatformGraph ? PlatformGraph->GetGraph() : nullptr;
+
+		if (!Graph.IsValid() || Graph->Nodes.Num() < 2)
+		{
+			UE_LOG(LogPlatformGraph, Warning, TEXT("No platform graph to benchmark"));
+			return;
+		}
+
+		const int32 NumQueries = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+
+		// pick random start and goal locations on top of the platforms
+		FRandomStream Random(1234);
+		TArray<TPair<FVector, FVector>> Queries;
+		Queries.Reserve(NumQueries);
+
+		auto RandomLocation = [&Random, &Graph]()
+		{
+			const FPlatformGraphNode& Node = Graph->Nodes[Random.RandRange(0, Graph->Nodes.Num() - 1)];
+			return FVector(Random.FRandRange(Node.MinX, Node.MaxX), Graph->PlaneY, Node.Z + 50.0f);
+		};
+
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			Queries.Emplace(RandomLocation(), RandomLocation());
+		}
+
+		std::atomic<int32> NumFound(0);
+
+		auto RunQueries = [&](bool bParallel, bool bUseCache)
+		{
+			NumFound = 0;
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			ParallelFor(NumQueries, [&](int32 Index)
+			{
+				FPlatformPath Path;
+
+				if (Graph->FindPath(Queries[Index].Key, Queries[Index].Value, true, Path, bUseCache))
+				{
+					++NumFound;
+				}
+			}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+			return (FPlatformTime::Seconds() - StartTime) * 1000000.0 / NumQueries;
+		};
+
+		Graph->ResetCache();
+
+		const double SerialUncached = RunQueries(false, false);
+		const double ParallelUncached = RunQueries(true, false);
+
+		// warm up the cache before measuring cache hits
+		RunQueries(true, true);
+		const double SerialCached = RunQueries(false, true);
+		const double ParallelCached = RunQueries(true, true);
+
+		UE_LOG(LogPlatformGraph, Log, TEXT("Platform graph benchmark: %d queries over %d nodes and %d edges, %d paths found"), NumQueries, Graph->Nodes.Num(), Graph->Edges.Num(), NumFound.load());
+		UE_LOG(LogPlatformGraph, Log, TEXT("  serial uncached:   %.3f us per query"), SerialUncached);
+		UE_LOG(LogPlatformGraph, Log, TEXT("  parallel uncached: %.3f us per query"), ParallelUncached);
+		UE_LOG(LogPlatformGraph, Log, TEXT("  serial cached:     %.3f us per query"), SerialCached);
+		UE_LOG(LogPlatformGraph, Log, TEXT("  parallel cached:   %.3f us per query"), ParallelCached);
+	}));
+
+namespace PlatformGraph
+{
+	/** Open list entry for the A* search */
+	struct FOpenEntry
+	{
+		float EstimatedCost;
+		float CostSoFar;
+		int32 Node;
+
+		bool operator<(const FOpenEntry& Other) const { return EstimatedCost < Other.EstimatedCost; }
+	};
+
+	/** Per thread search buffers, reused across queries so searches don't allocate */
+	struct FSearchScratch
+	{
+		TArray<float> CostSoFar;
+		TArray<int32> ParentNode;
+		TArray<int32> ParentEdge;
+		TArray<uint32> VisitStamp;
+		TArray<FOpenEntry> OpenList;
+		uint32 Stamp = 0;
+
+		void Prepare(int32 NumNodes)
+		{
+			if (VisitStamp.Num() < NumNodes)
+			{
+				CostSoFar.SetNumUninitialized(NumNodes);
+				ParentNode.SetNumUninitialized(NumNodes);
+				ParentEdge.SetNumUninitialized(NumNodes);
+				VisitStamp.SetNumZeroed(NumNodes);
+			}
+
+			// a new stamp invalidates the previous search without clearing the arrays
+			if (++Stamp == 0)
+			{
+				FMemory::Memzero(VisitStamp.GetData(), VisitStamp.Num() * sizeof(uint32));
+				Stamp = 1;
+			}
+
+			OpenList.Reset();
+		}
+	};
+
+	/** Traversal cost multipliers. Never lower than one so the straight line heuristic stays admissible */
+	static float GetLinkCostScale(EPlatformLinkType Type)
+	{
+		switch (Type)
+		{
+		case EPlatformLinkType::Jump:
+			return 1.5f;
+		case EPlatformLinkType::Drop:
+			return 1.2f;
+		case EPlatformLinkType::DropThrough:
+			return 1.1f;
+		case EPlatformLinkType::JumpPad:
+			return 1.3f;
+		default:
+			return 1.0f;
+		}
+	}
+
+	/** Returns the horizontal gap between two platforms, or zero if they overlap */
+	static float GetHorizontalGap(const FPlatformGraphNode& A, const FPlatformGraphNode& B)
+	{
+		return FMath::Max3(B.MinX - A.MaxX, A.MinX - B.MaxX, 0.0f);
+	}
+
+	/** Returns a debug color for a link type */
+	static FColor GetLinkColor(EPlatformLinkType Type)
+	{
+		switch (Type)
+		{
+		case EPlatformLinkType::Jump:
+			return FColor::Yellow;
+		case EPlatformLinkType::Drop:
+			return FColor::Orange;
+		case EPlatformLinkType::DropThrough:
+			return FColor::Cyan;
+		case EPlatformLinkType::JumpPad:
+			return FColor::Magenta;
+		default:
+			return FColor::Green;
+		}
+	}
+}
+
+int32 FPlatformGraph::FindNode(const FVector& Location, float MaxHeightAbove /*= 200.0f*/) const
+{
+	int32 BestNode = INDEX_NONE;
+	float BestHeight = MAX_flt;
+
+	// find the highest platform under the location
+	for (int32 i = 0; i < Nodes.Num(); ++i)
+	{
+		const FPlatformGraphNode& Node = Nodes[i];
+		const float Height = Location.Z - Node.Z;
+
+		if (Location.X >= Node.MinX && Location.X <= Node.MaxX && Height >= -1.0f && Height <= MaxHeightAbove && Height < BestHeight)
+		{
+			BestHeight = Height;
+			BestNode = i;
+		}
+	}
+
+	return BestNode;
+}
+
+bool FPlatformGraph::FindNodePath(int32 StartNode, int32 GoalNode, bool bCanPassThroughSoft, TArray<int32>& OutEdgePath) const
+{
+	using namespace PlatformGraph;
+
+	OutEdgePath.Reset();
+
+	if (!Nodes.IsValidIndex(StartNode) || !Nodes.IsValidIndex(GoalNode))
+	{
+		return false;
+	}
+
+	if (StartNode == GoalNode)
+	{
+		return true;
+	}
+
+	static thread_local FSearchScratch Scratch;
+	Scratch.Prepare(Nodes.Num());
+
+	const FVector2f GoalCenter = Nodes[GoalNode].GetCenter();
+
+	Scratch.VisitStamp[StartNode] = Scratch.Stamp;
+	Scratch.CostSoFar[StartNode] = 0.0f;
+	Scratch.OpenList.HeapPush(FOpenEntry{ FVector2f::Distance(Nodes[StartNode].GetCenter(), GoalCenter), 0.0f, StartNode });
+
+	while (!Scratch.OpenList.IsEmpty())
+	{
+		FOpenEntry Entry;
+		Scratch.OpenList.HeapPop(Entry, EAllowShrinking::No);
+
+		// skip entries superseded by a cheaper route
+		if (Entry.CostSoFar > Scratch.CostSoFar[Entry.Node])
+		{
+			continue;
+		}
+
+		if (Entry.Node == GoalNode)
+		{
+			// walk the parent links back to the start
+			for (int32 Node = GoalNode; Node != StartNode; Node = Scratch.ParentNode[Node])
+			{
+				OutEdgePath.Add(Scratch.ParentEdge[Node]);
+			}
+
+			Algo::Reverse(OutEdgePath);
+
+			return true;
+		}
+
+		for (int32 EdgeIndex = EdgeOffsets[Entry.Node]; EdgeIndex < EdgeOffsets[Entry.Node + 1]; ++EdgeIndex)
+		{
+			const FPlatformGraphEdge& Edge = Edges[EdgeIndex];
+
+			// skip links the agent can't traverse
+			if (Edge.bRequiresPassThrough && !bCanPassThroughSoft)
+			{
+				continue;
+			}
+
+			const float NewCost = Entry.CostSoFar + Edge.Cost;
+			const int32 Target = Edge.TargetNode;
+
+			if (Scratch.VisitStamp[Target] != Scratch.Stamp || NewCost < Scratch.CostSoFar[Target])
+			{
+				Scratch.VisitStamp[Target] = Scratch.Stamp;
+				Scratch.CostSoFar[Target] = NewCost;
+				Scratch.ParentNode[Target] = Entry.Node;
+				Scratch.ParentEdge[Target] = EdgeIndex;
+
+				Scratch.OpenList.HeapPush(FOpenEntry{ NewCost + FVector2f::Distance(Nodes[Target].GetCenter(), GoalCenter), NewCost, Target });
+			}
+		}
+	}
+
+	return false;
+}
+
+bool FPlatformGraph::FindPath(const FVector& Start, const FVector& Goal, bool bCanPassThroughSoft, FPlatformPath& OutPath, bool bUseCache /*= true*/) const
+{
+	OutPath.Points.Reset();
+
+	const int32 StartNode = FindNode(Start);
+	const int32 GoalNode = FindNode(Goal);
+
+	if (StartNode == INDEX_NONE || GoalNode == INDEX_NONE)
+	{
+		return false;
+	}
+
+	TArray<int32, TInlineAllocator<32>> EdgePath;
+	bool bCached = false;
+
+	const uint64 CacheKey = (uint64(uint32(StartNode)) << 33) | (uint64(uint32(GoalNode)) << 1) | (bCanPassThroughSoft ? 1 : 0);
+
+	if (bUseCache)
+	{
+		FReadScopeLock ReadLock(PathCacheLock);
+
+		if (const TArray<int32>* CachedPath = PathCache.Find(CacheKey))
+		{
+			EdgePath.Append(*CachedPath);
+			bCached = true;
+		}
+	}
+
+	if (!bCached)
+	{
+		TArray<int32> NewPath;
+
+		if (!FindNodePath(StartNode, GoalNode, bCanPassThroughSoft, NewPath))
+		{
+			return false;
+		}
+
+		EdgePath.Append(NewPath);
+
+		if (bUseCache)
+		{
+			FWriteScopeLock WriteLock(PathCacheLock);
+
+			// flush the cache instead of tracking usage, paths are cheap to recompute
+			if (PathCache.Num() >= CVarPlatformGraphMaxCachedPaths.GetValueOnAnyThread())
+			{
+				PathCache.Reset();
+			}
+
+			PathCache.Add(CacheKey, MoveTemp(NewPath));
+		}
+	}
+
+	// convert the links into points along the surfaces
+	OutPath.Points.Reserve(EdgePath.Num() + 1);
+
+	int32 CurrentNode = StartNode;
+
+	for (const int32 EdgeIndex : EdgePath)
+	{
+		const FPlatformGraphEdge& Edge = Edges[EdgeIndex];
+
+		OutPath.Points.Add(FPlatformPathPoint{ FVector(Edge.FromX, PlaneY, Nodes[CurrentNode].Z), Edge.Type });
+
+		CurrentNode = Edge.TargetNode;
+	}
+
+	const FPlatformGraphNode& Last = Nodes[GoalNode];
+	OutPath.Points.Add(FPlatformPathPoint{ FVector(FMath::Clamp(Goal.X, Last.MinX, Last.MaxX), PlaneY, Last.Z), EPlatformLinkType::Walk });
+
+	return true;
+}
+
+void FPlatformGraph::ResetCache() const
+{
+	FWriteScopeLock WriteLock(PathCacheLock);
+	PathCache.Reset();
+}
+
+bool UPlatformGraphSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UPlatformGraphSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// streamed levels add and remove platforms
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UPlatformGraphSubsystem::OnLevelsChanged);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UPlatformGraphSubsystem::OnLevelsChanged);
+}
+
+void UPlatformGraphSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Super::Deinitialize();
+}
+
+void UPlatformGraphSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	BuildGraph();
+}
+
+void UPlatformGraphSubsystem::OnLevelsChanged(ULevel* Level, UWorld* World)
+{
+	// levels loaded before begin play are part of the initial build
+	if (World != GetWorld() || !World->HasBegunPlay() || bRebuildPending)
+	{
+		return;
+	}
+
+	bRebuildPending = true;
+
+	World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateWeakLambda(this, [this]()
+	{
+		bRebuildPending = false;
+		BuildGraph();
+	}));
+}
+
+void UPlatformGraphSubsystem::BuildGraph()
+{
+	LLM_SCOPE_BYTAG(SideScroll_AI);
+
+	using namespace PlatformGraph;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	UWorld* World = GetWorld();
+
+	TSharedRef<FPlatformGraph, ESPMode::ThreadSafe> NewGraph = MakeShared<FPlatformGraph, ESPMode::ThreadSafe>();
+
+	// the gameplay plane runs through the player start
+	bool bHasPlane = false;
+
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		NewGraph->PlaneY = It->GetActorLocation().Y;
+		bHasPlane = true;
+		break;
+	}
+
+	// collect the top surfaces of static blocking geometry
+	TArray<FPlatformGraphNode> Surfaces;
+	TArray<FBox> SolidBoxes;
+
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		AActor* Actor = *It;
+
+		// skip characters and gameplay actors that move or launch the character
+		if (Actor->IsA<APawn>() || Actor->IsA<ASideScrollingMovingPlatform>() || Actor->IsA<ASideScrollingJumpPad>())
+		{
+			continue;
+		}
+
+		const bool bSoft = Actor->IsA<ASideScrollingSoftPlatform>();
+
+		Actor->ForEachComponent<UPrimitiveComponent>(false, [&](UPrimitiveComponent* Primitive)
+		{
+			if (!Primitive->IsCollisionEnabled() || Primitive->GetCollisionResponseToChannel(ECC_Pawn) != ECR_Block)
+			{
+				return;
+			}
+
+			const FBox Box = Primitive->Bounds.GetBox();
+
+			// ignore geometry off the gameplay plane
+			if (bHasPlane && (NewGraph->PlaneY < Box.Min.Y || NewGraph->PlaneY > Box.Max.Y))
+			{
+				return;
+			}
+
+			Surfaces.Add(FPlatformGraphNode{ float(Box.Min.X), float(Box.Max.X), float(Box.Max.Z), bSoft });
+
+			if (!bSoft)
+			{
+				SolidBoxes.Add(Box);
+			}
+		});
+	}
+
+	// drop surfaces buried inside other solid geometry
+	Surfaces.RemoveAllSwap([&SolidBoxes](const FPlatformGraphNode& Surface)
+	{
+		return SolidBoxes.ContainsByPredicate([&Surface](const FBox& Box)
+		{
+			return Box.Min.X <= Surface.MinX && Box.Max.X >= Surface.MaxX && Box.Min.Z <= Surface.Z + 1.0f && Box.Max.Z > Surface.Z + 1.0f;
+		});
+	});
+
+	// merge touching surfaces at the same height into a single node
+	Surfaces.Sort([](const FPlatformGraphNode& A, const FPlatformGraphNode& B)
+	{
+		return A.Z != B.Z ? A.Z < B.Z : A.MinX < B.MinX;
+	});
+
+	TArray<FPlatformGraphNode>& Nodes = NewGraph->Nodes;
+	Nodes.Reserve(Surfaces.Num());
+
+	for (const FPlatformGraphNode& Surface : Surfaces)
+	{
+		FPlatformGraphNode* Last = Nodes.IsEmpty() ? nullptr : &Nodes.Last();
+
+		if (Last && FMath::Abs(Last->Z - Surface.Z) < 1.0f && Last->bSoft == Surface.bSoft && Surface.MinX <= Last->MaxX + 1.0f)
+		{
+			Last->MaxX = FMath::Max(Last->MaxX, Surface.MaxX);
+		}
+		else
+		{
+			Nodes.Add(Surface);
+		}
+	}
+
+	// read the movement limits
+	const float StepHeight = CVarPlatformGraphStepHeight.GetValueOnGameThread();
+	const float MaxJumpHeight = CVarPlatformGraphMaxJumpHeight.GetValueOnGameThread();
+	const float MaxJumpDistance = CVarPlatformGraphMaxJumpDistance.GetValueOnGameThread();
+	const float MaxDropHeight = CVarPlatformGraphMaxDropHeight.GetValueOnGameThread();
+
+	// how far from a ledge the character should aim to land
+	const float LandingClearance = 50.0f;
+	const float WalkGap = 10.0f;
+	const float DropGap = 100.0f;
+
+	// gather the outgoing links of each node
+	TArray<TArray<FPlatformGraphEdge>> NodeEdges;
+	NodeEdges.SetNum(Nodes.Num());
+
+	auto AddEdge = [&Nodes, &NodeEdges](int32 From, int32 To, EPlatformLinkType Type, float FromX, float ToX, bool bRequiresPassThrough = false)
+	{
+		FPlatformGraphEdge& Edge = NodeEdges[From].AddDefaulted_GetRef();
+		Edge.TargetNode = To;
+		Edge.Type = Type;
+		Edge.FromX = FromX;
+		Edge.ToX = ToX;
+		Edge.bRequiresPassThrough = bRequiresPassThrough;
+		Edge.Cost = FVector2f::Distance(Nodes[From].GetCenter(), Nodes[To].GetCenter()) * GetLinkCostScale(Type);
+	};
+
+	for (int32 From = 0; From < Nodes.Num(); ++From)
+	{
+		const FPlatformGraphNode& A = Nodes[From];
+
+		for (int32 To = 0; To < Nodes.Num(); ++To)
+		{
+			if (From == To)
+			{
+				continue;
+			}
+
+			const FPlatformGraphNode& B = Nodes[To];
+
+			const float Gap = GetHorizontalGap(A, B);
+			const float HeightDelta = B.Z - A.Z;
+			const bool bRight = B.GetCenter().X > A.GetCenter().X;
+
+			// walk across seams and small steps
+			if (FMath::Abs(HeightDelta) <= StepHeight && Gap <= WalkGap)
+			{
+				const float SeamX = bRight ? (A.MaxX + B.MinX) * 0.5f : (A.MinX + B.MaxX) * 0.5f;
+				AddEdge(From, To, EPlatformLinkType::Walk, SeamX, SeamX);
+				continue;
+			}
+
+			// jump up onto a higher platform
+			if (HeightDelta > 0.0f)
+			{
+				if (HeightDelta > MaxJumpHeight || Gap > MaxJumpDistance)
+				{
+					continue;
+				}
+
+				if (Gap > 0.0f)
+				{
+					// jump across the gap from the ledge
+					AddEdge(From, To, EPlatformLinkType::Jump, bRight ? A.MaxX : A.MinX, bRight ? FMath::Min(B.MinX + LandingClearance, B.MaxX) : FMath::Max(B.MaxX - LandingClearance, B.MinX));
+				}
+				else if (B.bSoft)
+				{
+					// jump straight up through the soft platform
+					const float JumpX = FMath::Clamp(A.GetCenter().X, FMath::Max(A.MinX, B.MinX), FMath::Min(A.MaxX, B.MaxX));
+					AddEdge(From, To, EPlatformLinkType::Jump, JumpX, JumpX, true);
+				}
+				else if (B.MinX - LandingClearance >= A.MinX)
+				{
+					// jump around the left side of the solid platform
+					AddEdge(From, To, EPlatformLinkType::Jump, B.MinX - LandingClearance, FMath::Min(B.MinX + LandingClearance, B.MaxX));
+				}
+				else if (B.MaxX + LandingClearance <= A.MaxX)
+				{
+					// jump around the right side of the solid platform
+					AddEdge(From, To, EPlatformLinkType::Jump, B.MaxX + LandingClearance, FMath::Max(B.MaxX - LandingClearance, B.MinX));
+				}
+
+				continue;
+			}
+
+			// drop down onto a lower platform
+			if (-HeightDelta > MaxDropHeight)
+			{
+				continue;
+			}
+
+			if (Gap > DropGap)
+			{
+				// too far to walk off the ledge, jump down instead
+				if (Gap <= MaxJumpDistance)
+				{
+					AddEdge(From, To, EPlatformLinkType::Jump, bRight ? A.MaxX : A.MinX, bRight ? FMath::Min(B.MinX + LandingClearance, B.MaxX) : FMath::Max(B.MaxX - LandingClearance, B.MinX));
+				}
+			}
+			else if (A.bSoft && Gap <= 0.0f)
+			{
+				// drop through the soft platform
+				const float DropX = FMath::Clamp(A.GetCenter().X, FMath::Max(A.MinX, B.MinX), FMath::Min(A.MaxX, B.MaxX));
+				AddEdge(From, To, EPlatformLinkType::DropThrough, DropX, DropX, true);
+			}
+			else if (B.MaxX > A.MaxX)
+			{
+				// walk off the right ledge
+				AddEdge(From, To, EPlatformLinkType::Drop, A.MaxX, FMath::Clamp(A.MaxX + LandingClearance, B.MinX, B.MaxX));
+			}
+			else if (B.MinX < A.MinX)
+			{
+				// walk off the left ledge
+				AddEdge(From, To, EPlatformLinkType::Drop, A.MinX, FMath::Clamp(A.MinX - LandingClearance, B.MinX, B.MaxX));
+			}
+		}
+	}
+
+	// link jump pads to the platforms within their launch arc
+	const float Gravity = FMath::Max(FMath::Abs(World->GetGravityZ()), 1.0f);
+
+	for (TActorIterator<ASideScrollingJumpPad> It(World); It; ++It)
+	{
+		const FVector PadLocation = It->GetActorLocation();
+		const int32 From = NewGraph->FindNode(PadLocation + FVector(0.0f, 0.0f, 10.0f));
+
+		if (From == INDEX_NONE)
+		{
+			continue;
+		}
+
+		// apex height of the launch
+		const float LaunchHeight = FMath::Square(It->GetZStrength()) / (2.0f * Gravity);
+
+		for (int32 To = 0; To < Nodes.Num(); ++To)
+		{
+			const FPlatformGraphNode& B = Nodes[To];
+			const float HeightDelta = B.Z - Nodes[From].Z;
+			const float Gap = FMath::Max3(B.MinX - PadLocation.X, PadLocation.X - B.MaxX, 0.0f);
+
+			if (To != From && HeightDelta > MaxJumpHeight && HeightDelta <= LaunchHeight && Gap <= MaxJumpDistance)
+			{
+				AddEdge(From, To, EPlatformLinkType::JumpPad, PadLocation.X, FMath::Clamp(PadLocation.X, B.MinX, B.MaxX));
+			}
+		}
+	}
+
+	// flatten the links into compact arrays
+	NewGraph->EdgeOffsets.SetNumUninitialized(Nodes.Num() + 1);
+
+	int32 NumEdges = 0;
+
+	for (int32 i = 0; i < Nodes.Num(); ++i)
+	{
+		NewGraph->EdgeOffsets[i] = NumEdges;
+		NumEdges += NodeEdges[i].Num();
+	}
+
+	NewGraph->EdgeOffsets[Nodes.Num()] = NumEdges;
+	NewGraph->Edges.Reserve(NumEdges);
+
+	for (const TArray<FPlatformGraphEdge>& Edges : NodeEdges)
+	{
+		NewGraph->Edges.Append(Edges);
+	}
+
+	Graph = NewGraph;
+
+	UE_LOG(LogPlatformGraph, Log, TEXT("Built platform graph with %d nodes and %d edges in %.2f ms"), Nodes.Num(), NumEdges, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+bool UPlatformGraphSubsystem::FindPath(const FVector& Start, const FVector& Goal, bool bCanPassThroughSoft, FPlatformPath& OutPath) const
+{
+	if (!Graph.IsValid())
+	{
+		OutPath.Points.Reset();
+		return false;
+	}
+
+	return Graph->FindPath(Start, Goal, bCanPassThroughSoft, OutPath);
+}
+
+void UPlatformGraphSubsystem::FindPathAsync(const FVector& Start, const FVector& Goal, bool bCanPassThroughSoft, TFunction<void(const FPlatformPath&)> OnComplete) const
+{
+	if (!Graph.IsValid())
+	{
+		OnComplete(FPlatformPath());
+		return;
+	}
+
+	// the task keeps its own reference to the graph so a rebuild can't free it mid query
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [QueryGraph = Graph, Start, Goal, bCanPassThroughSoft, OnComplete = MoveTemp(OnComplete)]() mutable
+	{
+		FPlatformPath Path;
+		QueryGraph->FindPath(Start, Goal, bCanPassThroughSoft, Path);
+
+		// report back on the game thread
+		AsyncTask(ENamedThreads::GameThread, [Path = MoveTemp(Path), OnComplete = MoveTemp(OnComplete)]()
+		{
+			OnComplete(Path);
+		});
+	});
+}
+
+void UPlatformGraphSubsystem::DrawDebugGraph(float Duration) const
+{
+	if (!Graph.IsValid())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	const float Y = Graph->PlaneY;
+
+	for (int32 i = 0; i < Graph->Nodes.Num(); ++i)
+	{
+		const FPlatformGraphNode& Node = Graph->Nodes[i];
+
+		// draw the surface
+		DrawDebugLine(World, FVector(Node.MinX, Y, Node.Z), FVector(Node.MaxX, Y, Node.Z), Node.bSoft ? FColor::Cyan : FColor::White, false, Duration, 0, 4.0f);
+
+		// draw the outgoing links
+		for (int32 EdgeIndex = Graph->EdgeOffsets[i]; EdgeIndex < Graph->EdgeOffsets[i + 1]; ++EdgeIndex)
+		{
+			const FPlatformGraphEdge& Edge = Graph->Edges[EdgeIndex];
+			const FVector From(Edge.FromX, Y, Node.Z + 10.0f);
+			const FVector To(Edge.ToX, Y, Graph->Nodes[Edge.TargetNode].Z + 10.0f);
+
+			DrawDebugDirectionalArrow(World, From, To, 20.0f, PlatformGraph::GetLinkColor(Edge.Type), false, Duration, 0, 1.5f);
+		}
+	}
+}
@@ -0,0 +1,200 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Misc/ScopeRWLock.h"
+#include "PlatformGraphSubsystem.generated.h"
+
+class ULevel;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPlatformGraph, Log, All);
+
+/**
+ *  Ways of moving between two platforms
+ */
+enum class EPlatformLinkType : uint8
+{
+	/** Walk across a seam or a small step */
+	Walk,
+
+	/** Jump up or across a gap */
+	Jump,
+
+	/** Walk off a ledge and fall */
+	Drop,
+
+	/** Drop down through a soft platform */
+	DropThrough,
+
+	/** Get launched by a jump pad */
+	JumpPad
+};
+
+/**
+ *  A walkable platform top surface in the side scrolling plane
+ */
+struct FPlatformGraphNode
+{
+	/** Horizontal extent of the surface */
+	float MinX = 0.0f;
+	float MaxX = 0.0f;
+
+	/** Height of the surface */
+	float Z = 0.0f;
+
+	/** If true, the platform can be jumped and dropped through */
+	bool bSoft = false;
+
+	/** Returns the center of the surface in the XZ plane */
+	FVector2f GetCenter() const { return FVector2f((MinX + MaxX) * 0.5f, Z); }
+};
+
+/**
+ *  A directed link between two platforms
+ */
+struct FPlatformGraphEdge
+{
+	/** Index of the destination node */
+	int32 TargetNode = INDEX_NONE;
+
+	/** Traversal cost, never lower than the straight line distance between node centers */
+	float Cost = 0.0f;
+
+	/** Horizontal position where the link leaves the source node */
+	float FromX = 0.0f;
+
+	/** Horizontal position where the link arrives on the destination node */
+	float ToX = 0.0f;
+
+	/** How the link is traversed */
+	EPlatformLinkType Type = EPlatformLinkType::Walk;
+
+	/** If true, the link goes through a soft platform and can only be used by characters that can pass through them */
+	bool bRequiresPassThrough = false;
+};
+
+/**
+ *  A point along a platform path
+ */
+struct FPlatformPathPoint
+{
+	/** Location to reach */
+	FVector Location = FVector::ZeroVector;
+
+	/** Link to traverse once the location is reached */
+	EPlatformLinkType Link = EPlatformLinkType::Walk;
+};
+
+/**
+ *  A path through the platform graph
+ */
+struct FPlatformPath
+{
+	TArray<FPlatformPathPoint> Points;
+
+	bool IsValid() const { return !Points.IsEmpty(); }
+};
+
+/**
+ *  Immutable 2D platform graph stored in compressed sparse row arrays, with a shared path cache.
+ *  Once built, path queries are safe to run from any thread.
+ */
+class MYSIDESCROLL_API FPlatformGraph
+{
+public:
+
+	/** Platform surfaces */
+	TArray<FPlatformGraphNode> Nodes;
+
+	/** Index of the first outgoing edge of each node. Has one extra entry so a node's edges are [EdgeOffsets[i], EdgeOffsets[i + 1]) */
+	TArray<int32> EdgeOffsets;
+
+	/** Outgoing edges, grouped by source node */
+	TArray<FPlatformGraphEdge> Edges;
+
+	/** Depth of the side scrolling plane */
+	float PlaneY = 0.0f;
+
+public:
+
+	/** Returns the node a character at the location would be standing on, or INDEX_NONE */
+	int32 FindNode(const FVector& Location, float MaxHeightAbove = 200.0f) const;
+
+	/** Runs A* between two nodes. Fills the edge indices along the path. Returns false if the goal is unreachable */
+	bool FindNodePath(int32 StartNode, int32 GoalNode, bool bCanPassThroughSoft, TArray<int32>& OutEdgePath) const;
+
+	/** Finds a path between two locations, using the path cache. Soft platform links are skipped unless the agent can pass through them. Thread safe */
+	bool FindPath(const FVector& Start, const FVector& Goal, bool bCanPassThroughSoft, FPlatformPath& OutPath, bool bUseCache = true) const;
+
+	/** Clears the path cache */
+	void ResetCache() const;
+
+private:
+
+	/** Cached node paths, keyed by start and goal node and whether soft links were allowed */
+	mutable TMap<uint64, TArray<int32>> PathCache;
+
+	/** Guards the path cache */
+	mutable FRWLock PathCacheLock;
+};
+
+/**
+ *  Builds a platform graph from the level geometry when the world begins play and whenever a streamed level is added or removed,
+ *  and serves path queries for AI.
+ *  Nodes are the top surfaces of blocking geometry in the side scrolling plane.
+ *  Edges are walk, jump, drop, drop-through and jump pad links, derived from the movement limits in the SideScrolling.PlatformGraph.* console variables.
+ *  Path queries are synchronous and fast enough to run on the game thread; batches can be sent to worker threads with FindPathAsync.
+ */
+UCLASS()
+class MYSIDESCROLL_API UPlatformGraphSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Current graph. Shared so in-flight async queries keep it alive across rebuilds */
+	TSharedPtr<const FPlatformGraph, ESPMode::ThreadSafe> Graph;
+
+	/** Streamed level delegate handles */
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+	/** Set while a rebuild is scheduled for the next tick, so several levels streaming in together only rebuild once */
+	bool bRebuildPending = false;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Subscribes to streamed level changes */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Builds the graph once all level actors have begun play */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Rebuilds the graph from the current level geometry */
+	void BuildGraph();
+
+	/** Returns the current graph, for queries from other threads */
+	TSharedPtr<const FPlatformGraph, ESPMode::ThreadSafe> GetGraph() const { return Graph; }
+
+	/** Finds a path between two locations on the game thread */
+	bool FindPath(const FVector& Start, const FVector& Goal, bool bCanPassThroughSoft, FPlatformPath& OutPath) const;
+
+	/** Finds a path on a worker thread and calls back on the game thread */
+	void FindPathAsync(const FVector& Start, const FVector& Goal, bool bCanPassThroughSoft, TFunction<void(const FPlatformPath&)> OnComplete) const;
+
+	/** Draws the graph for debugging */
+	void DrawDebugGraph(float Duration) const;
+
+protected:
+
+	/** Schedules a rebuild when a streamed level changes the world geometry */
+	void OnLevelsChanged(ULevel* Level, UWorld* World);
+};
@@ -0,0 +1,354 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ProgressSaveSubsystem.h"
+#include "MenuGameMode.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Memory/MemoryView.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Crc.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+
+DEFINE_LOG_CATEGORY(LogProgressSave);
+
+static FAutoConsoleCommand CCmdProgressSaveBenchmark(
+	TEXT("Save.Benchmark"),
+	TEXT("Measures progress save and load latency. Usage: Save.Benchmark [NumPickups=100000] [Iterations=20]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumPickups = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100000;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 20;
+
+		// build a save with a large pickup bitset
+		FProgressSaveData Data;
+		FLevelProgress& Level = Data.Levels.Add(FName(TEXT("BenchmarkLevel")));
+		Level.CollectedPickups.Init(false, NumPickups);
+
+		for (int32 i = 0; i < NumPickups; i += 3)
+		{
+			Level.CollectedPickups[i] = true;
+			++Level.PickupsCollected;
+		}
+
+		const FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SaveGames"), TEXT("Benchmark.sav"));
+
+		double CopyTime = 0.0;
+		double SerializeTime = 0.0;
+		double WriteTime = 0.0;
+		double LoadTime = 0.0;
+		int32 FileSize = 0;
+
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			// game thread cost of a save request
+			double StartTime = FPlatformTime::Seconds();
+			FProgressSaveData DataCopy = Data;
+			CopyTime += FPlatformTime::Seconds() - StartTime;
+
+			// background cost
+			StartTime = FPlatformTime::Seconds();
+			TArray<uint8> Buffer;
+			FMemoryWriter Writer(Buffer);
+			UProgressSaveSubsystem::SerializeSaveData(Writer, DataCopy);
+			SerializeTime += FPlatformTime::Seconds() - StartTime;
+
+			StartTime = FPlatformTime::Seconds();
+			UProgressSaveSubsystem::WriteSaveFileAtomic(FilePath, Buffer);
+			WriteTime += FPlatformTime::Seconds() - StartTime;
+
+			FileSize = Buffer.Num();
+
+			// startup load cost
+			StartTime = FPlatformTime::Seconds();
+			FProgressSaveData LoadedData;
+			UProgressSaveSubsystem::ReadSaveFile(FilePath, LoadedData);
+			LoadTime += FPlatformTime::Seconds() - StartTime;
+		}
+
+		IFileManager::Get().Delete(*FilePath, false, false, true);
+
+		UE_LOG(LogProgressSave, Log, TEXT("Save benchmark: %d pickups, %d bytes, %d iterations. Avg game thread copy %.3f ms, serialize %.3f ms, atomic write %.3f ms, mapped load %.3f ms"),
+			NumPickups,
+			FileSize,
+			Iterations,
+			(CopyTime / Iterations) * 1000.0,
+			(SerializeTime / Iterations) * 1000.0,
+			(WriteTime / Iterations) * 1000.0,
+			(LoadTime / Iterations) * 1000.0);
+	}));
+
+void UProgressSaveSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// load the save file, if there is one
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (ReadSaveFile(GetSaveFilePath(), SaveData))
+	{
+		UE_LOG(LogProgressSave, Log, TEXT("Loaded progress for %d levels in %.3f ms"), SaveData.Levels.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+		// restore the character selection
+		AMenuGameMode::SetSelectedCharacterType(SaveData.SelectedCharacter);
+	}
+}
+
+void UProgressSaveSubsystem::Deinitialize()
+{
+	// make sure the last save makes it to disk
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+	}
+
+	// progress changed while that save was in flight, and its completion callback won't run anymore, so write it now
+	if (bSaveQueued)
+	{
+		bSaveQueued = false;
+
+		TArray<uint8> Buffer;
+		FMemoryWriter Writer(Buffer);
+
+		if (!SerializeSaveData(Writer, SaveData) || !WriteSaveFileAtomic(GetSaveFilePath(), Buffer))
+		{
+			UE_LOG(LogProgressSave, Warning, TEXT("Failed to write progress to %s"), *GetSaveFilePath());
+		}
+	}
+
+	Super::Deinitialize();
+}
+
+FLevelProgress& UProgressSaveSubsystem::GetLevelProgress(FName LevelName)
+{
+	return SaveData.Levels.FindOrAdd(LevelName);
+}
+
+void UProgressSaveSubsystem::MarkPickupCollected(FName LevelName, int32 PickupIndex, int32 NumPickups)
+{
+	if (PickupIndex < 0 || PickupIndex >= NumPickups)
+	{
+		return;
+	}
+
+	FLevelProgress& Progress = GetLevelProgress(LevelName);
+
+	// grow the bitset if the level gained pickups since the last save
+	if (Progress.CollectedPickups.Num() < NumPickups)
+	{
+		Progress.CollectedPickups.Add(false, NumPickups - Progress.CollectedPickups.Num());
+	}
+
+	// ignore pickups we've already saved
+	if (Progress.CollectedPickups[PickupIndex])
+	{
+		return;
+	}
+
+	Progress.CollectedPickups[PickupIndex] = true;
+	++Progress.PickupsCollected;
+
+	RequestSave();
+}
+
+void UProgressSaveSubsystem::MarkCheckpointReached(FName LevelName, FName CheckpointName)
+{
+	FLevelProgress& Progress = GetLevelProgress(LevelName);
+
+	if (Progress.ReachedCheckpoints.Contains(CheckpointName))
+	{
+		return;
+	}
+
+	Progress.ReachedCheckpoints.Add(CheckpointName);
+
+	RequestSave();
+}
+
+void UProgressSaveSubsystem::SetSelectedCharacter(ECharacterType CharacterType)
+{
+	if (SaveData.SelectedCharacter == CharacterType)
+	{
+		return;
+	}
+
+	SaveData.SelectedCharacter = CharacterType;
+
+	RequestSave();
+}
+
+void UProgressSaveSubsystem::RequestSave()
+{
+	// is a save already in flight? save again once it completes
+	if (PendingSave.IsValid() && !PendingSave.IsCompleted())
+	{
+		bSaveQueued = true;
+		return;
+	}
+
+	// the background task works on its own copy of the data
+	TWeakObjectPtr<UProgressSaveSubsystem> WeakThis(this);
+
+	PendingSave = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Data = SaveData, WeakThis]() mutable
+	{
+		TArray<uint8> Buffer;
+		FMemoryWriter Writer(Buffer);
+
+		const bool bSuccess = SerializeSaveData(Writer, Data) && WriteSaveFileAtomic(GetSaveFilePath(), Buffer);
+
+		// report back on the game thread
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, bSuccess]()
+		{
+			if (UProgressSaveSubsystem* This = WeakThis.Get())
+			{
+				This->OnSaveCompleted(bSuccess);
+			}
+		});
+
+		return bSuccess;
+	});
+}
+
+void UProgressSaveSubsystem::OnSaveCompleted(bool bSuccess)
+{
+	if (!bSuccess)
+	{
+		UE_LOG(LogProgressSave, Warning, TEXT("Failed to write progress to %s"), *GetSaveFilePath());
+	}
+
+	// did progress change while we were saving?
+	if (bSaveQueued)
+	{
+		bSaveQueued = false;
+		RequestSave();
+	}
+}
+
+FString UProgressSaveSubsystem::GetSaveFilePath()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("SaveGames"), TEXT("Progress.sav"));
+}
+
+bool UProgressSaveSubsystem::SerializeSaveData(FArchive& Ar, FProgressSaveData& Data)
+{
+	uint32 Magic = SaveMagic;
+	uint16 Version = SaveVersion;
+	uint32 PayloadSize = 0;
+	uint32 PayloadCrc = 0;
+
+	if (Ar.IsSaving())
+	{
+		// serialize the payload first so the header can carry its size and checksum
+		TArray<uint8> Payload;
+		FMemoryWriter PayloadWriter(Payload);
+
+		uint8 SelectedCharacter = static_cast<uint8>(Data.SelectedCharacter);
+		PayloadWriter << SelectedCharacter;
+		PayloadWriter << Data.Levels;
+
+		PayloadSize = Payload.Num();
+		PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+
+		Ar << Magic << Version << PayloadSize << PayloadCrc;
+		Ar.Serialize(Payload.GetData(), Payload.Num());
+
+		return !Ar.IsError();
+	}
+
+	// validate the header
+	Ar << Magic << Version << PayloadSize << PayloadCrc;
+
+	if (Ar.IsError() || Magic != SaveMagic)
+	{
+		UE_LOG(LogProgressSave, Warning, TEXT("Save data is not a progress save"));
+		return false;
+	}
+
+	if (Version > SaveVersion)
+	{
+		UE_LOG(LogProgressSave, Warning, TEXT("Save data version %d is newer than supported version %d"), Version, SaveVersion);
+		return false;
+	}
+
+	if (Ar.TotalSize() - Ar.Tell() < PayloadSize)
+	{
+		UE_LOG(LogProgressSave, Warning, TEXT("Save data is truncated"));
+		return false;
+	}
+
+	// read and verify the payload
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(PayloadSize);
+	Ar.Serialize(Payload.GetData(), PayloadSize);
+
+	if (FCrc::MemCrc32(Payload.GetData(), Payload.Num()) != PayloadCrc)
+	{
+		UE_LOG(LogProgressSave, Warning, TEXT("Save data checksum mismatch"));
+		return false;
+	}
+
+	FMemoryReader PayloadReader(Payload);
+
+	uint8 SelectedCharacter = 0;
+	PayloadReader << SelectedCharacter;
+	PayloadReader << Data.Levels;
+
+	Data.SelectedCharacter = static_cast<ECharacterType>(SelectedCharacter);
+
+	return !PayloadReader.IsError();
+}
+
+bool UProgressSaveSubsystem::WriteSaveFileAtomic(const FString& FilePath, const TArray<uint8>& Buffer)
+{
+	// write the whole file next to the target first, so a crash never leaves a partial save behind
+	const FString TempPath = FilePath + TEXT(".tmp");
+
+	if (!FFileHelper::SaveArrayToFile(Buffer, *TempPath))
+	{
+		return false;
+	}
+
+	// replace the previous save
+	return IFileManager::Get().Move(*FilePath, *TempPath, true, true);
+}
+
+bool UProgressSaveSubsystem::ReadSaveFile(const FString& FilePath, FProgressSaveData& OutData)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	if (!PlatformFile.FileExists(*FilePath))
+	{
+		return false;
+	}
+
+	// memory map the file so it is read straight from the page cache
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*FilePath));
+
+	if (MappedFile.IsValid())
+	{
+		TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+
+		if (MappedRegion.IsValid())
+		{
+			FMemoryReaderView Reader(FMemoryView(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()));
+			return SerializeSaveData(Reader, OutData);
+		}
+	}
+
+	// the platform doesn't support mapping, fall back to a regular read
+	TArray<uint8> Buffer;
+
+	if (!FFileHelper::LoadFileToArray(Buffer, *FilePath, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Buffer);
+	return SerializeSaveData(Reader, OutData);
+}
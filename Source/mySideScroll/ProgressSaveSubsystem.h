@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tasks/Task.h"
+#include "CharacterSelectionWidget.h"
+#include "ProgressSaveSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogProgressSave, Log, All);
+
+/**
+ *  Saved progress for a single level
+ */
+struct FLevelProgress
+{
+	/** Number of pickups collected in the level */
+	int32 PickupsCollected = 0;
+
+	/** One bit per pickup in the level, indexed by the pickup's sorted name order */
+	TBitArray<> CollectedPickups;
+
+	/** Names of the checkpoints reached in the level */
+	TArray<FName> ReachedCheckpoints;
+
+	friend FArchive& operator<<(FArchive& Ar, FLevelProgress& Progress)
+	{
+		Ar << Progress.PickupsCollected;
+		Ar << Progress.CollectedPickups;
+		Ar << Progress.ReachedCheckpoints;
+		return Ar;
+	}
+};
+
+/**
+ *  All persistent player progress
+ */
+struct FProgressSaveData
+{
+	/** Character selected in the menu */
+	ECharacterType SelectedCharacter = ECharacterType::SideScrolling;
+
+	/** Per level progress, keyed by level name */
+	TMap<FName, FLevelProgress> Levels;
+};
+
+/**
+ *  Persists player progress in a compact, versioned binary file.
+ *  Saves are serialized and written on a background task, to a temporary file that is then moved over the previous save.
+ *  The save is memory mapped and read once when the game instance starts.
+ */
+UCLASS()
+class MYSIDESCROLL_API UProgressSaveSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Save file magic number */
+	static constexpr uint32 SaveMagic = 0x53535356; // 'SSSV'
+
+	/** Current save file version. Bump when changing the format and handle older versions in SerializeSaveData */
+	static constexpr uint16 SaveVersion = 1;
+
+protected:
+
+	/** Current progress, owned by the game thread */
+	FProgressSaveData SaveData;
+
+	/** In-flight background save */
+	UE::Tasks::TTask<bool> PendingSave;
+
+	/** Set when progress changes while a save is in flight, so another save is issued when it completes */
+	bool bSaveQueued = false;
+
+public:
+
+	/** Loads the save file */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Waits for any in-flight save and writes any queued one */
+	virtual void Deinitialize() override;
+
+public:
+
+	/** Returns the progress for a level, creating it if needed */
+	FLevelProgress& GetLevelProgress(FName LevelName);
+
+	/** Returns the saved character selection */
+	ECharacterType GetSelectedCharacter() const { return SaveData.SelectedCharacter; }
+
+	/** Records a pickup collected in a level and saves */
+	void MarkPickupCollected(FName LevelName, int32 PickupIndex, int32 NumPickups);
+
+	/** Records a checkpoint reached in a level and saves */
+	void MarkCheckpointReached(FName LevelName, FName CheckpointName);
+
+	/** Records the character selection and saves */
+	void SetSelectedCharacter(ECharacterType CharacterType);
+
+	/** Copies the current progress and writes it on a background task */
+	void RequestSave();
+
+	/** Returns the full path of the save file */
+	static FString GetSaveFilePath();
+
+	/** Serializes save data to or from a binary buffer, including the header. Returns false if the data is invalid */
+	static bool SerializeSaveData(FArchive& Ar, FProgressSaveData& Data);
+
+	/** Writes a save buffer to a temporary file, then moves it over the target file */
+	static bool WriteSaveFileAtomic(const FString& FilePath, const TArray<uint8>& Buffer);
+
+	/** Reads save data from a file, memory mapping it when the platform supports it */
+	static bool ReadSaveFile(const FString& FilePath, FProgressSaveData& OutData);
+
+protected:
+
+	/** Called on the game thread when a background save completes */
+	void OnSaveCompleted(bool bSuccess);
+};
@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollMemory.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+DEFINE_LOG_CATEGORY(LogSideScrollMemory);
+
+LLM_DEFINE_TAG(SideScroll_Enemies);
+LLM_DEFINE_TAG(SideScroll_LifeBars);
+LLM_DEFINE_TAG(SideScroll_Ragdolls);
+LLM_DEFINE_TAG(SideScroll_Pickups);
+LLM_DEFINE_TAG(SideScroll_AI);
+LLM_DEFINE_TAG(SideScroll_Preview);
+
+/** Names of the module's tags, as they appear in the tracker */
+static const TCHAR* SideScrollMemoryTags[] =
+{
+	TEXT("SideScroll/Enemies"),
+	TEXT("SideScroll/LifeBars"),
+	TEXT("SideScroll/Ragdolls"),
+	TEXT("SideScroll/Pickups"),
+	TEXT("SideScroll/AI"),
+	TEXT("SideScroll/Preview")
+};
+
+static FAutoConsoleCommandWithWorld CCmdSideScrollMemoryReport(
+	TEXT("SideScroll.Memory.Report"),
+	TEXT("Logs the memory used by the game module's low level memory tracker tags against their budgets. Requires -llm."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const USideScrollMemoryReportSubsystem* MemoryReport = World ? World->GetSubsystem<USideScrollMemoryReportSubsystem>() : nullptr)
+		{
+			MemoryReport->ReportMemory();
+		}
+	}));
+
+bool USideScrollMemoryReportSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USideScrollMemoryReportSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// was a report requested on the command line?
+	float ReportDelay = 0.0f;
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("SideScrollMemoryReport="), ReportDelay))
+	{
+		InWorld.GetTimerManager().SetTimer(ReportTimer, this, &USideScrollMemoryReportSubsystem::OnReportTimer, FMath::Max(ReportDelay, KINDA_SMALL_NUMBER), false);
+	}
+}
+
+ESideScrollMemoryReportResult USideScrollMemoryReportSubsystem::ReportMemory() const
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+
+	FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+
+	if (!Tracker.IsEnabled())
+	{
+		UE_LOG(LogSideScrollMemory, Warning, TEXT("The low level memory tracker is disabled. Run with -llm to get a memory report"));
+		return ESideScrollMemoryReportResult::Unavailable;
+	}
+
+	const FString MapName = GetWorld()->GetMapName();
+
+	bool bWithinBudget = true;
+
+	UE_LOG(LogSideScrollMemory, Log, TEXT("Memory report for %s"), *MapName);
+
+	for (const TCHAR* TagName : SideScrollMemoryTags)
+	{
+		const int64 Amount = Tracker.GetTagAmountForTracker(ELLMTracker::Default, FName(TagName), ELLMTagSet::None);
+		const double AmountMB = double(Amount) / (1024.0 * 1024.0);
+
+		// find the budget for this map
+		const FSideScrollMemoryBudget* Budget = Budgets.FindByPredicate([TagName, &MapName](const FSideScrollMemoryBudget& Entry)
+		{
+			return Entry.Tag == TagName && (Entry.Maps.Num() == 0 || Entry.Maps.ContainsByPredicate([&MapName](const FString& Map) { return MapName.EndsWith(Map); }));
+		});
+
+		if (!Budget)
+		{
+			UE_LOG(LogSideScrollMemory, Log, TEXT("  %-22s %8.2f MB"), TagName, AmountMB);
+			continue;
+		}
+
+		if (AmountMB > Budget->BudgetMB)
+		{
+			UE_LOG(LogSideScrollMemory, Error, TEXT("  %-22s %8.2f MB / %8.2f MB OVER BUDGET"), TagName, AmountMB, Budget->BudgetMB);
+			bWithinBudget = false;
+		}
+		else
+		{
+			UE_LOG(LogSideScrollMemory, Log, TEXT("  %-22s %8.2f MB / %8.2f MB"), TagName, AmountMB, Budget->BudgetMB);
+		}
+	}
+
+	return bWithinBudget ? ESideScrollMemoryReportResult::WithinBudget : ESideScrollMemoryReportResult::OverBudget;
+
+#else
+
+	UE_LOG(LogSideScrollMemory, Warning, TEXT("The low level memory tracker is compiled out of this build"));
+	return ESideScrollMemoryReportResult::Unavailable;
+
+#endif
+}
+
+void USideScrollMemoryReportSubsystem::OnReportTimer()
+{
+	const ESideScrollMemoryReportResult Result = ReportMemory();
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("SideScrollMemoryReportExit")))
+	{
+		// a report that couldn't measure anything must not pass
+		const TCHAR* ResultText = Result == ESideScrollMemoryReportResult::WithinBudget ? TEXT("passed") : Result == ESideScrollMemoryReportResult::OverBudget ? TEXT("failed") : TEXT("unavailable");
+
+		UE_LOG(LogSideScrollMemory, Display, TEXT("Memory report %s, exiting"), ResultText);
+
+		FPlatformMisc::RequestExitWithStatus(false, static_cast<uint8>(Result));
+	}
+}
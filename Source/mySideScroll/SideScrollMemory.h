@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SideScrollMemory.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSideScrollMemory, Log, All);
+
+/** Low level memory tracker tags for the game module. Run with -llm to track them */
+LLM_DECLARE_TAG_API(SideScroll_Enemies, MYSIDESCROLL_API);
+LLM_DECLARE_TAG_API(SideScroll_LifeBars, MYSIDESCROLL_API);
+LLM_DECLARE_TAG_API(SideScroll_Ragdolls, MYSIDESCROLL_API);
+LLM_DECLARE_TAG_API(SideScroll_Pickups, MYSIDESCROLL_API);
+LLM_DECLARE_TAG_API(SideScroll_AI, MYSIDESCROLL_API);
+LLM_DECLARE_TAG_API(SideScroll_Preview, MYSIDESCROLL_API);
+
+/**
+ *  Memory budget for a low level memory tracker tag
+ */
+USTRUCT()
+struct FSideScrollMemoryBudget
+{
+	GENERATED_BODY()
+
+	/** Tag name, e.g. SideScroll/Enemies */
+	UPROPERTY(config)
+	FName Tag;
+
+	/** Maps the budget applies to. Applies to every map if empty */
+	UPROPERTY(config)
+	TArray<FString> Maps;
+
+	/** Budget in megabytes */
+	UPROPERTY(config)
+	float BudgetMB = 0.0f;
+};
+
+/**
+ *  Outcome of a memory report. The values double as the exit codes of -SideScrollMemoryReportExit
+ */
+enum class ESideScrollMemoryReportResult : uint8
+{
+	WithinBudget	= 0,
+	OverBudget		= 1,
+	Unavailable		= 2,
+};
+
+/**
+ *  Reports the memory used by the game module's tags against per map budgets
+ *  Budgets are configured in DefaultGame.ini. Reports can be requested with SideScroll.Memory.Report.
+ *  To check a variant headlessly, open its map with:
+ *    -game -nullrhi -llm -SideScrollMemoryReport=<seconds> [-SideScrollMemoryReportExit]
+ *  The report is logged after the given time. With -SideScrollMemoryReportExit the game then quits,
+ *  returning 1 if any tag is over budget, or 2 if the tracker is compiled out or not enabled with -llm.
+ */
+UCLASS(config=Game)
+class MYSIDESCROLL_API USideScrollMemoryReportSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Tag budgets */
+	UPROPERTY(config)
+	TArray<FSideScrollMemoryBudget> Budgets;
+
+	/** Timer for the command line report */
+	FTimerHandle ReportTimer;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Schedules the command line report */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Logs the memory used by each tag and its budget. Returns whether the tags are within budget, or if the tracker isn't running */
+	ESideScrollMemoryReportResult ReportMemory() const;
+
+protected:
+
+	/** Logs the report, then quits if requested */
+	void OnReportTimer();
+};
@@ -0,0 +1,813 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingMovementComponent.h"
+#include "mySideScroll.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/World.h"
+#include "Engine/NetSerialization.h"
+#include "UObject/CoreNet.h"
+
+DEFINE_LOG_CATEGORY(LogSideScrollingMovement);
+
+DECLARE_CYCLE_STAT(TEXT("Side Scrolling Movement"), STAT_SideScrollingMovement, STATGROUP_SideScroll);
+
+static TAutoConsoleVariable<bool> CVarSideScrollingPlaneFastPath(
+	TEXT("SideScrolling.Movement.PlaneFastPath"),
+	true,
+	TEXT("If true, side scrolling movement skips depth axis work and redundant floor checks. Disable to compare against the stock movement component."),
+	ECVF_Default);
+
+namespace SideScrollingMovement
+{
+	/** Max bits per quantized component. Enough for +-500 km at whole centimeters */
+	constexpr uint32 MaxQuantizedBits = 31;
+
+	/**
+	 *  Serializes quantized vector components with as many bits per component as the largest one needs, plus a 5 bit header.
+	 *  Components are stored as offsets from the middle of their range so they don't need a sign bit of their own.
+	 */
+	static void SerializeQuantizedComponents(FArchive& Ar, double* Components, int32 NumComponents, double Scale)
+	{
+		uint32 NumBits = 0;
+		uint64 Packed[3] = { 0, 0, 0 };
+
+		if (Ar.IsSaving())
+		{
+			const int64 MaxValue = (int64(1) << (MaxQuantizedBits - 1)) - 1;
+
+			int64 Quantized[3] = { 0, 0, 0 };
+			uint64 MaxMagnitude = 0;
+
+			for (int32 i = 0; i < NumComponents; ++i)
+			{
+				Quantized[i] = FMath::Clamp<int64>(FMath::RoundToInt64(Components[i] * Scale), -MaxValue, MaxValue);
+				MaxMagnitude = FMath::Max<uint64>(MaxMagnitude, FMath::Abs(Quantized[i]));
+			}
+
+			NumBits = FMath::CeilLogTwo64(MaxMagnitude + 1) + 1;
+
+			const int64 Bias = int64(1) << (NumBits - 1);
+
+			for (int32 i = 0; i < NumComponents; ++i)
+			{
+				Packed[i] = uint64(Quantized[i] + Bias);
+			}
+		}
+
+		Ar.SerializeInt(NumBits, MaxQuantizedBits + 1);
+
+		if (NumBits == 0 || NumBits > MaxQuantizedBits)
+		{
+			Ar.SetError();
+			return;
+		}
+
+		for (int32 i = 0; i < NumComponents; ++i)
+		{
+			Ar.SerializeBits(&Packed[i], NumBits);
+		}
+
+		if (Ar.IsLoading())
+		{
+			const int64 Bias = int64(1) << (NumBits - 1);
+
+			for (int32 i = 0; i < NumComponents; ++i)
+			{
+				Components[i] = double(int64(Packed[i]) - Bias) / Scale;
+			}
+		}
+	}
+
+	/** Serializes a quantized vector. Only X and Z are sent if it's on the plane, the loaded Y is left at zero */
+	static void SerializeQuantizedVector(FArchive& Ar, FVector& Value, double Scale, bool bOnPlane)
+	{
+		if (bOnPlane)
+		{
+			double Components[2] = { Value.X, Value.Z };
+			SerializeQuantizedComponents(Ar, Components, 2, Scale);
+
+			if (Ar.IsLoading())
+			{
+				Value = FVector(Components[0], 0.0, Components[1]);
+			}
+		}
+		else
+		{
+			double Components[3] = { Value.X, Value.Y, Value.Z };
+			SerializeQuantizedComponents(Ar, Components, 3, Scale);
+
+			if (Ar.IsLoading())
+			{
+				Value = FVector(Components[0], Components[1], Components[2]);
+			}
+		}
+	}
+
+	/** Serializes a single bit flag */
+	static bool SerializeFlag(FArchive& Ar, bool bValue)
+	{
+		uint8 Bit = bValue ? 1 : 0;
+		Ar.SerializeBits(&Bit, 1);
+
+		return Bit != 0;
+	}
+
+	/** Movement cost counters, read by the benchmark */
+	static uint64 TickCycles = 0;
+	static uint64 NumFloorQueries = 0;
+
+	/** State for a running movement benchmark */
+	struct FBenchmarkState
+	{
+		TWeakObjectPtr<UWorld> World;
+		TArray<TWeakObjectPtr<ACharacter>> Characters;
+		int32 FramesPerPass = 0;
+		int32 WarmupFrames = 30;
+		int32 Frame = 0;
+		int32 Pass = 0;
+		bool bPreviousFastPath = true;
+		double PassMilliseconds[2] = { 0.0, 0.0 };
+		double PassFloorQueries[2] = { 0.0, 0.0 };
+	};
+
+	/** Destroys the benchmark characters and restores the fast path setting */
+	static void EndBenchmark(FBenchmarkState& State)
+	{
+		for (const TWeakObjectPtr<ACharacter>& Character : State.Characters)
+		{
+			if (Character.IsValid())
+			{
+				Character->Destroy();
+			}
+		}
+
+		State.Characters.Reset();
+
+		CVarSideScrollingPlaneFastPath.AsVariable()->Set(State.bPreviousFastPath, ECVF_SetByConsole);
+	}
+
+	/** Drives the benchmark characters for a frame. Returns false once the benchmark is complete */
+	static bool TickBenchmark(FBenchmarkState& State)
+	{
+		if (!State.World.IsValid())
+		{
+			EndBenchmark(State);
+			return false;
+		}
+
+		// reset the counters once the pass has warmed up
+		if (State.Frame == State.WarmupFrames)
+		{
+			TickCycles = 0;
+			NumFloorQueries = 0;
+		}
+
+		// finish the pass
+		if (State.Frame == State.WarmupFrames + State.FramesPerPass)
+		{
+			State.PassMilliseconds[State.Pass] = FPlatformTime::ToMilliseconds64(TickCycles) / State.FramesPerPass;
+			State.PassFloorQueries[State.Pass] = double(NumFloorQueries) / State.FramesPerPass;
+
+			State.Frame = 0;
+			++State.Pass;
+
+			if (State.Pass == 2)
+			{
+				const int32 NumCharacters = State.Characters.Num();
+
+				UE_LOG(LogSideScrollingMovement, Log, TEXT("Side scrolling movement benchmark: %d characters, %d frames per pass"), NumCharacters, State.FramesPerPass);
+				UE_LOG(LogSideScrollingMovement, Log, TEXT("  plane fast path:  %.3f ms per frame, %.1f floor queries per frame"), State.PassMilliseconds[0], State.PassFloorQueries[0]);
+				UE_LOG(LogSideScrollingMovement, Log, TEXT("  stock movement:   %.3f ms per frame, %.1f floor queries per frame"), State.PassMilliseconds[1], State.PassFloorQueries[1]);
+
+				if (State.PassMilliseconds[1] > 0.0)
+				{
+					UE_LOG(LogSideScrollingMovement, Log, TEXT("  movement cost reduced by %.1f%%"), (1.0 - State.PassMilliseconds[0] / State.PassMilliseconds[1]) * 100.0);
+				}
+
+				EndBenchmark(State);
+				return false;
+			}
+
+			// run the second pass without the fast paths
+			CVarSideScrollingPlaneFastPath.AsVariable()->Set(false, ECVF_SetByConsole);
+		}
+
+		// walk back and forth, jumping now and then so both walking and falling are measured
+		for (int32 i = 0; i < State.Characters.Num(); ++i)
+		{
+			if (ACharacter* Character = State.Characters[i].Get())
+			{
+				const float Direction = ((State.Frame + i * 7) / 60) % 2 == 0 ? 1.0f : -1.0f;
+				Character->AddMovementInput(FVector::ForwardVector, Direction);
+
+				if ((State.Frame + i) % 90 == 0)
+				{
+					Character->Jump();
+				}
+			}
+		}
+
+		++State.Frame;
+
+		return true;
+	}
+
+	/** Spawns copies of the player character and measures their movement cost with and without the plane fast paths */
+	static void StartBenchmark(UWorld* World, int32 NumCharacters, int32 FramesPerPass)
+	{
+		ACharacter* Template = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(World, 0));
+
+		if (!Template || !Cast<USideScrollingMovementComponent>(Template->GetCharacterMovement()))
+		{
+			UE_LOG(LogSideScrollingMovement, Warning, TEXT("The movement benchmark needs a player character using the side scrolling movement component"));
+			return;
+		}
+
+		TSharedRef<FBenchmarkState> State = MakeShared<FBenchmarkState>();
+		State->World = World;
+		State->FramesPerPass = FramesPerPass;
+		State->bPreviousFastPath = CVarSideScrollingPlaneFastPath.GetValueOnGameThread();
+		State->Characters.Reserve(NumCharacters);
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		for (int32 i = 0; i < NumCharacters; ++i)
+		{
+			// cluster the characters around the player so they share the same floor
+			const FVector Location = Template->GetActorLocation() + FVector((i % 20) * 20.0f - 200.0f, 0.0f, 50.0f);
+
+			if (ACharacter* Character = World->SpawnActor<ACharacter>(Template->GetClass(), Location, Template->GetActorRotation(), SpawnParams))
+			{
+				// move without a controller and without colliding with each other
+				Character->GetCharacterMovement()->bRunPhysicsWithNoController = true;
+				Character->GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore);
+
+				State->Characters.Add(Character);
+			}
+		}
+
+		CVarSideScrollingPlaneFastPath.AsVariable()->Set(true, ECVF_SetByConsole);
+
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([State](float DeltaTime)
+		{
+			return TickBenchmark(*State);
+		}));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CCmdSideScrollingMovementBenchmark(
+	TEXT("SideScrolling.Movement.Benchmark"),
+	TEXT("Measures side scrolling movement cost with and without the plane fast paths. Usage: SideScrolling.Movement.Benchmark [NumCharacters=500] [FramesPerPass=300]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 NumCharacters = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 500;
+		const int32 FramesPerPass = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 300;
+
+		SideScrollingMovement::StartBenchmark(World, NumCharacters, FramesPerPass);
+	}));
+
+USideScrollingMovementComponent::USideScrollingMovementComponent()
+{
+	// constrain movement to the side scrolling plane
+	SetPlaneConstraintNormal(FVector(0.0f, 1.0f, 0.0f));
+	bConstrainToPlane = true;
+
+	// send moves to the server as 2D values
+	SetNetworkMoveDataContainer(SideScrollingMoveDataContainer);
+}
+
+void USideScrollingMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SideScrollingMovement);
+
+	// the fast paths assume the plane faces the depth axis
+	bUsePlaneFastPath = CVarSideScrollingPlaneFastPath.GetValueOnGameThread() && bConstrainToPlane && FMath::IsNearlyEqual(FMath::Abs(GetPlaneConstraintNormal().Y), 1.0f);
+
+	// don't sweep for the floor every frame while standing still on it
+	bAlwaysCheckFloor = !bUsePlaneFastPath;
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SideScrollingMovement::TickCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+FVector USideScrollingMovementComponent::ConstrainDirectionToPlane(FVector Direction) const
+{
+	if (bUsePlaneFastPath)
+	{
+		// projecting onto the XZ plane is just dropping the depth
+		Direction.Y = 0.0f;
+		return Direction;
+	}
+
+	return Super::ConstrainDirectionToPlane(Direction);
+}
+
+FVector USideScrollingMovementComponent::ConstrainLocationToPlane(FVector Location) const
+{
+	if (bUsePlaneFastPath)
+	{
+		Location.Y = GetPlaneConstraintOrigin().Y;
+		return Location;
+	}
+
+	return Super::ConstrainLocationToPlane(Location);
+}
+
+FVector USideScrollingMovementComponent::ConstrainNormalToPlane(FVector Normal) const
+{
+	if (bUsePlaneFastPath)
+	{
+		Normal.Y = 0.0f;
+		return Normal.GetSafeNormal();
+	}
+
+	return Super::ConstrainNormalToPlane(Normal);
+}
+
+void USideScrollingMovementComponent::FindFloor(const FVector& CapsuleLocation, FFindFloorResult& OutFloorResult, bool bCanUseCachedLocation, const FHitResult* DownwardSweepResult) const
+{
+	++SideScrollingMovement::NumFloorQueries;
+
+	Super::FindFloor(CapsuleLocation, OutFloorResult, bCanUseCachedLocation, DownwardSweepResult);
+}
+
+bool USideScrollingMovementComponent::ShouldComputePerchResult(const FHitResult& InHit, bool bCheckRadius) const
+{
+	if (!bUsePlaneFastPath)
+	{
+		return Super::ShouldComputePerchResult(InHit, bCheckRadius);
+	}
+
+	if (!InHit.IsValidBlockingHit())
+	{
+		return false;
+	}
+
+	// perching is disabled
+	if (PerchRadiusThreshold <= SWEEP_EDGE_REJECT_DISTANCE)
+	{
+		return false;
+	}
+
+	// ledges only exist along the side scrolling axis, so contacts offset in depth never need the extra perch sweep
+	if (bCheckRadius && FMath::Abs(InHit.ImpactPoint.X - InHit.Location.X) <= GetValidPerchRadius())
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void USideScrollingMovementComponent::HandleImpact(const FHitResult& Hit, float TimeSlice, const FVector& MoveDelta)
+{
+	Super::HandleImpact(Hit, TimeSlice, MoveDelta);
+
+	// remember walls we bump into midair
+	if (IsFalling() && FMath::Abs(Hit.ImpactNormal.Z) < 0.25f)
+	{
+		LastWallNormal = Hit.ImpactNormal;
+		LastWallContactTime = GetWorld()->GetTimeSeconds();
+	}
+}
+
+FNetworkPredictionData_Client* USideScrollingMovementComponent::GetPredictionData_Client() const
+{
+	if (!ClientPredictionData)
+	{
+		USideScrollingMovementComponent* MutableThis = const_cast<USideScrollingMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_SideScrolling(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void USideScrollingMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToWallJump = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	bWallJumpRight = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+	bWantsToDropThrough = (Flags & FSavedMove_Character::FLAG_Custom_2) != 0;
+}
+
+void USideScrollingMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	// simulated proxies just follow the server
+	if (!CharacterOwner || CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		return;
+	}
+
+	WallJumpLockout = FMath::Max(WallJumpLockout - DeltaSeconds, 0.0f);
+
+	// the server checks for the wall and the lockout on its own, so a client can't jump off thin air or chain wall jumps
+	if (bWantsToWallJump)
+	{
+		bWantsToWallJump = false;
+
+		FVector WallNormal;
+
+		if (WallJumpLockout <= 0.0f && TryWallJump(bWallJumpRight ? 1.0f : -1.0f, WallJumpTraceDistance, WallJumpHorizontalImpulse, WallJumpVerticalMultiplier, WallNormal))
+		{
+			WallJumpLockout = DelayBetweenWallJumps;
+		}
+	}
+
+	if (bWantsToDropThrough)
+	{
+		bWantsToDropThrough = false;
+
+		if (IsAboveSoftPlatform(SoftPlatformObjectType, SoftPlatformTraceDistance))
+		{
+			SetPassThroughSoftPlatforms(SoftPlatformObjectType, true);
+		}
+	}
+}
+
+bool USideScrollingMovementComponent::TryWallJump(float Direction, float TraceDistance, float HorizontalImpulse, float VerticalMultiplier, FVector& OutWallNormal)
+{
+	if (!CharacterOwner || !IsFalling())
+	{
+		return false;
+	}
+
+	if (!FindWallJumpNormal(Direction, TraceDistance, OutWallNormal))
+	{
+		return false;
+	}
+
+	// calculate the impulse vector
+	FVector WallJumpImpulse = OutWallNormal * HorizontalImpulse;
+	WallJumpImpulse.Z = JumpZVelocity * VerticalMultiplier;
+
+	// launch the character away from the wall
+	CharacterOwner->LaunchCharacter(WallJumpImpulse, true, true);
+
+	// don't reuse this contact for the next jump
+	LastWallContactTime = -1.0;
+
+	return true;
+}
+
+bool USideScrollingMovementComponent::FindWallJumpNormal(float Direction, float TraceDistance, FVector& OutWallNormal) const
+{
+	if (!CharacterOwner || !IsFalling())
+	{
+		return false;
+	}
+
+	const float DirectionSign = Direction > 0.0f ? 1.0f : -1.0f;
+
+	// reuse a recent contact with a wall facing us instead of tracing
+	const bool bRecentWallContact = LastWallContactTime >= 0.0 && GetWorld()->GetTimeSeconds() - LastWallContactTime <= WallContactMemory && LastWallNormal.X * DirectionSign < -0.5f;
+
+	if (bRecentWallContact)
+	{
+		OutWallNormal = LastWallNormal;
+		return true;
+	}
+
+	// trace ahead of the character for walls
+	FHitResult OutHit;
+
+	const FVector Start = UpdatedComponent->GetComponentLocation();
+	const FVector End = Start + FVector(DirectionSign * TraceDistance, 0.0f, 0.0f);
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(CharacterOwner);
+
+	if (!GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams))
+	{
+		return false;
+	}
+
+	OutWallNormal = OutHit.ImpactNormal;
+	return true;
+}
+
+void USideScrollingMovementComponent::SetWallJumpSettings(float TraceDistance, float HorizontalImpulse, float VerticalMultiplier, float DelayBetweenJumps)
+{
+	WallJumpTraceDistance = TraceDistance;
+	WallJumpHorizontalImpulse = HorizontalImpulse;
+	WallJumpVerticalMultiplier = VerticalMultiplier;
+	DelayBetweenWallJumps = DelayBetweenJumps;
+}
+
+void USideScrollingMovementComponent::SetSoftPlatformSettings(ECollisionChannel ObjectType, float TraceDistance)
+{
+	SoftPlatformObjectType = ObjectType;
+	SoftPlatformTraceDistance = TraceDistance;
+}
+
+void USideScrollingMovementComponent::RequestWallJump(float Direction)
+{
+	bWantsToWallJump = true;
+	bWallJumpRight = Direction > 0.0f;
+}
+
+void USideScrollingMovementComponent::RequestDropThrough()
+{
+	bWantsToDropThrough = true;
+}
+
+bool USideScrollingMovementComponent::IsAboveSoftPlatform(ECollisionChannel SoftCollisionObjectType, float TraceDistance) const
+{
+	if (!UpdatedComponent)
+	{
+		return false;
+	}
+
+	// trace down
+	FHitResult OutHit;
+
+	const FVector Start = UpdatedComponent->GetComponentLocation();
+	const FVector End = Start + (FVector::DownVector * TraceDistance);
+
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(SoftCollisionObjectType);
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	GetWorld()->LineTraceSingleByObjectType(OutHit, Start, End, ObjectParams, QueryParams);
+
+	return OutHit.GetActor() != nullptr;
+}
+
+void USideScrollingMovementComponent::SetPassThroughSoftPlatforms(ECollisionChannel SoftCollisionObjectType, bool bPassThrough)
+{
+	if (UpdatedPrimitive)
+	{
+		// enable or disable collision response to the soft collision channel
+		UpdatedPrimitive->SetCollisionResponseToChannel(SoftCollisionObjectType, bPassThrough ? ECR_Ignore : ECR_Block);
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+
+void FSideScrollingNetStats::Reset()
+{
+	NumMoves = 0;
+	MoveBits = 0;
+	StockMoveBits = 0;
+	NumRepMovements = 0;
+	RepMovementBits = 0;
+	StockRepMovementBits = 0;
+}
+
+FSideScrollingNetStats& FSideScrollingNetStats::Get()
+{
+	static FSideScrollingNetStats Stats;
+	return Stats;
+}
+
+////////////////////////////////////////////////////////////////////
+
+void FSideScrollingRepMovement::FromRepMovement(const FRepMovement& RepMovement, bool bInOnPlane)
+{
+	Location = RepMovement.Location;
+	LinearVelocity = RepMovement.LinearVelocity;
+	Rotation = RepMovement.Rotation;
+	bOnPlane = bInOnPlane;
+}
+
+void FSideScrollingRepMovement::ToRepMovement(FRepMovement& RepMovement, double PlaneY) const
+{
+	RepMovement.Location = Location;
+	RepMovement.LinearVelocity = LinearVelocity;
+	RepMovement.Rotation = Rotation;
+
+	// the depth wasn't sent, we're on the same plane as the sender
+	if (bOnPlane)
+	{
+		RepMovement.Location.Y = PlaneY;
+	}
+}
+
+bool FSideScrollingRepMovement::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	FSideScrollingNetStats& Stats = FSideScrollingNetStats::Get();
+
+	// compare the size against the stock replicated movement
+	if (Ar.IsSaving() && Stats.bMeasuring)
+	{
+		FNetBitWriter Writer(nullptr, 256);
+		FSideScrollingRepMovement Copy = *this;
+		Copy.SerializeFields(Writer);
+
+		FNetBitWriter StockWriter(nullptr, 256);
+		FRepMovement StockMovement;
+		StockMovement.Location = Location;
+		StockMovement.LinearVelocity = LinearVelocity;
+		StockMovement.Rotation = Rotation;
+
+		bool bStockSuccess = true;
+		StockMovement.NetSerialize(StockWriter, nullptr, bStockSuccess);
+
+		++Stats.NumRepMovements;
+		Stats.RepMovementBits += Writer.GetNumBits();
+		Stats.StockRepMovementBits += StockWriter.GetNumBits();
+	}
+
+	SerializeFields(Ar);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FSideScrollingRepMovement::SerializeFields(FArchive& Ar)
+{
+	bOnPlane = SideScrollingMovement::SerializeFlag(Ar, bOnPlane);
+
+	// whole centimeters, same as the stock default
+	SideScrollingMovement::SerializeQuantizedVector(Ar, Location, 1.0, bOnPlane);
+	SideScrollingMovement::SerializeQuantizedVector(Ar, LinearVelocity, 1.0, bOnPlane);
+
+	if (bOnPlane)
+	{
+		// side scrolling characters only ever yaw
+		uint8 Yaw = FRotator::CompressAxisToByte(Rotation.Yaw);
+		Ar << Yaw;
+
+		if (Ar.IsLoading())
+		{
+			Rotation = FRotator(0.0f, FRotator::DecompressAxisFromByte(Yaw), 0.0f);
+		}
+	}
+	else
+	{
+		Rotation.SerializeCompressed(Ar);
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+
+void FSavedMove_SideScrolling::Clear()
+{
+	Super::Clear();
+
+	bWantsToWallJump = false;
+	bWallJumpRight = false;
+	bWantsToDropThrough = false;
+	WallJumpLockout = 0.0f;
+}
+
+uint8 FSavedMove_SideScrolling::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bWantsToWallJump)
+	{
+		Result |= FLAG_Custom_0;
+	}
+
+	if (bWallJumpRight)
+	{
+		Result |= FLAG_Custom_1;
+	}
+
+	if (bWantsToDropThrough)
+	{
+		Result |= FLAG_Custom_2;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_SideScrolling::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_SideScrolling* NewSideScrollingMove = static_cast<const FSavedMove_SideScrolling*>(NewMove.Get());
+
+	// don't merge away a one shot request
+	if (bWantsToWallJump || bWantsToDropThrough || NewSideScrollingMove->bWantsToWallJump || NewSideScrollingMove->bWantsToDropThrough)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_SideScrolling::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (const USideScrollingMovementComponent* MoveComp = Cast<USideScrollingMovementComponent>(C->GetCharacterMovement()))
+	{
+		bWantsToWallJump = MoveComp->bWantsToWallJump;
+		bWallJumpRight = MoveComp->bWallJumpRight;
+		bWantsToDropThrough = MoveComp->bWantsToDropThrough;
+		WallJumpLockout = MoveComp->WallJumpLockout;
+	}
+}
+
+void FSavedMove_SideScrolling::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// replay the requests along with the move, starting from the lockout the move saw
+	if (USideScrollingMovementComponent* MoveComp = Cast<USideScrollingMovementComponent>(C->GetCharacterMovement()))
+	{
+		MoveComp->bWantsToWallJump = bWantsToWallJump;
+		MoveComp->bWallJumpRight = bWallJumpRight;
+		MoveComp->bWantsToDropThrough = bWantsToDropThrough;
+		MoveComp->WallJumpLockout = WallJumpLockout;
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+
+FNetworkPredictionData_Client_SideScrolling::FNetworkPredictionData_Client_SideScrolling(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_SideScrolling::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_SideScrolling());
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool FSideScrollingNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	FSideScrollingNetStats& Stats = FSideScrollingNetStats::Get();
+
+	// compare the size against the stock move data. The scratch writers use the connection's package map so moves with a base are measured too
+	if (Ar.IsSaving() && Stats.bMeasuring)
+	{
+		FNetBitWriter Writer(PackageMap, 512);
+		SerializeMove(CharacterMovement, Writer, PackageMap, MoveType);
+
+		FNetBitWriter StockWriter(PackageMap, 512);
+		Super::Serialize(CharacterMovement, StockWriter, PackageMap, MoveType);
+
+		++Stats.NumMoves;
+		Stats.MoveBits += Writer.GetNumBits();
+		Stats.StockMoveBits += StockWriter.GetNumBits();
+	}
+
+	return SerializeMove(CharacterMovement, Ar, PackageMap, MoveType);
+}
+
+bool FSideScrollingNetworkMoveData::SerializeMove(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	NetworkMoveType = MoveType;
+
+	bool bLocalSuccess = true;
+	const bool bIsSaving = Ar.IsSaving();
+
+	// this move data is only used by the side scrolling movement component
+	const bool bPlanar = static_cast<const USideScrollingMovementComponent&>(CharacterMovement).IsUsingPlaneFastPath();
+
+	Ar << TimeStamp;
+
+	// input acceleration is projected onto the plane, so it has no depth
+	const bool bPlanarAcceleration = SideScrollingMovement::SerializeFlag(Ar, bIsSaving && bPlanar && FMath::IsNearlyZero(Acceleration.Y, 0.05));
+	SideScrollingMovement::SerializeQuantizedVector(Ar, Acceleration, 10.0, bPlanarAcceleration);
+
+	// locations relative to a moving base can have depth, world locations on a static base are still on the plane
+	const bool bPlanarLocation = SideScrollingMovement::SerializeFlag(Ar, bIsSaving && bPlanar && !MovementBaseUtility::UseRelativeLocation(MovementBase));
+	SideScrollingMovement::SerializeQuantizedVector(Ar, Location, 10.0, bPlanarLocation);
+
+	// take the depth from the server's copy of the character, which is on the same plane
+	if (!bIsSaving && bPlanarLocation && CharacterMovement.UpdatedComponent)
+	{
+		Location.Y = FRepMovement::RebaseOntoZeroOrigin(CharacterMovement.UpdatedComponent->GetComponentLocation(), &CharacterMovement).Y;
+	}
+
+	ControlRotation.NetSerialize(Ar, PackageMap, bLocalSuccess);
+
+	SerializeOptionalValue<uint8>(bIsSaving, Ar, CompressedMoveFlags, 0);
+
+	if (MoveType == ENetworkMoveType::NewMove)
+	{
+		// the base and ending movement mode are only used for error checking, so only save them for the final move
+		SerializeOptionalValue<UPrimitiveComponent*>(bIsSaving, Ar, MovementBase, nullptr);
+		SerializeOptionalValue<FName>(bIsSaving, Ar, MovementBaseBoneName, NAME_None);
+		SerializeOptionalValue<uint8>(bIsSaving, Ar, MovementMode, MOVE_Walking);
+	}
+
+	return !Ar.IsError();
+}
+
+////////////////////////////////////////////////////////////////////
+
+FSideScrollingNetworkMoveDataContainer::FSideScrollingNetworkMoveDataContainer()
+{
+	NewMoveData = &MoveData[0];
+	PendingMoveData = &MoveData[1];
+	OldMoveData = &MoveData[2];
+}
@@ -0,0 +1,274 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/CharacterMovementReplication.h"
+#include "Engine/ReplicatedState.h"
+#include "SideScrollingMovementComponent.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSideScrollingMovement, Log, All);
+
+/**
+ *  Bits written by the side scrolling movement serializers, and what the stock serializers would have written for the same data
+ *  Only gathered while measuring, since measuring serializes everything a second time
+ */
+struct MYSIDESCROLL_API FSideScrollingNetStats
+{
+	/** Set while a bandwidth benchmark is running */
+	bool bMeasuring = false;
+
+	/** Client to server moves */
+	uint64 NumMoves = 0;
+	uint64 MoveBits = 0;
+	uint64 StockMoveBits = 0;
+
+	/** Server to simulated proxy movement updates */
+	uint64 NumRepMovements = 0;
+	uint64 RepMovementBits = 0;
+	uint64 StockRepMovementBits = 0;
+
+	/** Clears the counters */
+	void Reset();
+
+	/** Returns the process wide stats */
+	static FSideScrollingNetStats& Get();
+};
+
+/**
+ *  Movement replicated to simulated proxies of side scrolling characters
+ *  Replaces the actor's replicated movement. While the character is on the side scrolling plane
+ *  only X and Z of the location and velocity are sent, quantized to whole centimeters, along with a byte for the yaw.
+ *  The receiver fills in the depth from its own copy of the character, which is on the same plane.
+ */
+USTRUCT()
+struct MYSIDESCROLL_API FSideScrollingRepMovement
+{
+	GENERATED_BODY()
+
+	/** Location of the character */
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	/** Velocity of the character */
+	UPROPERTY()
+	FVector LinearVelocity = FVector::ZeroVector;
+
+	/** Rotation of the character. Only the yaw is sent while on the plane */
+	UPROPERTY()
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** True if the character is on the side scrolling plane and the depth can be skipped */
+	UPROPERTY()
+	bool bOnPlane = false;
+
+	/** Copies the gathered actor movement */
+	void FromRepMovement(const FRepMovement& RepMovement, bool bInOnPlane);
+
+	/** Writes the received movement into the actor movement. The depth is taken from the plane if it wasn't sent */
+	void ToRepMovement(FRepMovement& RepMovement, double PlaneY) const;
+
+	/** Quantized network serialization */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+protected:
+
+	/** Serializes the fields */
+	void SerializeFields(FArchive& Ar);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSideScrollingRepMovement> : public TStructOpsTypeTraitsBase2<FSideScrollingRepMovement>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ *  Saved move carrying the wall jump and soft platform drop requests, so they're predicted and replayed along with the regular jump
+ *  Double jumps use the stock jump flag, the jump count is already saved by the base move.
+ */
+class MYSIDESCROLL_API FSavedMove_SideScrolling : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	/** Wall jump requested for this move */
+	uint8 bWantsToWallJump : 1;
+
+	/** Wall jump direction. True to jump towards +X */
+	uint8 bWallJumpRight : 1;
+
+	/** Soft platform drop requested for this move */
+	uint8 bWantsToDropThrough : 1;
+
+	/** Wall jump lockout left at the start of this move */
+	float WallJumpLockout = 0.0f;
+
+	// ~begin FSavedMove_Character interface
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+	// ~end FSavedMove_Character interface
+};
+
+/**
+ *  Client prediction data allocating side scrolling saved moves
+ */
+class MYSIDESCROLL_API FNetworkPredictionData_Client_SideScrolling : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_SideScrolling(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+ *  Client to server move data
+ *  Sends the acceleration and location as quantized X and Z while the character is on the side scrolling plane, with a bit per vector to fall back to 3D.
+ *  Locations relative to a moving base are always sent in 3D.
+ */
+struct MYSIDESCROLL_API FSideScrollingNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+
+protected:
+
+	/** Serializes the move */
+	bool SerializeMove(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType);
+};
+
+/**
+ *  Holds the side scrolling move data for the new, pending and old moves
+ */
+struct MYSIDESCROLL_API FSideScrollingNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FSideScrollingNetworkMoveDataContainer();
+
+	FSideScrollingNetworkMoveData MoveData[3];
+};
+
+/**
+ *  Character movement specialized for side scrolling on the XZ plane
+ *  Constrains movement to the plane and takes fast paths for plane projection and ledge perching that ignore the depth axis
+ *  Skips floor checks while standing still on a valid floor
+ *  Handles wall jumps and soft platform drop-through, reusing wall contacts from the movement sweeps instead of tracing when possible
+ *  In networked games wall jumps and drops are requested through the saved moves so the client predicts them and the server replays them,
+ *  and moves are sent to the server as quantized 2D values
+ */
+UCLASS()
+class MYSIDESCROLL_API USideScrollingMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Max time since the last wall contact for it to be used for a wall jump without tracing */
+	UPROPERTY(EditAnywhere, Category="Side Scrolling", meta=(ClampMin=0, Units="s"))
+	float WallContactMemory = 0.1f;
+
+	/** Normal of the last wall we bumped into while falling */
+	FVector LastWallNormal = FVector::ZeroVector;
+
+	/** World time of the last wall contact while falling */
+	double LastWallContactTime = -1.0;
+
+	/** True if the movement is constrained to the XZ plane and the fast paths can be used. Updated every tick */
+	bool bUsePlaneFastPath = false;
+
+	/** Pending wall jump request, consumed by the next movement update */
+	bool bWantsToWallJump = false;
+
+	/** Direction of the pending wall jump. True to jump towards +X */
+	bool bWallJumpRight = false;
+
+	/** Pending soft platform drop request, consumed by the next movement update */
+	bool bWantsToDropThrough = false;
+
+	/** Wall jump settings, provided by the owning character */
+	float WallJumpTraceDistance = 50.0f;
+	float WallJumpHorizontalImpulse = 500.0f;
+	float WallJumpVerticalMultiplier = 1.6f;
+	float DelayBetweenWallJumps = 0.3f;
+
+	/** Movement time left before another wall jump is allowed. Counted in move time so the server holds clients to the same lockout */
+	float WallJumpLockout = 0.0f;
+
+	/** Soft platform settings, provided by the owning character */
+	TEnumAsByte<ECollisionChannel> SoftPlatformObjectType = ECC_WorldDynamic;
+	float SoftPlatformTraceDistance = 1000.0f;
+
+	/** Move data sent to the server */
+	FSideScrollingNetworkMoveDataContainer SideScrollingMoveDataContainer;
+
+	friend class FSavedMove_SideScrolling;
+
+public:
+
+	/** Constructor */
+	USideScrollingMovementComponent();
+
+	// ~begin UActorComponent interface
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// ~end UActorComponent interface
+
+	// ~begin UMovementComponent interface
+	virtual FVector ConstrainDirectionToPlane(FVector Direction) const override;
+	virtual FVector ConstrainLocationToPlane(FVector Location) const override;
+	virtual FVector ConstrainNormalToPlane(FVector Normal) const override;
+	// ~end UMovementComponent interface
+
+	// ~begin UCharacterMovementComponent interface
+	virtual void FindFloor(const FVector& CapsuleLocation, FFindFloorResult& OutFloorResult, bool bCanUseCachedLocation, const FHitResult* DownwardSweepResult = nullptr) const override;
+	virtual bool ShouldComputePerchResult(const FHitResult& InHit, bool bCheckRadius = true) const override;
+	virtual void HandleImpact(const FHitResult& Hit, float TimeSlice = 0.0f, const FVector& MoveDelta = FVector::ZeroVector) override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	// ~end UCharacterMovementComponent interface
+
+protected:
+
+	// ~begin UCharacterMovementComponent interface
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	// ~end UCharacterMovementComponent interface
+
+public:
+
+	/** Launches the character away from a wall in the given horizontal direction. Returns true and the wall normal if there was a wall to jump from */
+	bool TryWallJump(float Direction, float TraceDistance, float HorizontalImpulse, float VerticalMultiplier, FVector& OutWallNormal);
+
+	/** Returns true and the wall normal if there's a wall to jump from in the given horizontal direction */
+	bool FindWallJumpNormal(float Direction, float TraceDistance, FVector& OutWallNormal) const;
+
+	/** Sets the wall jump settings used by predicted wall jumps */
+	void SetWallJumpSettings(float TraceDistance, float HorizontalImpulse, float VerticalMultiplier, float DelayBetweenJumps);
+
+	/** Sets the soft platform settings used by predicted drops */
+	void SetSoftPlatformSettings(ECollisionChannel ObjectType, float TraceDistance);
+
+	/** Requests a predicted wall jump on the next movement update. Falls back to a trace if no wall was bumped into recently */
+	void RequestWallJump(float Direction);
+
+	/** Requests a predicted drop through the soft platform under the character on the next movement update */
+	void RequestDropThrough();
+
+	/** Returns true if there's a soft platform of the given object type under the character */
+	bool IsAboveSoftPlatform(ECollisionChannel SoftCollisionObjectType, float TraceDistance) const;
+
+	/** Sets whether the character passes through soft platforms of the given object type */
+	void SetPassThroughSoftPlatforms(ECollisionChannel SoftCollisionObjectType, bool bPassThrough);
+
+	/** Returns true if the plane fast paths are enabled for this component */
+	bool IsUsingPlaneFastPath() const { return bUsePlaneFastPath; }
+};
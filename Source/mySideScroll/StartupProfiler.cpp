@@ -0,0 +1,138 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StartupProfiler.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformMisc.h"
+#include "CoreGlobals.h"
+
+DEFINE_LOG_CATEGORY(LogStartupProfiler);
+
+TArray<FStartupTiming> FStartupProfiler::Timings;
+FString FStartupProfiler::CurrentMapName;
+double FStartupProfiler::MapLoadStartTime = 0.0;
+double FStartupProfiler::SelectionTime = 0.0;
+
+void FStartupProfiler::RecordTiming(const TCHAR* Label, double StartTime, double EndTime)
+{
+	FStartupTiming& NewTiming = Timings.AddDefaulted_GetRef();
+	NewTiming.Label = Label;
+	NewTiming.MapName = CurrentMapName;
+	NewTiming.StartSeconds = StartTime - GStartTime;
+	NewTiming.DurationSeconds = EndTime - StartTime;
+
+	UE_LOG(LogStartupProfiler, Verbose, TEXT("%s [%s]: %.2f ms"), Label, *CurrentMapName, NewTiming.DurationSeconds * 1000.0);
+}
+
+void FStartupProfiler::RecordSinceProcessStart(const TCHAR* Label)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	RecordTiming(Label, GStartTime, Now);
+
+	UE_LOG(LogStartupProfiler, Log, TEXT("%s finished %.2f ms after process start"), Label, (Now - GStartTime) * 1000.0);
+}
+
+void FStartupProfiler::BeginMapLoad(const FString& MapName)
+{
+	CurrentMapName = FPaths::GetBaseFilename(MapName);
+	MapLoadStartTime = FPlatformTime::Seconds();
+}
+
+void FStartupProfiler::EndMapLoad(UWorld* LoadedWorld)
+{
+	// ignore loads we didn't see start
+	if (MapLoadStartTime <= 0.0)
+	{
+		return;
+	}
+
+	RecordTiming(TEXT("MapLoad"), MapLoadStartTime, FPlatformTime::Seconds());
+}
+
+void FStartupProfiler::MarkFirstPlayableFrame(UWorld* World)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	// the first map is loaded by the engine before our hooks, so measure it from process start
+	const double StartTime = MapLoadStartTime > 0.0 ? MapLoadStartTime : GStartTime;
+
+	if (World)
+	{
+		CurrentMapName = World->GetMapName();
+	}
+
+	RecordTiming(TEXT("FirstPlayableFrame"), StartTime, Now);
+
+	UE_LOG(LogStartupProfiler, Log, TEXT("First playable frame for %s after %.2f ms"), *CurrentMapName, (Now - StartTime) * 1000.0);
+
+	// was this map opened from the character selection?
+	if (SelectionTime > 0.0)
+	{
+		RecordTiming(TEXT("SelectionToPlayable"), SelectionTime, Now);
+
+		UE_LOG(LogStartupProfiler, Log, TEXT("Character selection to playable: %.3f s"), Now - SelectionTime);
+
+		SelectionTime = 0.0;
+	}
+
+	// only time the first frame of each map
+	MapLoadStartTime = 0.0;
+
+	WriteCSV();
+
+	// automated startup runs only need the first map
+	if (FParse::Param(FCommandLine::Get(), TEXT("StartupProfileExit")))
+	{
+		FPlatformMisc::RequestExit(false, TEXT("StartupProfiler"));
+	}
+}
+
+void FStartupProfiler::MarkFirstPlayableFrameNextTick(UWorld* World)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	TWeakObjectPtr<UWorld> WeakWorld = World;
+
+	World->GetTimerManager().SetTimerForNextTick([WeakWorld]()
+	{
+		MarkFirstPlayableFrame(WeakWorld.Get());
+	});
+}
+
+void FStartupProfiler::MarkSelectionConfirmed()
+{
+	SelectionTime = FPlatformTime::Seconds();
+}
+
+void FStartupProfiler::WriteCSV()
+{
+	// resolve the output path
+	FString OutputPath;
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("StartupProfileCSV="), OutputPath))
+	{
+		OutputPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("Startup"), TEXT("StartupTimings.csv"));
+	}
+
+	// build the file
+	FString CSV = TEXT("Label,Map,StartSeconds,DurationMs\n");
+
+	for (const FStartupTiming& Timing : Timings)
+	{
+		CSV += FString::Printf(TEXT("%s,%s,%.6f,%.3f\n"), *Timing.Label, *Timing.MapName, Timing.StartSeconds, Timing.DurationSeconds * 1000.0);
+	}
+
+	if (!FFileHelper::SaveStringToFile(CSV, *OutputPath))
+	{
+		UE_LOG(LogStartupProfiler, Warning, TEXT("Could not write startup timings to %s"), *OutputPath);
+	}
+}
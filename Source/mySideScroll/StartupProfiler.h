@@ -0,0 +1,108 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+class UWorld;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogStartupProfiler, Log, All);
+
+/**
+ *  Single timing sample recorded by the startup profiler
+ */
+struct FStartupTiming
+{
+	/** Name of the timed phase */
+	FString Label;
+
+	/** Map that was loading or running when the phase was recorded */
+	FString MapName;
+
+	/** Seconds since process start at which the phase began */
+	double StartSeconds = 0.0;
+
+	/** Duration of the phase in seconds */
+	double DurationSeconds = 0.0;
+};
+
+/**
+ *  Records timings for the startup phases (module init, engine init, map load, widget creation, pawn spawn, first playable frame, selection to playable)
+ *  Module init and engine init are measured from process start, to the end of the game module's StartupModule and to PostEngineInit.
+ *  Timings are flushed to a CSV file in the profiling directory every time a map reaches its first playable frame,
+ *  so automated runs can track startup regressions.
+ *  The output file can be overridden with -StartupProfileCSV=<path>, and -StartupProfileExit quits once the first map is playable.
+ *  CI runs the packaged game with: mySideScroll -unattended -nosplash -StartupProfileCSV=<path> -StartupProfileExit
+ */
+class MYSIDESCROLL_API FStartupProfiler
+{
+public:
+
+	/** Records a completed phase */
+	static void RecordTiming(const TCHAR* Label, double StartTime, double EndTime);
+
+	/** Marks the start of a map load */
+	static void BeginMapLoad(const FString& MapName);
+
+	/** Marks the end of a map load */
+	static void EndMapLoad(UWorld* LoadedWorld);
+
+	/** Records the time from process start to now as a phase */
+	static void RecordSinceProcessStart(const TCHAR* Label);
+
+	/** Records the time to the first playable frame of the current map and writes the CSV. Quits afterwards with -StartupProfileExit */
+	static void MarkFirstPlayableFrame(UWorld* World);
+
+	/** Schedules MarkFirstPlayableFrame for the world's next tick. Called from the game modes' BeginPlay */
+	static void MarkFirstPlayableFrameNextTick(UWorld* World);
+
+	/** Marks a character selection being confirmed in the menu, so the next first playable frame also records the selection to playable time */
+	static void MarkSelectionConfirmed();
+
+	/** Writes every recorded timing to the CSV file */
+	static void WriteCSV();
+
+private:
+
+	/** Recorded timings for this process */
+	static TArray<FStartupTiming> Timings;
+
+	/** Map currently loading or running */
+	static FString CurrentMapName;
+
+	/** Platform time at which the current map started loading */
+	static double MapLoadStartTime;
+
+	/** Platform time at which the last character selection was confirmed */
+	static double SelectionTime;
+};
+
+/**
+ *  Scoped timer that records its lifetime with the startup profiler
+ */
+class FStartupProfilerScope
+{
+public:
+
+	explicit FStartupProfilerScope(const TCHAR* InLabel)
+		: Label(InLabel)
+		, StartTime(FPlatformTime::Seconds())
+	{
+	}
+
+	~FStartupProfilerScope()
+	{
+		FStartupProfiler::RecordTiming(Label, StartTime, FPlatformTime::Seconds());
+	}
+
+private:
+
+	const TCHAR* Label;
+	double StartTime;
+};
+
+/** Times the enclosing scope with the startup profiler and the CPU profiler trace */
+#define SIDESCROLL_STARTUP_SCOPE(Label) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR("Startup_" Label); \
+	FStartupProfilerScope PREPROCESSOR_JOIN(StartupProfilerScope_, __LINE__)(TEXT(Label))
@@ -2,10 +2,13 @@
 
 
 #include "CombatAIController.h"
+#include "SideScrollMemory.h"
 #include "Components/StateTreeAIComponent.h"
 
 ACombatAIController::ACombatAIController()
 {
+	LLM_SCOPE_BYTAG(SideScroll_AI);
+
 	// create the StateTree AI Component
 	StateTreeAI = CreateDefaultSubobject<UStateTreeAIComponent>(TEXT("StateTreeAI"));
 	check(StateTreeAI);
@@ -2,18 +2,27 @@
 
 
 #include "CombatEnemy.h"
+#include "mySideScroll.h"
+#include "SideScrollMemory.h"
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "CombatAIController.h"
 #include "Components/WidgetComponent.h"
 #include "Engine/DamageEvents.h"
 #include "CombatLifeBar.h"
-#include "TimerManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstance.h"
+#include "CombatRagdollSubsystem.h"
+#include "CombatAttackSchedulerSubsystem.h"
+#include "CombatCrowdAvoidanceSubsystem.h"
+#include "CombatLagCompensationSubsystem.h"
+#include "ActorRegistrySubsystem.h"
+#include "Net/UnrealNetwork.h"
 
 ACombatEnemy::ACombatEnemy()
 {
+	LLM_SCOPE_BYTAG(SideScroll_Enemies);
+
 	PrimaryActorTick.bCanEverTick = true;
 
 	// bind the attack montage ended delegate
@@ -40,13 +49,21 @@ ACombatEnemy::ACombatEnemy()
 
 	// reset HP to maximum
 	CurrentHP = MaxHP;
+
+	// record the head and right hand for lag compensation by default
+	LagCompensatedBones = { FName("head"), FName("hand_r") };
 }
 
 void ACombatEnemy::DoAIComboAttack()
 {
-	// ignore if we're already playing an attack animation
+	// ignore if we're already playing an attack animation, giving back any attack slot we were granted for this one
 	if (bIsAttacking)
 	{
+		if (UCombatAttackSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UCombatAttackSchedulerSubsystem>())
+		{
+			Scheduler->ReleaseAttack(this);
+		}
+
 		return;
 	}
 
@@ -69,15 +86,35 @@ void ACombatEnemy::DoAIComboAttack()
 		{
 			// set the end delegate for the montage
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ComboAttackMontage);
+
+			// play the attack on clients
+			MulticastAttackMontage(ComboAttackMontage, NAME_None);
 		}
 	}
 }
 
+void ACombatEnemy::RestoreHP(float NewHP)
+{
+	// clamp and apply the new HP
+	CurrentHP = FMath::Clamp(NewHP, 0.0f, MaxHP);
+
+	// update the life bar
+	if (LifeBarWidget)
+	{
+		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
+	}
+}
+
 void ACombatEnemy::DoAIChargedAttack()
 {
-	// ignore if we're already playing an attack animation
+	// ignore if we're already playing an attack animation, giving back any attack slot we were granted for this one
 	if (bIsAttacking)
 	{
+		if (UCombatAttackSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UCombatAttackSchedulerSubsystem>())
+		{
+			Scheduler->ReleaseAttack(this);
+		}
+
 		return;
 	}
 
@@ -100,6 +137,9 @@ void ACombatEnemy::DoAIChargedAttack()
 		{
 			// set the end delegate for the montage
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ChargedAttackMontage);
+
+			// play the attack on clients
+			MulticastAttackMontage(ChargedAttackMontage, NAME_None);
 		}
 	}
 }
@@ -109,12 +149,51 @@ void ACombatEnemy::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted)
 	// reset the attacking flag
 	bIsAttacking = false;
 
-	// call the attack completed delegate so the StateTree can continue execution
-	OnAttackCompleted.ExecuteIfBound();
+	// free up our attack slot
+	if (UCombatAttackSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UCombatAttackSchedulerSubsystem>())
+	{
+		Scheduler->ReleaseAttack(this);
+	}
+
+	// signal the attack completed slot so the StateTree can continue execution
+	AttackCompletedSlot.Signal();
+}
+
+void ACombatEnemy::MulticastAttackMontage_Implementation(UAnimMontage* Montage, FName SectionName)
+{
+	// the server and the listen host already played it
+	if (GetLocalRole() != ROLE_SimulatedProxy)
+	{
+		return;
+	}
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		// start the montage if we missed its start
+		if (!AnimInstance->Montage_IsPlaying(Montage))
+		{
+			AnimInstance->Montage_Play(Montage);
+		}
+
+		if (!SectionName.IsNone())
+		{
+			AnimInstance->Montage_JumpToSection(SectionName, Montage);
+		}
+	}
 }
 
 void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
 {
+	SIDESCROLL_SCOPE(CombatEnemyAttackTrace);
+
+	// clients only play the attack, the server decides who gets hit
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	SideScrollCounters::AddAttackTrace();
+
 	// sweep for objects in front of the character to be hit by the attack
 	TArray<FHitResult> OutHits;
 
@@ -161,6 +240,12 @@ void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
 
 void ACombatEnemy::CheckCombo()
 {
+	// clients follow the sections picked by the server
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	// increase the combo counter
 	++CurrentComboAttack;
 
@@ -172,23 +257,38 @@ void ACombatEnemy::CheckCombo()
 		{
 			AnimInstance->Montage_JumpToSection(ComboSectionNames[CurrentComboAttack], ComboAttackMontage);
 		}
+
+		MulticastAttackMontage(ComboAttackMontage, ComboSectionNames[CurrentComboAttack]);
 	}
 }
 
 void ACombatEnemy::CheckChargedAttack()
 {
+	// clients follow the sections picked by the server
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	// increase the charge loop counter
 	++CurrentChargeLoop;
 
 	// jump to either the loop or attack section of the montage depending on whether we hit the loop target
+	const FName SectionName = CurrentChargeLoop >= TargetChargeLoops ? ChargeAttackSection : ChargeLoopSection;
+
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
-		AnimInstance->Montage_JumpToSection(CurrentChargeLoop >= TargetChargeLoops ? ChargeAttackSection : ChargeLoopSection, ChargedAttackMontage);
+		AnimInstance->Montage_JumpToSection(SectionName, ChargedAttackMontage);
 	}
+
+	MulticastAttackMontage(ChargedAttackMontage, SectionName);
 }
 
 void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
+	SIDESCROLL_SCOPE(CombatEnemyApplyDamage);
+	SideScrollCounters::AddDamageEvent();
+
 	
 	// pass the damage event to the actor
 	FDamageEvent DamageEvent;
@@ -221,6 +321,12 @@ void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector
 
 void ACombatEnemy::HandleDeath()
 {
+	// dead enemies no longer count as alive
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(this, EActorRegistryCategory::Enemy);
+	}
+
 	// hide the life bar
 	LifeBar->SetHiddenInGame(true);
 
@@ -230,14 +336,42 @@ void ACombatEnemy::HandleDeath()
 	// disable character movement
 	GetCharacterMovement()->DisableMovement();
 
-	// enable full ragdoll physics
-	GetMesh()->SetSimulatePhysics(true);
+	// stop taking part in crowd avoidance
+	if (UCombatCrowdAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UCombatCrowdAvoidanceSubsystem>())
+	{
+		Avoidance->UnregisterEnemy(this);
+	}
+
+	// enable full ragdoll physics if the ragdoll budget allows it
+	UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>();
+
+	if (!RagdollSubsystem)
+	{
+		GetMesh()->SetSimulatePhysics(true);
+
+	} else if (!RagdollSubsystem->RequestRagdoll(GetMesh())) {
+
+		// over budget, so play the cheap canned death instead
+		if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+		{
+			AnimInstance->Montage_Play(DeathMontage);
+		}
+	}
+
+	// clients only play the death, the server notifies the spawners and removes us
+	if (!HasAuthority())
+	{
+		return;
+	}
 
 	// call the died delegate to notify any subscribers
 	OnEnemyDied.Broadcast();
 
 	// set up the death timer
-	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &ACombatEnemy::RemoveFromLevel, DeathRemovalTime);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->SetTimer(DeathTimer, this, &ACombatEnemy::RemoveFromLevel, DeathRemovalTime);
+	}
 }
 
 void ACombatEnemy::ApplyHealing(float Healing, AActor* Healer)
@@ -273,9 +407,11 @@ float ACombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEv
 		// update the life bar
 		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
 
-		// enable partial ragdoll physics, but keep the pelvis vertical
-		GetMesh()->SetPhysicsBlendWeight(0.5f);
-		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		// enable partial ragdoll physics if the ragdoll budget allows it
+		if (UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>())
+		{
+			RagdollSubsystem->RequestHitReaction(GetMesh(), PelvisBoneName);
+		}
 	}
 
 	// return the received damage amount
@@ -289,18 +425,69 @@ void ACombatEnemy::Landed(const FHitResult& Hit)
 	// is the character still alive?
 	if (CurrentHP >= 0.0f)
 	{
-		// disable ragdoll physics
-		GetMesh()->SetPhysicsBlendWeight(0.0f);
+		// disable ragdoll physics and free up the hit reaction budget
+		if (UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>())
+		{
+			RagdollSubsystem->EndHitReaction(GetMesh());
+		}
+	}
+
+	// signal the landed slot for StateTree
+	LandedSlot.Signal();
+}
+
+void ACombatEnemy::OnRep_CurrentHP(float OldHP)
+{
+	// the life bar may not exist yet on the first update
+	if (LifeBarWidget)
+	{
+		LifeBarWidget->SetLifePercentage(FMath::Max(CurrentHP, 0.0f) / MaxHP);
+	}
+
+	// an enemy that was already dead when it replicated dies in BeginPlay
+	if (!HasActorBegunPlay())
+	{
+		return;
+	}
+
+	if (CurrentHP <= 0.0f)
+	{
+		if (OldHP > 0.0f)
+		{
+			HandleDeath();
+		}
+
+	} else if (CurrentHP < OldHP) {
+
+		// the server interrupted the attack when it hit us
+		if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+		{
+			AnimInstance->Montage_Stop(0.1f, ComboAttackMontage);
+			AnimInstance->Montage_Stop(0.1f, ChargedAttackMontage);
+		}
 	}
+}
+
+void ACombatEnemy::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	// call the landed Delegate for StateTree
-	OnEnemyLanded.ExecuteIfBound();
+	DOREPLIFETIME(ACombatEnemy, CurrentHP);
 }
 
 void ACombatEnemy::BeginPlay()
 {
-	// reset HP to maximum
-	CurrentHP = MaxHP;
+	// reset HP to maximum. Clients keep the HP replicated by the server
+	if (HasAuthority())
+	{
+		CurrentHP = MaxHP;
+	}
+
+	// create the life bar widget ahead of the component's BeginPlay so it's tracked under its own tag
+	{
+		LLM_SCOPE_BYTAG(SideScroll_LifeBars);
+		LifeBar->InitWidget();
+	}
 
 	// we top the HP before BeginPlay so StateTree picks it up at the right value
 	Super::BeginPlay();
@@ -309,8 +496,35 @@ void ACombatEnemy::BeginPlay()
 	LifeBarWidget = Cast<UCombatLifeBar>(LifeBar->GetUserWidgetObject());
 	check(LifeBarWidget);
 
-	// fill the life bar
-	LifeBarWidget->SetLifePercentage(1.0f);
+	// fill the life bar, or show the HP we replicated with
+	LifeBarWidget->SetLifePercentage(FMath::Max(CurrentHP, 0.0f) / MaxHP);
+
+	// steer around other enemies
+	if (UCombatCrowdAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UCombatCrowdAvoidanceSubsystem>())
+	{
+		Avoidance->RegisterEnemy(this);
+	}
+
+	// let the server rewind us for melee attacks from remote players
+	if (HasAuthority())
+	{
+		if (UCombatLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UCombatLagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterTarget(this, LagCompensatedBones);
+		}
+	}
+
+	// count ourselves as alive
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(this, EActorRegistryCategory::Enemy);
+	}
+
+	// we replicated to a client after we died
+	if (CurrentHP <= 0.0f && !HasAuthority())
+	{
+		HandleDeath();
+	}
 }
 
 void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -318,5 +532,38 @@ void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 
 	// clear the death timer
-	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(DeathTimer);
+	}
+
+	// release any ragdoll budget we're holding
+	if (UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>())
+	{
+		RagdollSubsystem->ReleaseMesh(GetMesh());
+	}
+
+	// give up any attack slot we're holding or waiting for
+	if (UCombatAttackSchedulerSubsystem* Scheduler = GetWorld()->GetSubsystem<UCombatAttackSchedulerSubsystem>())
+	{
+		Scheduler->ReleaseAttack(this);
+	}
+
+	// leave the crowd
+	if (UCombatCrowdAvoidanceSubsystem* Avoidance = GetWorld()->GetSubsystem<UCombatCrowdAvoidanceSubsystem>())
+	{
+		Avoidance->UnregisterEnemy(this);
+	}
+
+	// stop recording our poses
+	if (UCombatLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UCombatLagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterTarget(this);
+	}
+
+	// does nothing if we already died
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(this, EActorRegistryCategory::Enemy);
+	}
 }
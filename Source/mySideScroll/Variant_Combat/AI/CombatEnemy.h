@@ -7,19 +7,14 @@
 #include "CombatAttacker.h"
 #include "CombatDamageable.h"
 #include "Animation/AnimMontage.h"
-#include "Engine/TimerHandle.h"
+#include "GameplayTimerSubsystem.h"
+#include "CombatTaskCompletionSlot.h"
 #include "CombatEnemy.generated.h"
 
 class UWidgetComponent;
 class UCombatLifeBar;
 class UAnimMontage;
 
-/** Completed attack animation delegate for StateTree */
-DECLARE_DELEGATE(FOnEnemyAttackCompleted);
-
-/** Landed delegate for StateTree */
-DECLARE_DELEGATE(FOnEnemyLanded);
-
 /** Enemy died delegate */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnEnemyDied);
 
@@ -50,7 +45,7 @@ protected:
 public:
 
 	/** Current amount of HP the character has */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Damage", meta = (ClampMin = 0, ClampMax = 100))
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Damage", ReplicatedUsing=OnRep_CurrentHP, meta = (ClampMin = 0, ClampMax = 100))
 	float CurrentHP = 0.0f;
 
 protected:
@@ -74,6 +69,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 0, ClampMax = 500, Units = "cm"))
 	float MeleeTraceRadius = 50.0f;
 
+	/** Bones recorded for lag compensation in networked games, so limbs reaching outside of the capsule can still be hit */
+	UPROPERTY(EditAnywhere, Category="Melee Attack|Network")
+	TArray<FName> LagCompensatedBones;
+
 	/** Amount of damage a melee attack will deal */
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Damage", meta = (ClampMin = 0, ClampMax = 100))
 	float MeleeDamage = 1.0f;
@@ -126,22 +125,26 @@ protected:
 	/** Number of charge animation loop currently playing */
 	int32 CurrentChargeLoop = 0;
 
+	/** AnimMontage that will play on death if the ragdoll budget is exhausted */
+	UPROPERTY(EditAnywhere, Category="Death")
+	UAnimMontage* DeathMontage;
+
 	/** Time to wait before removing this character from the level after it dies */
 	UPROPERTY(EditAnywhere, Category="Death")
 	float DeathRemovalTime = 5.0f;
 
 	/** Enemy death timer */
-	FTimerHandle DeathTimer;
+	FGameplayTimerHandle DeathTimer;
 
 	/** Attack montage ended delegate */
 	FOnMontageEnded OnAttackMontageEnded;
 
 public:
-	/** Attack completed internal delegate to notify StateTree tasks */
-	FOnEnemyAttackCompleted OnAttackCompleted;
+	/** Attack completed slot, signalled to finish the waiting StateTree attack task */
+	FCombatTaskCompletionSlot AttackCompletedSlot;
 
-	/** Landed internal delegate to notify StateTree tasks. We use this instead of the built-in Landed delegate so we can bind to a Lambda in StateTree tasks */
-	FOnEnemyLanded OnEnemyLanded;
+	/** Landed slot, signalled to finish the waiting StateTree landing task. We use this instead of the built-in Landed delegate so binding doesn't allocate */
+	FCombatTaskCompletionSlot LandedSlot;
 
 	/** Enemy died delegate. Allows external subscribers to respond to enemy death */
 	UPROPERTY(BlueprintAssignable, Category="Events")
@@ -152,12 +155,21 @@ public:
 	/** Performs an AI-initiated combo attack. Number of hits will be decided by this character */
 	void DoAIComboAttack();
 
+	/** Sets the current HP and updates the life bar. Used when restoring checkpoints */
+	void RestoreHP(float NewHP);
+
 	/** Performs an AI-initiated charged attack. Charge time will be decided by this character */
 	void DoAIChargedAttack();
 
 	/** Called from a delegate when the attack montage ends */
 	void AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
+protected:
+
+	/** Plays an attack montage on clients, jumping to a section if one is provided. The server drives the attack, so clients only follow along */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastAttackMontage(UAnimMontage* Montage, FName SectionName);
+
 public:
 
 	// ~begin ICombatAttacker interface
@@ -193,6 +205,10 @@ protected:
 	/** Removes this character from the level after it dies */
 	void RemoveFromLevel();
 
+	/** Updates the life bar when the server changes our HP, interrupting attacks on damage and dying once it runs out */
+	UFUNCTION()
+	void OnRep_CurrentHP(float OldHP);
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
@@ -209,6 +225,9 @@ protected:
 
 protected:
 
+	/** Sets up the replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** Gameplay initialization */
 	virtual void BeginPlay() override;
 
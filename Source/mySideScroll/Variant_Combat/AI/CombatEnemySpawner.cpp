@@ -2,11 +2,15 @@
 
 
 #include "CombatEnemySpawner.h"
+#include "mySideScroll.h"
+#include "SideScrollMemory.h"
 #include "Components/SceneComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/ArrowComponent.h"
-#include "TimerManager.h"
 #include "CombatEnemy.h"
+#include "ActorRegistrySubsystem.h"
+#include "CombatCheckpointSubsystem.h"
+#include "Engine/World.h"
 
 ACombatEnemySpawner::ACombatEnemySpawner()
 {
@@ -30,12 +34,30 @@ ACombatEnemySpawner::ACombatEnemySpawner()
 void ACombatEnemySpawner::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// resolve the activatable targets once
+	DepletedActivationTargets.Resolve(ActorsToActivateWhenDepleted);
+
+	// register with the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(this, EActorRegistryCategory::Spawner);
+	}
+
+	// take part in checkpoint snapshots
+	if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+	{
+		CheckpointSubsystem->RegisterCheckpointable(this);
+	}
 	
 	// should we spawn an enemy right away?
 	if (bShouldSpawnEnemiesImmediately)
 	{
 		// schedule the first enemy spawn
-		GetWorld()->GetTimerManager().SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, InitialSpawnDelay);
+		if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+		{
+			Timers->SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, InitialSpawnDelay);
+		}
 	}
 
 }
@@ -45,11 +67,28 @@ void ACombatEnemySpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 
 	// clear the spawn timer
-	GetWorld()->GetTimerManager().ClearTimer(SpawnTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(SpawnTimer);
+	}
+
+	// unregister from the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(this, EActorRegistryCategory::Spawner);
+	}
+
+	if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+	{
+		CheckpointSubsystem->UnregisterCheckpointable(this);
+	}
 }
 
 void ACombatEnemySpawner::SpawnEnemy()
 {
+	SIDESCROLL_SCOPE(CombatSpawnEnemy);
+	LLM_SCOPE_BYTAG(SideScroll_Enemies);
+
 	// ensure the enemy class is valid
 	if (IsValid(EnemyClass))
 	{
@@ -57,19 +96,25 @@ void ACombatEnemySpawner::SpawnEnemy()
 		FActorSpawnParameters SpawnParams;
 		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-		ACombatEnemy* SpawnedEnemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
+		ACombatEnemy* NewEnemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
 
 		// was the enemy successfully created?
-		if (SpawnedEnemy)
+		if (NewEnemy)
 		{
 			// subscribe to the death delegate
-			SpawnedEnemy->OnEnemyDied.AddDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+			NewEnemy->OnEnemyDied.AddDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+
+			// keep track of the enemy for checkpoints
+			SpawnedEnemy = NewEnemy;
 		}
 	}
 }
 
 void ACombatEnemySpawner::OnEnemyDied()
 {
+	// the enemy is no longer alive
+	SpawnedEnemy.Reset();
+
 	// decrease the spawn counter
 	--SpawnCount;
 
@@ -77,26 +122,25 @@ void ACombatEnemySpawner::OnEnemyDied()
 	if (SpawnCount <= 0)
 	{
 		// schedule the activation on depleted message
-		GetWorld()->GetTimerManager().SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnerDepleted, ActivationDelay);
+		if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+		{
+			Timers->SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnerDepleted, ActivationDelay);
+		}
+
 		return;
 	}
 
 	// schedule the next enemy spawn
-	GetWorld()->GetTimerManager().SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, RespawnDelay);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, RespawnDelay);
+	}
 }
 
 void ACombatEnemySpawner::SpawnerDepleted()
 {
-	// process the actors to activate list
-	for (AActor* CurrentActor : ActorsToActivateWhenDepleted)
-	{
-		// check if the actor is activatable
-		if (ICombatActivatable* CombatActivatable = Cast<ICombatActivatable>(CurrentActor))
-		{
-			// activate the actor
-			CombatActivatable->ActivateInteraction(this);
-		}
-	}
+	// activate the resolved targets
+	DepletedActivationTargets.ActivateAll(this);
 }
 
 void ACombatEnemySpawner::ToggleInteraction(AActor* ActivationInstigator)
@@ -123,3 +167,90 @@ void ACombatEnemySpawner::DeactivateInteraction(AActor* ActivationInstigator)
 {
 	// stub
 }
+
+void ACombatEnemySpawner::SaveCheckpointState(FArchive& Ar)
+{
+	// save the current enemy
+	ACombatEnemy* CurrentEnemy = SpawnedEnemy.Get();
+
+	bool bHasEnemy = IsValid(CurrentEnemy);
+
+	Ar << SpawnCount;
+	SerializeCheckpointFlags(Ar, { &bHasBeenActivated, &bHasEnemy });
+
+	if (bHasEnemy)
+	{
+		FTransform EnemyTransform = CurrentEnemy->GetActorTransform();
+		float EnemyHP = CurrentEnemy->CurrentHP;
+
+		Ar << EnemyTransform;
+		Ar << EnemyHP;
+	}
+
+	// save the pending spawn or depletion timer
+	const UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this);
+	float TimerRemaining = Timers ? Timers->GetTimerRemaining(SpawnTimer) : -1.0f;
+	Ar << TimerRemaining;
+}
+
+void ACombatEnemySpawner::RestoreCheckpointState(FArchive& Ar)
+{
+	bool bHasEnemy = false;
+
+	Ar << SpawnCount;
+	SerializeCheckpointFlags(Ar, { &bHasBeenActivated, &bHasEnemy });
+
+	FTransform EnemyTransform;
+	float EnemyHP = 0.0f;
+
+	if (bHasEnemy)
+	{
+		Ar << EnemyTransform;
+		Ar << EnemyHP;
+	}
+
+	float TimerRemaining = -1.0f;
+	Ar << TimerRemaining;
+
+	// cancel any pending spawns
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(SpawnTimer);
+	}
+
+	// remove the current enemy without counting it as a kill
+	if (ACombatEnemy* CurrentEnemy = SpawnedEnemy.Get())
+	{
+		CurrentEnemy->OnEnemyDied.RemoveDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+		CurrentEnemy->Destroy();
+	}
+
+	SpawnedEnemy.Reset();
+
+	// bring back the enemy that was alive at the checkpoint
+	if (bHasEnemy)
+	{
+		SpawnEnemy();
+
+		if (ACombatEnemy* RestoredEnemy = SpawnedEnemy.Get())
+		{
+			RestoredEnemy->SetActorTransform(EnemyTransform, false, nullptr, ETeleportType::ResetPhysics);
+			RestoredEnemy->RestoreHP(EnemyHP);
+		}
+	}
+
+	// resume the pending spawn or depletion timer
+	UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this);
+
+	if (TimerRemaining > 0.0f && Timers)
+	{
+		if (SpawnCount <= 0)
+		{
+			Timers->SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnerDepleted, TimerRemaining);
+		}
+		else
+		{
+			Timers->SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, TimerRemaining);
+		}
+	}
+}
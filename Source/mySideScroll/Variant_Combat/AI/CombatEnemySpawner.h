@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "CombatActivatable.h"
+#include "CombatCheckpointable.h"
+#include "GameplayTimerSubsystem.h"
 #include "CombatEnemySpawner.generated.h"
 
 class UCapsuleComponent;
@@ -16,9 +18,10 @@ class ACombatEnemy;
  *  Enemies will be spawned one by one, and the spawner will wait until the enemy dies before spawning a new one.
  *  The spawner can be remotely activated through the ICombatActivatable interface
  *  When the last spawned enemy dies, the spawner can also activate other ICombatActivatables
+ *  Its state, including the current enemy, is saved into checkpoint snapshots through the ICombatCheckpointable interface
  */
 UCLASS(abstract)
-class ACombatEnemySpawner : public AActor, public ICombatActivatable
+class ACombatEnemySpawner : public AActor, public ICombatActivatable, public ICombatCheckpointable
 {
 	GENERATED_BODY()
 	
@@ -58,11 +61,17 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Activation")
 	TArray<AActor*> ActorsToActivateWhenDepleted;
 
+	/** Activatable targets resolved from ActorsToActivateWhenDepleted on BeginPlay */
+	FCombatActivationTargets DepletedActivationTargets;
+
 	/** Flag to ensure this is only activated once */
 	bool bHasBeenActivated = false;
 
 	/** Timer to spawn enemies after a delay */
-	FTimerHandle SpawnTimer;
+	FGameplayTimerHandle SpawnTimer;
+
+	/** Enemy currently alive from this spawner */
+	TWeakObjectPtr<ACombatEnemy> SpawnedEnemy;
 
 public:	
 	
@@ -106,4 +115,14 @@ public:
 	virtual void DeactivateInteraction(AActor* ActivationInstigator) override;
 
 	// ~end IActivatable interface
+
+	// ~begin ICombatCheckpointable interface
+
+	/** Saves the spawn count, activation and current enemy state */
+	virtual void SaveCheckpointState(FArchive& Ar) override;
+
+	/** Restores the spawn count, activation and current enemy state */
+	virtual void RestoreCheckpointState(FArchive& Ar) override;
+
+	// ~end ICombatCheckpointable interface
 };
@@ -2,6 +2,7 @@
 
 
 #include "CombatStateTreeUtility.h"
+#include "mySideScroll.h"
 #include "StateTreeExecutionContext.h"
 #include "StateTreeExecutionTypes.h"
 #include "GameFramework/Character.h"
@@ -9,7 +10,77 @@
 #include "AIController.h"
 #include "CombatEnemy.h"
 #include "Kismet/GameplayStatics.h"
+#include "ActorRegistrySubsystem.h"
 #include "StateTreeAsyncExecutionContext.h"
+#include "CombatTaskCompletionSlot.h"
+#include "CombatAttackSchedulerSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+static FAutoConsoleCommand CCmdCombatTaskSlotBenchmark(
+	TEXT("Combat.AI.TaskSlotBenchmark"),
+	TEXT("Compares binding StateTree task completion through lambda delegates against the intrusive completion slots.\n")
+	TEXT("Simulates N enemies (default 500) entering, completing and exiting a latent task for a number of iterations (default 1000).\n")
+	TEXT("Usage: Combat.AI.TaskSlotBenchmark [NumEnemies] [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumEnemies = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 500;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 1000;
+
+		// the contexts are never valid, so finishing the task is a no-op in both paths and only the binding cost is measured
+		const FStateTreeWeakExecutionContext WeakContext;
+
+		// lambda delegates, as previously used by the tasks
+		TArray<FSimpleDelegate> Delegates;
+		Delegates.SetNum(NumEnemies);
+
+		double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			for (FSimpleDelegate& Delegate : Delegates)
+			{
+				Delegate.BindLambda([WeakContext]()
+				{
+					WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
+				});
+
+				Delegate.ExecuteIfBound();
+				Delegate.Unbind();
+			}
+		}
+
+		const double DelegateTime = FPlatformTime::Seconds() - StartTime;
+
+		// intrusive completion slots
+		TArray<FCombatTaskCompletionSlot> Slots;
+		Slots.SetNum(NumEnemies);
+
+		StartTime = FPlatformTime::Seconds();
+
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			for (FCombatTaskCompletionSlot& Slot : Slots)
+			{
+				Slot.Bind(WeakContext);
+				Slot.Signal();
+				Slot.Unbind();
+			}
+		}
+
+		const double SlotTime = FPlatformTime::Seconds() - StartTime;
+
+		const double NumStateChanges = static_cast<double>(NumEnemies) * Iterations;
+
+		UE_LOG(LogTemp, Log, TEXT("Task completion benchmark, %d enemies x %d state changes: lambda delegates %.3f ms (%.1f ns per change), completion slots %.3f ms (%.1f ns per change)"),
+			NumEnemies,
+			Iterations,
+			DelegateTime * 1000.0,
+			(DelegateTime / NumStateChanges) * 1.0e9,
+			SlotTime * 1000.0,
+			(SlotTime / NumStateChanges) * 1.0e9);
+	}));
 
 bool FStateTreeCharacterGroundedCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
@@ -30,25 +101,63 @@ FText FStateTreeCharacterGroundedCondition::GetDescription(const FGuid& ID, FSta
 
 ////////////////////////////////////////////////////////////////////
 
+/** Requests an attack slot against the player from the attack scheduler, or attacks right away if there's no scheduler */
+static void RequestScheduledAttack(ACombatEnemy* Character, ECombatScheduledAttack Type)
+{
+	UCombatAttackSchedulerSubsystem* Scheduler = Character->GetWorld()->GetSubsystem<UCombatAttackSchedulerSubsystem>();
+
+	if (!Scheduler)
+	{
+		if (Type == ECombatScheduledAttack::Combo)
+		{
+			Character->DoAIComboAttack();
+		}
+		else
+		{
+			Character->DoAIChargedAttack();
+		}
+
+		return;
+	}
+
+	// attack slots are counted per target, which is the closest player
+	AActor* Target = nullptr;
+
+	if (UActorRegistrySubsystem* Registry = UActorRegistrySubsystem::Get(Character))
+	{
+		Target = Registry->GetNearestPlayerPawn(Character->GetActorLocation());
+	}
+
+	Scheduler->RequestAttack(Character, Target, Type);
+}
+
+/** Frees the character's attack slot, or removes it from the scheduler queue */
+static void ReleaseScheduledAttack(ACombatEnemy* Character)
+{
+	if (UCombatAttackSchedulerSubsystem* Scheduler = Character->GetWorld()->GetSubsystem<UCombatAttackSchedulerSubsystem>())
+	{
+		Scheduler->ReleaseAttack(Character);
+	}
+}
+
+////////////////////////////////////////////////////////////////////
+
 EStateTreeRunStatus FStateTreeComboAttackTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SIDESCROLL_SCOPE(StateTreeComboAttackEnterState);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind to the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()]()
-			{
-				WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
-			}
-		);
+		// wait on the attack completed slot
+		InstanceData.Character->AttackCompletedSlot.Bind(Context.MakeWeakExecutionContext());
 
 
-		// tell the character to do a combo attack
-		InstanceData.Character->DoAIComboAttack();
+		// request an attack slot. The combo attack starts once it's granted
+		RequestScheduledAttack(InstanceData.Character, ECombatScheduledAttack::Combo);
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -62,8 +171,11 @@ void FStateTreeComboAttackTask::ExitState(FStateTreeExecutionContext& Context, c
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// unbind the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.Unbind();
+		// stop waiting on the attack completed slot
+		InstanceData.Character->AttackCompletedSlot.Unbind();
+
+		// give up the attack slot if we left the state early
+		ReleaseScheduledAttack(InstanceData.Character);
 	}
 }
 
@@ -78,22 +190,19 @@ FText FStateTreeComboAttackTask::GetDescription(const FGuid& ID, FStateTreeDataV
 
 EStateTreeRunStatus FStateTreeChargedAttackTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SIDESCROLL_SCOPE(StateTreeChargedAttackEnterState);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind to the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()]()
-			{
-				WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
-			}
-		);
+		// wait on the attack completed slot
+		InstanceData.Character->AttackCompletedSlot.Bind(Context.MakeWeakExecutionContext());
 
-		// tell the character to do a combo attack
-		InstanceData.Character->DoAIChargedAttack();
+		// request an attack slot. The charged attack starts once it's granted
+		RequestScheduledAttack(InstanceData.Character, ECombatScheduledAttack::Charged);
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -107,8 +216,11 @@ void FStateTreeChargedAttackTask::ExitState(FStateTreeExecutionContext& Context,
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// unbind the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.Unbind();
+		// stop waiting on the attack completed slot
+		InstanceData.Character->AttackCompletedSlot.Unbind();
+
+		// give up the attack slot if we left the state early
+		ReleaseScheduledAttack(InstanceData.Character);
 	}
 }
 
@@ -123,19 +235,16 @@ FText FStateTreeChargedAttackTask::GetDescription(const FGuid& ID, FStateTreeDat
 
 EStateTreeRunStatus FStateTreeWaitForLandingTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SIDESCROLL_SCOPE(StateTreeWaitForLandingEnterState);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind to the on enemy landed delegate
-		InstanceData.Character->OnEnemyLanded.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()]()
-			{
-				WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
-			}
-		);
+		// wait on the landed slot
+		InstanceData.Character->LandedSlot.Bind(Context.MakeWeakExecutionContext());
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -149,8 +258,8 @@ void FStateTreeWaitForLandingTask::ExitState(FStateTreeExecutionContext& Context
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind the on enemy landed delegate
-		InstanceData.Character->OnEnemyLanded.Unbind();
+		// stop waiting on the landed slot
+		InstanceData.Character->LandedSlot.Unbind();
 	}
 }
 
@@ -165,6 +274,8 @@ FText FStateTreeWaitForLandingTask::GetDescription(const FGuid& ID, FStateTreeDa
 
 EStateTreeRunStatus FStateTreeFaceActorTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SIDESCROLL_SCOPE(StateTreeFaceActorEnterState);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -202,6 +313,8 @@ FText FStateTreeFaceActorTask::GetDescription(const FGuid& ID, FStateTreeDataVie
 
 EStateTreeRunStatus FStateTreeFaceLocationTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SIDESCROLL_SCOPE(StateTreeFaceLocationEnterState);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -239,6 +352,8 @@ FText FStateTreeFaceLocationTask::GetDescription(const FGuid& ID, FStateTreeData
 
 EStateTreeRunStatus FStateTreeSetCharacterSpeedTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
 {
+	SIDESCROLL_SCOPE(StateTreeSetCharacterSpeedEnterState);
+
 	// have we transitioned from another state?
 	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
 	{
@@ -263,11 +378,20 @@ FText FStateTreeSetCharacterSpeedTask::GetDescription(const FGuid& ID, FStateTre
 
 EStateTreeRunStatus FStateTreeGetPlayerInfoTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
+	SIDESCROLL_SCOPE(StateTreeGetPlayerInfoTick);
+
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// get the character possessed by the first local player
-	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+	// target the closest registered player character
+	if (UActorRegistrySubsystem* Registry = UActorRegistrySubsystem::Get(InstanceData.Character))
+	{
+		InstanceData.TargetPlayerCharacter = Cast<ACharacter>(Registry->GetNearestPlayerPawn(InstanceData.Character->GetActorLocation()));
+	}
+	else
+	{
+		InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+	}
 
 	// do we have a valid target?
 	if (InstanceData.TargetPlayerCharacter)
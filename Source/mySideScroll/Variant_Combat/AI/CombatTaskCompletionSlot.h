@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StateTreeAsyncExecutionContext.h"
+
+/**
+ *  Intrusive completion slot for a latent StateTree task
+ *  Holds the waiting task's weak execution context inline in the owning actor,
+ *  so binding and unbinding on every state change doesn't allocate delegate storage.
+ *  Only one task can wait on a slot at a time, which matches how the combat StateTree tasks use it.
+ */
+struct FCombatTaskCompletionSlot
+{
+public:
+
+	/** Makes the task owning the context wait on this slot, replacing any previous task */
+	void Bind(const FStateTreeWeakExecutionContext& InContext)
+	{
+		Context = InContext;
+		bIsBound = true;
+	}
+
+	/** Stops the current task from waiting on this slot */
+	void Unbind()
+	{
+		Context = FStateTreeWeakExecutionContext();
+		bIsBound = false;
+	}
+
+	/** Returns true if a task is waiting on this slot */
+	bool IsBound() const { return bIsBound; }
+
+	/** Finishes the waiting task, if any. The slot is cleared before finishing the task */
+	void Signal(EStateTreeFinishTaskType FinishType = EStateTreeFinishTaskType::Succeeded)
+	{
+		if (!bIsBound)
+		{
+			return;
+		}
+
+		const FStateTreeWeakExecutionContext SignalledContext = MoveTemp(Context);
+		Unbind();
+
+		SignalledContext.FinishTask(FinishType);
+	}
+
+private:
+
+	/** Weak execution context of the waiting task */
+	FStateTreeWeakExecutionContext Context;
+
+	/** Set while a task is waiting on this slot */
+	bool bIsBound = false;
+};
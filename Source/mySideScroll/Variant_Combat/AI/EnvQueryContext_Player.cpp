@@ -6,11 +6,22 @@
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/Controller.h"
+#include "ActorRegistrySubsystem.h"
 
 void UEnvQueryContext_Player::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
 {
-	// get the player pawn for the first local player
-	AActor* PlayerPawn = UGameplayStatics::GetPlayerPawn(QueryInstance.Owner.Get(), 0);
+	// queries run by a controller are centered on its pawn
+	const AActor* QueryOwner = Cast<AActor>(QueryInstance.Owner.Get());
+
+	if (const AController* Controller = Cast<AController>(QueryOwner); Controller && Controller->GetPawn())
+	{
+		QueryOwner = Controller->GetPawn();
+	}
+
+	// get the registered player pawn closest to the querier, falling back to the first local player outside of game worlds
+	UActorRegistrySubsystem* Registry = UActorRegistrySubsystem::Get(QueryInstance.Owner.Get());
+	AActor* PlayerPawn = Registry && QueryOwner ? Registry->GetNearestPlayerPawn(QueryOwner->GetActorLocation()) : UGameplayStatics::GetPlayerPawn(QueryInstance.Owner.Get(), 0);
 	check(PlayerPawn);
 
 	// add the actor data to the context
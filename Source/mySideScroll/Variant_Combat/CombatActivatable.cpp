@@ -1,4 +1,33 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 
-#include "CombatActivatable.h"
\ No newline at end of file
+#include "CombatActivatable.h"
+#include "GameFramework/Actor.h"
+
+void FCombatActivationTargets::Resolve(const TArray<AActor*>& InActors)
+{
+	Actors.Reset(InActors.Num());
+	Activatables.Reset(InActors.Num());
+
+	for (AActor* CurrentActor : InActors)
+	{
+		// only keep the actors that can actually be activated
+		if (ICombatActivatable* Activatable = Cast<ICombatActivatable>(CurrentActor))
+		{
+			Actors.Add(CurrentActor);
+			Activatables.Add(Activatable);
+		}
+	}
+}
+
+void FCombatActivationTargets::ActivateAll(AActor* ActivationInstigator) const
+{
+	for (int32 i = 0; i < Activatables.Num(); ++i)
+	{
+		// skip targets destroyed since they were resolved
+		if (Actors[i].IsValid())
+		{
+			Activatables[i]->ActivateInteraction(ActivationInstigator);
+		}
+	}
+}
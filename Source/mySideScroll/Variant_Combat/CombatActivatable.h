@@ -34,3 +34,27 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Activatable")
 	virtual void DeactivateInteraction(AActor* ActivationInstigator) = 0;
 };
+
+/**
+ *  Flat list of activatable targets, resolved once from an editor actor list
+ *  Avoids casting every referenced actor each time the list is triggered
+ */
+struct FCombatActivationTargets
+{
+	/** Resolves the activatable interfaces for the given actors. Non-activatable actors are skipped */
+	void Resolve(const TArray<AActor*>& InActors);
+
+	/** Activates every resolved target that is still valid */
+	void ActivateAll(AActor* ActivationInstigator) const;
+
+	/** Returns the number of resolved targets */
+	int32 Num() const { return Activatables.Num(); }
+
+private:
+
+	/** Owning actors, used to skip targets that have been destroyed */
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	/** Resolved interface pointers, parallel to Actors */
+	TArray<ICombatActivatable*> Activatables;
+};
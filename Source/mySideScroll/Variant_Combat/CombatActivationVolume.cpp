@@ -3,8 +3,10 @@
 
 #include "CombatActivationVolume.h"
 #include "Components/BoxComponent.h"
-#include "GameFramework/Character.h"
-#include "CombatActivatable.h"
+#include "GameFramework/Pawn.h"
+#include "CombatCollision.h"
+#include "CombatCheckpointSubsystem.h"
+#include "Engine/World.h"
 
 ACombatActivationVolume::ACombatActivationVolume()
 {
@@ -17,33 +19,84 @@ ACombatActivationVolume::ACombatActivationVolume()
 	// set the box's extent
 	Box->SetBoxExtent(FVector(500.0f, 500.0f, 500.0f));
 
-	// set the default collision profile to overlap all dynamic
-	Box->SetCollisionProfileName(FName("OverlapAllDynamic"));
+	// only overlap player pawns, so ragdolls, props and enemies don't generate overlap events
+	Box->SetCollisionProfileName(CombatCollision::PlayerTriggerProfile);
 
 	// bind the begin overlap 
 	Box->OnComponentBeginOverlap.AddDynamic(this, &ACombatActivationVolume::OnOverlap);
 }
 
+void ACombatActivationVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// resolve the activatable targets once
+	ActivationTargets.Resolve(ActorsToActivate);
+
+	// take part in checkpoint snapshots
+	if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+	{
+		CheckpointSubsystem->RegisterCheckpointable(this);
+	}
+}
+
+void ACombatActivationVolume::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// stop taking part in checkpoint snapshots
+	if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+	{
+		CheckpointSubsystem->UnregisterCheckpointable(this);
+	}
+}
+
 void ACombatActivationVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
-	// has a Character entered the volume?
-	ACharacter* PlayerCharacter = Cast<ACharacter>(OtherActor);
+	// the trigger profile filters out everything but player pawns, but double check in case the profile was changed on the instance
+	APawn* PlayerPawn = Cast<APawn>(OtherActor);
 
-	if (PlayerCharacter)
+	if (PlayerPawn && PlayerPawn->IsPlayerControlled())
+	{
+		Trigger(PlayerPawn);
+	}
+}
+
+void ACombatActivationVolume::Trigger(AActor* ActivationInstigator)
+{
+	// ensure we only trigger once if requested
+	if (bTriggerOnce && bHasBeenTriggered)
 	{
-		// is the Character controlled by a player
-		if (PlayerCharacter->IsPlayerControlled())
-		{
-			// process the actors to activate list
-			for (AActor* CurrentActor : ActorsToActivate)
-			{
-				// is the referenced actor activatable?
-				if(ICombatActivatable* Activatable = Cast<ICombatActivatable>(CurrentActor))
-				{
-					Activatable->ActivateInteraction(PlayerCharacter);
-				}
-			}
-		}
+		return;
 	}
 
-}
\ No newline at end of file
+	bHasBeenTriggered = true;
+
+	// activate the resolved targets
+	ActivationTargets.ActivateAll(ActivationInstigator);
+}
+
+void ACombatActivationVolume::ToggleInteraction(AActor* ActivationInstigator)
+{
+	Trigger(ActivationInstigator);
+}
+
+void ACombatActivationVolume::ActivateInteraction(AActor* ActivationInstigator)
+{
+	Trigger(ActivationInstigator);
+}
+
+void ACombatActivationVolume::DeactivateInteraction(AActor* ActivationInstigator)
+{
+	// stub
+}
+
+void ACombatActivationVolume::SaveCheckpointState(FArchive& Ar)
+{
+	SerializeCheckpointFlags(Ar, { &bHasBeenTriggered });
+}
+
+void ACombatActivationVolume::RestoreCheckpointState(FArchive& Ar)
+{
+	SerializeCheckpointFlags(Ar, { &bHasBeenTriggered });
+}
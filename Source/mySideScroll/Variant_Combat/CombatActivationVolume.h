@@ -4,15 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "CombatActivatable.h"
+#include "CombatCheckpointable.h"
 #include "CombatActivationVolume.generated.h"
 
 class UBoxComponent;
 
 /**
  *  A simple volume that activates a list of actors when the player pawn enters.
+ *  Uses the PlayerTrigger collision profile so only player pawns generate overlaps.
+ *  The volume is itself activatable, so it can be chained from spawners or other volumes.
  */
 UCLASS()
-class ACombatActivationVolume : public AActor
+class ACombatActivationVolume : public AActor, public ICombatActivatable, public ICombatCheckpointable
 {
 	GENERATED_BODY()
 
@@ -26,6 +30,16 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Activation Volume")
 	TArray<AActor*> ActorsToActivate;
 
+	/** If true, the volume only activates its actors the first time it is triggered */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Activation Volume")
+	bool bTriggerOnce = true;
+
+	/** Activatable targets resolved from ActorsToActivate on BeginPlay */
+	FCombatActivationTargets ActivationTargets;
+
+	/** Set once the volume has been triggered */
+	bool bHasBeenTriggered = false;
+
 public:	
 	
 	/** Constructor */
@@ -33,8 +47,44 @@ public:
 
 protected:
 
+	/** Initialization */
+	virtual void BeginPlay() override;
+
+	/** Cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
 	/** Handles overlaps with the box volume */
 	UFUNCTION()
 	void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
+	/** Activates the resolved targets, respecting the trigger once flag */
+	void Trigger(AActor* ActivationInstigator);
+
+public:
+
+	// ~begin ICombatActivatable interface
+
+	/** Triggers the volume */
+	UFUNCTION(BlueprintCallable, Category="Activatable")
+	virtual void ToggleInteraction(AActor* ActivationInstigator) override;
+
+	/** Triggers the volume */
+	UFUNCTION(BlueprintCallable, Category="Activatable")
+	virtual void ActivateInteraction(AActor* ActivationInstigator) override;
+
+	/** Stub */
+	UFUNCTION(BlueprintCallable, Category="Activatable")
+	virtual void DeactivateInteraction(AActor* ActivationInstigator) override;
+
+	// ~end ICombatActivatable interface
+
+	// ~begin ICombatCheckpointable interface
+
+	/** Saves the triggered flag */
+	virtual void SaveCheckpointState(FArchive& Ar) override;
+
+	/** Restores the triggered flag */
+	virtual void RestoreCheckpointState(FArchive& Ar) override;
+
+	// ~end ICombatCheckpointable interface
 };
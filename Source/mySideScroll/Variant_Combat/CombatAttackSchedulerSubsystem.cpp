@@ -0,0 +1,229 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatAttackSchedulerSubsystem.h"
+#include "CombatEnemy.h"
+#include "mySideScroll.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY(LogCombatAttackScheduler);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Attack Queue Depth"), STAT_CombatAttackQueueDepth, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Attackers"), STAT_CombatActiveAttackers, STATGROUP_SideScroll);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Attack Slot Avg Wait (ms)"), STAT_CombatAttackAvgWait, STATGROUP_SideScroll);
+
+TRACE_DECLARE_INT_COUNTER(CombatAttackQueueDepth, TEXT("Combat/AttackScheduler/QueueDepth"));
+TRACE_DECLARE_INT_COUNTER(CombatActiveAttackers, TEXT("Combat/AttackScheduler/ActiveAttackers"));
+TRACE_DECLARE_FLOAT_COUNTER(CombatAttackWait, TEXT("Combat/AttackScheduler/Wait (ms)"));
+
+static TAutoConsoleVariable<bool> CVarCombatAttackSchedulerEnabled(
+	TEXT("Combat.AttackScheduler.Enabled"),
+	true,
+	TEXT("If false, enemy attacks start immediately without requesting a slot."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCombatMaxAttackersPerTarget(
+	TEXT("Combat.AttackScheduler.MaxAttackersPerTarget"),
+	2,
+	TEXT("Max number of enemies that can attack the same target at the same time."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCombatMaxAttackStartsPerFrame(
+	TEXT("Combat.AttackScheduler.MaxStartsPerFrame"),
+	1,
+	TEXT("Max number of enemy attacks that can start on the same frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatMaxAttackSlotHoldTime(
+	TEXT("Combat.AttackScheduler.MaxHoldTime"),
+	10.0f,
+	TEXT("Time after which an attack slot is reclaimed even if the attacker never released it."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld CCmdCombatAttackSchedulerStats(
+	TEXT("Combat.AttackScheduler.Stats"),
+	TEXT("Logs the attack scheduler queue depth, active attackers and wait times."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UCombatAttackSchedulerSubsystem* Scheduler = World ? World->GetSubsystem<UCombatAttackSchedulerSubsystem>() : nullptr)
+		{
+			Scheduler->LogStats();
+		}
+	}));
+
+bool UCombatAttackSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UCombatAttackSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatAttackSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatAttackSchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	PruneAndUpdateStats();
+
+	// grant queued attacks in request order, while we have slots
+	for (int32 i = 0; i < PendingAttacks.Num(); )
+	{
+		const FCombatPendingAttack& Pending = PendingAttacks[i];
+
+		if (!CanStartAttack(Pending.Target.Get()))
+		{
+			// out of starts for this frame, leave the rest of the queue for later frames
+			if (StartsThisFrame >= FMath::Max(CVarCombatMaxAttackStartsPerFrame.GetValueOnGameThread(), 1))
+			{
+				break;
+			}
+
+			// this target is saturated, but attacks on other targets may still start
+			++i;
+			continue;
+		}
+
+		const FCombatPendingAttack Granted = Pending;
+		PendingAttacks.RemoveAt(i, EAllowShrinking::No);
+
+		StartAttack(Granted.Attacker.Get(), Granted.Target.Get(), Granted.Type, Granted.RequestTime);
+	}
+}
+
+void UCombatAttackSchedulerSubsystem::RequestAttack(ACombatEnemy* Attacker, AActor* Target, ECombatScheduledAttack Type)
+{
+	if (!IsValid(Attacker))
+	{
+		return;
+	}
+
+	// drop any previous request or slot held by this attacker
+	ReleaseAttack(Attacker);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// start right away if we have a slot, or if the scheduler is disabled
+	if (!CVarCombatAttackSchedulerEnabled.GetValueOnGameThread() || CanStartAttack(Target))
+	{
+		StartAttack(Attacker, Target, Type, Now);
+		return;
+	}
+
+	// wait for a slot
+	FCombatPendingAttack& Pending = PendingAttacks.AddDefaulted_GetRef();
+	Pending.Attacker = Attacker;
+	Pending.Target = Target;
+	Pending.Type = Type;
+	Pending.RequestTime = Now;
+}
+
+void UCombatAttackSchedulerSubsystem::ReleaseAttack(ACombatEnemy* Attacker)
+{
+	ActiveAttacks.RemoveAllSwap([Attacker](const FCombatActiveAttack& Active) { return Active.Attacker.Get() == Attacker; }, EAllowShrinking::No);
+
+	// keep the queue in order
+	PendingAttacks.RemoveAll([Attacker](const FCombatPendingAttack& Pending) { return Pending.Attacker.Get() == Attacker; });
+}
+
+bool UCombatAttackSchedulerSubsystem::CanStartAttack(const AActor* Target)
+{
+	// reset the per frame budget on a new frame
+	if (LastStartFrame != GFrameCounter)
+	{
+		LastStartFrame = GFrameCounter;
+		StartsThisFrame = 0;
+	}
+
+	if (StartsThisFrame >= FMath::Max(CVarCombatMaxAttackStartsPerFrame.GetValueOnGameThread(), 1))
+	{
+		return false;
+	}
+
+	// count the attackers already on this target
+	const int32 MaxAttackers = FMath::Max(CVarCombatMaxAttackersPerTarget.GetValueOnGameThread(), 1);
+	int32 NumAttackers = 0;
+
+	for (const FCombatActiveAttack& Active : ActiveAttacks)
+	{
+		if (Active.Target.Get() == Target && ++NumAttackers >= MaxAttackers)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UCombatAttackSchedulerSubsystem::StartAttack(ACombatEnemy* Attacker, AActor* Target, ECombatScheduledAttack Type, double RequestTime)
+{
+	if (!IsValid(Attacker))
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	// hold the slot until the attacker releases it
+	FCombatActiveAttack& Active = ActiveAttacks.AddDefaulted_GetRef();
+	Active.Attacker = Attacker;
+	Active.Target = Target;
+	Active.GrantTime = Now;
+
+	++StartsThisFrame;
+
+	// update the wait stats
+	const double WaitTime = Now - RequestTime;
+
+	TotalWaitTime += WaitTime;
+	MaxWaitTime = FMath::Max(MaxWaitTime, WaitTime);
+	++NumGranted;
+
+	TRACE_COUNTER_SET(CombatAttackWait, WaitTime * 1000.0);
+
+	// start the attack
+	switch (Type)
+	{
+	case ECombatScheduledAttack::Combo:
+		Attacker->DoAIComboAttack();
+		break;
+	case ECombatScheduledAttack::Charged:
+		Attacker->DoAIChargedAttack();
+		break;
+	}
+}
+
+void UCombatAttackSchedulerSubsystem::PruneAndUpdateStats()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double MaxHoldTime = CVarCombatMaxAttackSlotHoldTime.GetValueOnGameThread();
+
+	// reclaim slots from destroyed attackers or attackers that never released them
+	ActiveAttacks.RemoveAllSwap([Now, MaxHoldTime](const FCombatActiveAttack& Active)
+	{
+		return !Active.Attacker.IsValid() || (Now - Active.GrantTime) > MaxHoldTime;
+	}, EAllowShrinking::No);
+
+	PendingAttacks.RemoveAll([](const FCombatPendingAttack& Pending) { return !Pending.Attacker.IsValid(); });
+
+	// publish the stats
+	SET_DWORD_STAT(STAT_CombatAttackQueueDepth, PendingAttacks.Num());
+	SET_DWORD_STAT(STAT_CombatActiveAttackers, ActiveAttacks.Num());
+	SET_FLOAT_STAT(STAT_CombatAttackAvgWait, NumGranted > 0 ? (TotalWaitTime / NumGranted) * 1000.0 : 0.0);
+
+	TRACE_COUNTER_SET(CombatAttackQueueDepth, PendingAttacks.Num());
+	TRACE_COUNTER_SET(CombatActiveAttackers, ActiveAttacks.Num());
+}
+
+void UCombatAttackSchedulerSubsystem::LogStats() const
+{
+	UE_LOG(LogCombatAttackScheduler, Log, TEXT("Attack scheduler: %d queued, %d active, %d granted, avg wait %.1f ms, max wait %.1f ms"),
+		PendingAttacks.Num(),
+		ActiveAttacks.Num(),
+		NumGranted,
+		NumGranted > 0 ? (TotalWaitTime / NumGranted) * 1000.0 : 0.0,
+		MaxWaitTime * 1000.0);
+}
@@ -0,0 +1,117 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatAttackSchedulerSubsystem.generated.h"
+
+class ACombatEnemy;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatAttackScheduler, Log, All);
+
+/**
+ *  Attack types the scheduler can start on an enemy
+ */
+enum class ECombatScheduledAttack : uint8
+{
+	Combo,
+	Charged
+};
+
+/**
+ *  Attack waiting for a slot
+ */
+struct FCombatPendingAttack
+{
+	/** Enemy that wants to attack */
+	TWeakObjectPtr<ACombatEnemy> Attacker;
+
+	/** Actor being attacked */
+	TWeakObjectPtr<AActor> Target;
+
+	/** Attack to start once the slot is granted */
+	ECombatScheduledAttack Type = ECombatScheduledAttack::Combo;
+
+	/** World time at which the slot was requested */
+	double RequestTime = 0.0;
+};
+
+/**
+ *  Attack holding a slot
+ */
+struct FCombatActiveAttack
+{
+	/** Enemy that is attacking */
+	TWeakObjectPtr<ACombatEnemy> Attacker;
+
+	/** Actor being attacked */
+	TWeakObjectPtr<AActor> Target;
+
+	/** World time at which the slot was granted */
+	double GrantTime = 0.0;
+};
+
+/**
+ *  Hands out attack slots to AI enemies.
+ *  - Caps the number of enemies attacking the same target at the same time
+ *  - Caps the number of attacks starting on the same frame, so montages, attack traces and damage events are spread out
+ *  Requests over budget are queued in order and granted as slots free up.
+ *  Limits are controlled through the Combat.AttackScheduler.* console variables.
+ *  Queue depth, active attackers and wait time are published to the SideScroll stat group and to Insights counters.
+ */
+UCLASS()
+class UCombatAttackSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Attacks waiting for a slot, in request order */
+	TArray<FCombatPendingAttack> PendingAttacks;
+
+	/** Attacks currently holding a slot */
+	TArray<FCombatActiveAttack> ActiveAttacks;
+
+	/** Frame in which attacks were last started, and how many */
+	uint64 LastStartFrame = 0;
+	int32 StartsThisFrame = 0;
+
+	/** Wait time stats */
+	double TotalWaitTime = 0.0;
+	double MaxWaitTime = 0.0;
+	int32 NumGranted = 0;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Grants queued attacks as slots free up */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat id for the tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Requests an attack slot. The attack starts right away if a slot is free, otherwise it's queued */
+	void RequestAttack(ACombatEnemy* Attacker, AActor* Target, ECombatScheduledAttack Type);
+
+	/** Frees the attacker's slot, or removes it from the queue */
+	void ReleaseAttack(ACombatEnemy* Attacker);
+
+	/** Logs the scheduler stats */
+	void LogStats() const;
+
+protected:
+
+	/** Returns true if an attack on the target can start this frame */
+	bool CanStartAttack(const AActor* Target);
+
+	/** Grants the slot and starts the attack on the enemy */
+	void StartAttack(ACombatEnemy* Attacker, AActor* Target, ECombatScheduledAttack Type, double RequestTime);
+
+	/** Removes stale attacks and publishes the stats */
+	void PruneAndUpdateStats();
+};
@@ -2,6 +2,7 @@
 
 
 #include "CombatCharacter.h"
+#include "mySideScroll.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/WidgetComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -12,12 +13,125 @@
 #include "EnhancedInputComponent.h"
 #include "CombatLifeBar.h"
 #include "Engine/DamageEvents.h"
-#include "TimerManager.h"
 #include "Engine/LocalPlayer.h"
 #include "CombatPlayerController.h"
+#include "CombatRagdollSubsystem.h"
+#include "CombatCheckpointSubsystem.h"
+#include "CombatLagCompensationSubsystem.h"
+#include "InputLatencyTracker.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/CoreNet.h"
 
 DEFINE_LOG_CATEGORY(LogCombatCharacter);
 
+static TAutoConsoleVariable<bool> CVarCombatRecyclePawnOnRespawn(
+	TEXT("Combat.Respawn.RecyclePawn"),
+	true,
+	TEXT("If true, the player character is reset in place when respawning instead of being destroyed and re-spawned."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarCombatRestoreCheckpointOnRespawn(
+	TEXT("Combat.Checkpoint.RestoreOnRespawn"),
+	false,
+	TEXT("If true, the world state captured at the last checkpoint is restored when the player respawns."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatMeleeMinTraceInterval(
+	TEXT("Combat.Melee.MinTraceInterval"),
+	0.1f,
+	TEXT("Minimum time in seconds between melee traces the server accepts from a remote player."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatMeleeAttackGraceTime(
+	TEXT("Combat.Melee.AttackGraceTime"),
+	0.25f,
+	TEXT("Time in seconds after an attack ends during which the server still accepts its melee traces from a remote player."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld CCmdCombatCheckpointRestart(
+	TEXT("Combat.Checkpoint.Restart"),
+	TEXT("Restores the last checkpoint snapshot and respawns the player at the checkpoint."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+
+		if (ACombatCharacter* PlayerCharacter = PC ? Cast<ACombatCharacter>(PC->GetPawn()) : nullptr)
+		{
+			if (UCombatCheckpointSubsystem* CheckpointSubsystem = World->GetSubsystem<UCombatCheckpointSubsystem>())
+			{
+				CheckpointSubsystem->RestoreSnapshot();
+			}
+
+			PlayerCharacter->RespawnCharacter();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CCmdCombatInputStats(
+	TEXT("Combat.Input.Stats"),
+	TEXT("Logs how many attack inputs the player character buffered, used and dropped."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+
+		if (ACombatCharacter* PlayerCharacter = PC ? Cast<ACombatCharacter>(PC->GetPawn()) : nullptr)
+		{
+			PlayerCharacter->LogInputBufferStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs CCmdCombatRespawnBenchmark(
+	TEXT("Combat.Respawn.Benchmark"),
+	TEXT("Kills and respawns the player character N times (default 100) and logs the respawn cost.\n")
+	TEXT("Toggle Combat.Respawn.RecyclePawn to compare in-place respawns against destroy and re-spawn."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+
+		APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+
+		double TotalTime = 0.0;
+		double MaxTime = 0.0;
+		int32 Completed = 0;
+
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			ACombatCharacter* PlayerCharacter = PC ? Cast<ACombatCharacter>(PC->GetPawn()) : nullptr;
+
+			if (!PlayerCharacter)
+			{
+				break;
+			}
+
+			// kill the character, then respawn it right away instead of waiting for the timer
+			PlayerCharacter->HandleDeath();
+
+			const double StartTime = FPlatformTime::Seconds();
+
+			PlayerCharacter->RespawnCharacter();
+
+			const double RespawnTime = FPlatformTime::Seconds() - StartTime;
+
+			TotalTime += RespawnTime;
+			MaxTime = FMath::Max(MaxTime, RespawnTime);
+			++Completed;
+		}
+
+		if (Completed == 0)
+		{
+			UE_LOG(LogCombatCharacter, Warning, TEXT("Respawn benchmark needs a possessed combat player character"));
+			return;
+		}
+
+		UE_LOG(LogCombatCharacter, Log, TEXT("Respawn benchmark (%s): %d respawns, avg %.3f ms, max %.3f ms"),
+			CVarCombatRecyclePawnOnRespawn.GetValueOnGameThread() ? TEXT("recycle") : TEXT("destroy and spawn"),
+			Completed,
+			(TotalTime / Completed) * 1000.0,
+			MaxTime * 1000.0);
+	}));
+
 ACombatCharacter::ACombatCharacter()
 {
 	PrimaryActorTick.bCanEverTick = true;
@@ -51,6 +165,9 @@ ACombatCharacter::ACombatCharacter()
 
 	// set the player tag
 	Tags.Add(FName("Player"));
+
+	// record the head and right hand for lag compensation by default
+	LagCompensatedBones = { FName("head"), FName("hand_r") };
 }
 
 void ACombatCharacter::Move(const FInputActionValue& Value)
@@ -120,15 +237,28 @@ void ACombatCharacter::DoLook(float Yaw, float Pitch)
 
 void ACombatCharacter::DoComboAttackStart()
 {
+	// let the server run the same attack, so it knows when to accept our traces
+	if (IsLocallyControlled() && !HasAuthority())
+	{
+		ServerComboAttackStart();
+	}
+
 	// are we already playing an attack animation?
 	if (bIsAttacking)
 	{
-		// cache the input time so we can check it later
-		CachedAttackInputTime = GetWorld()->GetTimeSeconds();
+		// buffer the input so we can check it later
+		AttackInputBuffer.Record(ECombatInputAction::ComboAttack, GetWorld()->GetTimeSeconds(), GFrameCounter);
 
 		return;
 	}
 
+	// start measuring the attack input latency. Buffered inputs are delayed on purpose, so they're not measured.
+	// The server also runs this for remote players' inputs, which aren't ours to measure
+	if (IsLocallyControlled())
+	{
+		FInputLatencyTracker::BeginAction(EInputLatencyAction::Attack);
+	}
+
 	// perform a combo attack
 	ComboAttack();
 }
@@ -140,13 +270,19 @@ void ACombatCharacter::DoComboAttackEnd()
 
 void ACombatCharacter::DoChargedAttackStart()
 {
+	// let the server run the same attack, so it knows when to accept our traces
+	if (IsLocallyControlled() && !HasAuthority())
+	{
+		ServerChargedAttackStart();
+	}
+
 	// raise the charging attack flag
 	bIsChargingAttack = true;
 
 	if (bIsAttacking)
 	{
-		// cache the input time so we can check it later
-		CachedAttackInputTime = GetWorld()->GetTimeSeconds();
+		// buffer the input so we can check it later
+		AttackInputBuffer.Record(ECombatInputAction::ChargedAttack, GetWorld()->GetTimeSeconds(), GFrameCounter);
 
 		return;
 	}
@@ -156,6 +292,11 @@ void ACombatCharacter::DoChargedAttackStart()
 
 void ACombatCharacter::DoChargedAttackEnd()
 {
+	if (IsLocallyControlled() && !HasAuthority())
+	{
+		ServerChargedAttackEnd();
+	}
+
 	// lower the charging attack flag
 	bIsChargingAttack = false;
 
@@ -184,6 +325,8 @@ void ACombatCharacter::ComboAttack()
 	ComboCount = 0;
 
 	// play the attack montage
+	bool bMontagePlaying = false;
+
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
 		const float MontageLength = AnimInstance->Montage_Play(ComboAttackMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
@@ -191,11 +334,29 @@ void ACombatCharacter::ComboAttack()
 		// subscribe to montage completed and interrupted events
 		if (MontageLength > 0.0f)
 		{
+			bMontagePlaying = true;
+
+			if (IsLocallyControlled())
+			{
+				FInputLatencyTracker::EndAction(EInputLatencyAction::Attack);
+			}
+
 			// set the end delegate for the montage
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ComboAttackMontage);
+
+			// play the attack on the other clients
+			if (HasAuthority())
+			{
+				MulticastAttackMontage(ComboAttackMontage, NAME_None);
+			}
 		}
 	}
 
+	// drop the sample if the montage couldn't play
+	if (!bMontagePlaying && IsLocallyControlled())
+	{
+		FInputLatencyTracker::CancelAction(EInputLatencyAction::Attack);
+	}
 }
 
 void ACombatCharacter::ChargedAttack()
@@ -216,6 +377,12 @@ void ACombatCharacter::ChargedAttack()
 		{
 			// set the end delegate for the montage
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ChargedAttackMontage);
+
+			// play the attack on the other clients
+			if (HasAuthority())
+			{
+				MulticastAttackMontage(ChargedAttackMontage, NAME_None);
+			}
 		}
 	}
 }
@@ -224,12 +391,19 @@ void ACombatCharacter::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupt
 {
 	// reset the attacking flag
 	bIsAttacking = false;
+	LastAttackEndTime = GetWorld()->GetTimeSeconds();
+
+	// check if we have a non-stale buffered input
+	ECombatInputAction BufferedAction = ECombatInputAction::ComboAttack;
+	const bool bHasBufferedInput = AttackInputBuffer.Consume(GetWorld()->GetTimeSeconds(), GFrameCounter, AttackInputCacheTimeTolerance, &BufferedAction);
 
-	// check if we have a non-stale cached input
-	if (GetWorld()->GetTimeSeconds() - CachedAttackInputTime <= AttackInputCacheTimeTolerance)
+	// any other inputs buffered during this attack are no longer relevant
+	AttackInputBuffer.ExpirePending();
+
+	if (bHasBufferedInput)
 	{
-		// are we holding the charged attack button?
-		if (bIsChargingAttack)
+		// replay the attack that was buffered
+		if (BufferedAction == ECombatInputAction::ChargedAttack)
 		{
 			// do a charged attack
 			ChargedAttack();
@@ -244,8 +418,16 @@ void ACombatCharacter::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupt
 
 void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 {
-	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	SIDESCROLL_SCOPE(CombatPlayerAttackTrace);
+
+	// attacks by remote players are traced by their client and validated through the server RPC
+	if (IsPlayerControlled() && !IsLocallyControlled())
+	{
+		return;
+	}
+
+	// only count the traces that actually sweep, so remote attacks aren't counted on both machines
+	SideScrollCounters::AddAttackTrace();
 
 	// start at the provided socket location, sweep forward
 	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
@@ -256,6 +438,23 @@ void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
 	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
 
+	// clients only predict the hit effects, the server decides who actually gets hit
+	if (GetNetMode() == NM_Client)
+	{
+		MeleeSweep(TraceStart, TraceEnd, ObjectParams, false);
+
+		ServerDoAttackTrace(TraceStart, GetActorForwardVector());
+		return;
+	}
+
+	MeleeSweep(TraceStart, TraceEnd, ObjectParams, true);
+}
+
+void ACombatCharacter::MeleeSweep(const FVector& TraceStart, const FVector& TraceEnd, const FCollisionObjectQueryParams& ObjectParams, bool bApplyDamage)
+{
+	// sweep for objects in front of the character to be hit by the attack
+	TArray<FHitResult> OutHits;
+
 	// use a sphere shape for the sweep
 	FCollisionShape CollisionShape;
 	CollisionShape.SetSphere(MeleeTraceRadius);
@@ -274,30 +473,184 @@ void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 
 			if (Damageable)
 			{
-				// knock upwards and away from the impact normal
-				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+				if (bApplyDamage)
+				{
+					// knock upwards and away from the impact normal
+					const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
 
-				// pass the damage event to the actor
-				Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+					// pass the damage event to the actor
+					Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+				}
 
 				// call the BP handler to play effects, etc.
-				DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
+				if (IsLocallyControlled())
+				{
+					DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
+				}
 			}
 		}
 	}
 }
 
+void ACombatCharacter::ServerDoAttackTrace_Implementation(FVector_NetQuantize10 TraceStart, FVector_NetQuantizeNormal TraceDirection)
+{
+	SIDESCROLL_SCOPE(CombatServerAttackTrace);
+
+	const FVector TraceEnd = TraceStart + (TraceDirection.GetSafeNormal() * MeleeTraceDistance);
+
+	// reject traces from the dead, outside of an attack we're running for the client, or faster than attacks can swing
+	const bool bValidAttack = CurrentHP > 0.0f && CanAcceptAttackTrace();
+
+	if (bValidAttack)
+	{
+		LastAttackTraceTime = GetWorld()->GetTimeSeconds();
+	}
+
+	UCombatLagCompensationSubsystem* LagCompensation = UCombatLagCompensationSubsystem::Get(this);
+
+	// no history to rewind, so check against the current positions
+	if (!LagCompensation)
+	{
+		if (!bValidAttack)
+		{
+			UE_LOG(LogCombatCharacter, Verbose, TEXT("Rejected melee request from %s"), *GetName());
+			return;
+		}
+
+		FCollisionObjectQueryParams ObjectParams;
+		ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+		ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+		MeleeSweep(TraceStart, TraceEnd, ObjectParams, true);
+		return;
+	}
+
+	// measure the request's size on the wire for the bandwidth report
+	FNetBitWriter PayloadWriter(nullptr, 256);
+	bool bSerialized = false;
+	TraceStart.NetSerialize(PayloadWriter, nullptr, bSerialized);
+	TraceDirection.NetSerialize(PayloadWriter, nullptr, bSerialized);
+
+	// also reject attacks from too far away from where we think the attacker is
+	const bool bAccepted = bValidAttack && LagCompensation->IsValidAttackStart(this, TraceStart);
+
+	LagCompensation->AddAttackRequest(PayloadWriter.GetNumBits(), bAccepted);
+
+	if (!bAccepted)
+	{
+		UE_LOG(LogCombatCharacter, Verbose, TEXT("Rejected melee request from %s"), *GetName());
+		return;
+	}
+
+	// sweep the characters as they were when the attacker saw them
+	TArray<FCombatLagCompensationHit> RewoundHits;
+	LagCompensation->SweepRewound(this, LagCompensation->GetViewTime(GetController<APlayerController>()), TraceStart, TraceEnd, MeleeTraceRadius, RewoundHits);
+
+	for (const FCombatLagCompensationHit& CurrentHit : RewoundHits)
+	{
+		// players don't damage each other in co-op
+		if (CurrentHit.Character->ActorHasTag(FName("Player")))
+		{
+			continue;
+		}
+
+		if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.Character))
+		{
+			// knock upwards and away from the impact normal
+			const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+
+			Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+		}
+	}
+
+	// props aren't recorded, check them against their current positions
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+	MeleeSweep(TraceStart, TraceEnd, ObjectParams, true);
+}
+
+bool ACombatCharacter::CanAcceptAttackTrace() const
+{
+	const double TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	// the trace notify can arrive just after the attack ended here
+	const bool bAttackInProgress = bIsAttacking || (TimeSeconds - LastAttackEndTime) <= CVarCombatMeleeAttackGraceTime.GetValueOnGameThread();
+
+	return bAttackInProgress && (TimeSeconds - LastAttackTraceTime) >= CVarCombatMeleeMinTraceInterval.GetValueOnGameThread();
+}
+
+void ACombatCharacter::ServerComboAttackStart_Implementation()
+{
+	DoComboAttackStart();
+}
+
+void ACombatCharacter::ServerChargedAttackStart_Implementation()
+{
+	DoChargedAttackStart();
+}
+
+void ACombatCharacter::ServerChargedAttackEnd_Implementation()
+{
+	DoChargedAttackEnd();
+}
+
+void ACombatCharacter::MulticastAttackMontage_Implementation(UAnimMontage* Montage, FName SectionName)
+{
+	// the server and the owning client already played it
+	if (GetLocalRole() != ROLE_SimulatedProxy)
+	{
+		return;
+	}
+
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		// start the montage if we missed its start
+		if (!AnimInstance->Montage_IsPlaying(Montage))
+		{
+			AnimInstance->Montage_Play(Montage);
+		}
+
+		if (!SectionName.IsNone())
+		{
+			AnimInstance->Montage_JumpToSection(SectionName, Montage);
+		}
+	}
+}
+
+void ACombatCharacter::OnRep_CurrentHP(float OldHP)
+{
+	// the life bar may not exist yet on the first update
+	if (LifeBarWidget)
+	{
+		LifeBarWidget->SetLifePercentage(FMath::Max(CurrentHP, 0.0f) / MaxHP);
+	}
+
+	// a character that was already dead when it replicated dies in BeginPlay
+	if (!HasActorBegunPlay())
+	{
+		return;
+	}
+
+	if (OldHP > 0.0f && CurrentHP <= 0.0f)
+	{
+		HandleDeath();
+
+	} else if (OldHP <= 0.0f && CurrentHP > 0.0f) {
+
+		// the server respawned us in place
+		RestoreFromDeath();
+	}
+}
+
 void ACombatCharacter::CheckCombo()
 {
 	// are we playing a non-charge attack animation?
 	if (bIsAttacking && !bIsChargingAttack)
 	{
-		// is the last attack input not stale?
-		if (GetWorld()->GetTimeSeconds() - CachedAttackInputTime <= ComboInputCacheTimeTolerance)
+		// consume the oldest non-stale attack input so we don't accidentally trigger it twice
+		if (AttackInputBuffer.Consume(GetWorld()->GetTimeSeconds(), GFrameCounter, ComboInputCacheTimeTolerance))
 		{
-			// consume the attack input so we don't accidentally trigger it twice
-			CachedAttackInputTime = 0.0f;
-
 			// increase the combo counter
 			++ComboCount;
 
@@ -309,6 +662,11 @@ void ACombatCharacter::CheckCombo()
 				{
 					AnimInstance->Montage_JumpToSection(ComboSectionNames[ComboCount], ComboAttackMontage);
 				}
+
+				if (HasAuthority())
+				{
+					MulticastAttackMontage(ComboAttackMontage, ComboSectionNames[ComboCount]);
+				}
 			}
 		}
 	}
@@ -316,18 +674,34 @@ void ACombatCharacter::CheckCombo()
 
 void ACombatCharacter::CheckChargedAttack()
 {
+	// other players' characters don't know whether the button is held, so they follow the server's sections
+	if (GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		return;
+	}
+
 	// raise the looped charged attack flag
 	bHasLoopedChargedAttack = true;
 
 	// jump to either the loop or the attack section depending on whether we're still holding the charge button
+	const FName SectionName = bIsChargingAttack ? ChargeLoopSection : ChargeAttackSection;
+
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
-		AnimInstance->Montage_JumpToSection(bIsChargingAttack ? ChargeLoopSection : ChargeAttackSection, ChargedAttackMontage);
+		AnimInstance->Montage_JumpToSection(SectionName, ChargedAttackMontage);
+	}
+
+	if (HasAuthority())
+	{
+		MulticastAttackMontage(ChargedAttackMontage, SectionName);
 	}
 }
 
 void ACombatCharacter::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
+	SIDESCROLL_SCOPE(CombatPlayerApplyDamage);
+	SideScrollCounters::AddDamageEvent();
+
 	// pass the damage event to the actor
 	FDamageEvent DamageEvent;
 	const float ActualDamage = TakeDamage(Damage, DamageEvent, nullptr, DamageCauser);
@@ -356,8 +730,21 @@ void ACombatCharacter::HandleDeath()
 	// disable movement while we're dead
 	GetCharacterMovement()->DisableMovement();
 
-	// enable full ragdoll physics
-	GetMesh()->SetSimulatePhysics(true);
+	// enable full ragdoll physics if the ragdoll budget allows it
+	UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>();
+
+	if (!RagdollSubsystem)
+	{
+		GetMesh()->SetSimulatePhysics(true);
+
+	} else if (!RagdollSubsystem->RequestRagdoll(GetMesh())) {
+
+		// over budget, so play the cheap canned death instead
+		if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+		{
+			AnimInstance->Montage_Play(DeathMontage);
+		}
+	}
 
 	// hide the life bar
 	LifeBar->SetHiddenInGame(true);
@@ -365,8 +752,17 @@ void ACombatCharacter::HandleDeath()
 	// pull back the camera
 	GetCameraBoom()->TargetArmLength = DeathCameraDistance;
 
+	// clients only play the death, the server respawns us
+	if (!HasAuthority())
+	{
+		return;
+	}
+
 	// schedule respawning
-	GetWorld()->GetTimerManager().SetTimer(RespawnTimer, this, &ACombatCharacter::RespawnCharacter, RespawnTime, false);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->SetTimer(RespawnTimer, this, &ACombatCharacter::RespawnCharacter, RespawnTime);
+	}
 }
 
 void ACombatCharacter::ApplyHealing(float Healing, AActor* Healer)
@@ -376,10 +772,104 @@ void ACombatCharacter::ApplyHealing(float Healing, AActor* Healer)
 
 void ACombatCharacter::RespawnCharacter()
 {
+	// restart the encounter from the last checkpoint
+	if (CVarCombatRestoreCheckpointOnRespawn.GetValueOnGameThread())
+	{
+		if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+		{
+			CheckpointSubsystem->RestoreSnapshot();
+		}
+	}
+
+	// reset the character in place if we're controlled by a combat player controller
+	ACombatPlayerController* PC = Cast<ACombatPlayerController>(GetController());
+
+	if (PC && CVarCombatRecyclePawnOnRespawn.GetValueOnGameThread())
+	{
+		ResetForRespawn(PC->GetRespawnTransform());
+		return;
+	}
+
 	// destroy the character and let it be respawned by the Player Controller
 	Destroy();
 }
 
+void ACombatCharacter::ResetForRespawn(const FTransform& RespawnTransform)
+{
+	// clear the respawn timer in case we were reset early
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(RespawnTimer);
+	}
+
+	// undo the ragdoll, montages and camera of the death
+	RestoreFromDeath();
+
+	// teleport to the respawn transform
+	SetActorLocationAndRotation(RespawnTransform.GetLocation(), RespawnTransform.GetRotation(), false, nullptr, ETeleportType::ResetPhysics);
+
+	if (Controller)
+	{
+		Controller->SetControlRotation(RespawnTransform.Rotator());
+	}
+
+	// reset HP to maximum
+	ResetHP();
+}
+
+void ACombatCharacter::RestoreFromDeath()
+{
+	// stop any ragdoll or frozen pose and give back the ragdoll budget
+	if (UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>())
+	{
+		RagdollSubsystem->ResetMesh(GetMesh(), MeshStartingCollision);
+
+	} else {
+
+		GetMesh()->SetSimulatePhysics(false);
+		GetMesh()->SetPhysicsBlendWeight(0.0f);
+	}
+
+	// reattach the mesh and reset it to its starting transform
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(MeshStartingTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	// stop any attack or death montages
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.0f);
+	}
+
+	// reset the attack state
+	bIsAttacking = false;
+	bIsChargingAttack = false;
+	bHasLoopedChargedAttack = false;
+	ComboCount = 0;
+	AttackInputBuffer.Reset();
+
+	// re-enable movement
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+	// restore the camera and life bar
+	GetCameraBoom()->TargetArmLength = DefaultCameraDistance;
+	LifeBar->SetHiddenInGame(false);
+}
+
+void ACombatCharacter::LogInputBufferStats() const
+{
+	const uint64 NumRecorded = AttackInputBuffer.GetNumRecorded();
+	const uint64 NumDropped = AttackInputBuffer.GetNumDropped();
+
+	UE_LOG(LogCombatCharacter, Log, TEXT("%s attack input buffer: %llu buffered, %llu used, %llu overwritten, %llu expired (%.1f%% dropped)"),
+		*GetName(),
+		NumRecorded,
+		AttackInputBuffer.GetNumConsumed(),
+		AttackInputBuffer.GetNumOverwritten(),
+		AttackInputBuffer.GetNumExpired(),
+		NumRecorded > 0 ? (100.0 * NumDropped) / NumRecorded : 0.0);
+}
+
 float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
 	// only process damage if the character is still alive
@@ -402,9 +892,11 @@ float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& Dama
 		// update the life bar
 		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
 
-		// enable partial ragdoll physics, but keep the pelvis vertical
-		GetMesh()->SetPhysicsBlendWeight(0.5f);
-		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		// enable partial ragdoll physics if the ragdoll budget allows it
+		if (UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>())
+		{
+			RagdollSubsystem->RequestHitReaction(GetMesh(), PelvisBoneName);
+		}
 	}
 
 	// return the received damage amount
@@ -418,11 +910,21 @@ void ACombatCharacter::Landed(const FHitResult& Hit)
 	// is the character still alive?
 	if (CurrentHP >= 0.0f)
 	{
-		// disable ragdoll physics
-		GetMesh()->SetPhysicsBlendWeight(0.0f);
+		// disable ragdoll physics and free up the hit reaction budget
+		if (UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>())
+		{
+			RagdollSubsystem->EndHitReaction(GetMesh());
+		}
 	}
 }
 
+void ACombatCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ACombatCharacter, CurrentHP);
+}
+
 void ACombatCharacter::BeginPlay()
 {
 	Super::BeginPlay();
@@ -434,22 +936,65 @@ void ACombatCharacter::BeginPlay()
 	// initialize the camera
 	GetCameraBoom()->TargetArmLength = DefaultCameraDistance;
 
-	// save the relative transform for the mesh so we can reset the ragdoll later
+	// save the relative transform and collision for the mesh so we can reset the ragdoll later
 	MeshStartingTransform = GetMesh()->GetRelativeTransform();
+	MeshStartingCollision = GetMesh()->GetCollisionEnabled();
 
 	// set the life bar color
 	LifeBarWidget->SetBarColor(LifeBarColor);
 
-	// reset HP to maximum
-	ResetHP();
+	// reset HP to maximum. Clients take the HP replicated by the server, and play the death if we joined while it was dead
+	if (HasAuthority())
+	{
+		ResetHP();
+
+	} else {
+
+		LifeBarWidget->SetLifePercentage(FMath::Max(CurrentHP, 0.0f) / MaxHP);
+
+		if (CurrentHP <= 0.0f)
+		{
+			HandleDeath();
+		}
+	}
+
+	// let the server rewind us for melee attacks from remote players
+	if (HasAuthority())
+	{
+		if (UCombatLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UCombatLagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterTarget(this, LagCompensatedBones);
+		}
+	}
 }
 
 void ACombatCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	// stop recording our poses
+	if (UCombatLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UCombatLagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterTarget(this);
+	}
+
 	// clear the respawn timer
-	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(RespawnTimer);
+	}
+
+	// report the dropped input metric for this character
+	if (IsPlayerControlled())
+	{
+		LogInputBufferStats();
+	}
+
+	// release any ragdoll budget we're holding
+	if (UCombatRagdollSubsystem* RagdollSubsystem = GetWorld()->GetSubsystem<UCombatRagdollSubsystem>())
+	{
+		RagdollSubsystem->ReleaseMesh(GetMesh());
+	}
 }
 
 void ACombatCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -7,6 +7,9 @@
 #include "CombatAttacker.h"
 #include "CombatDamageable.h"
 #include "Animation/AnimInstance.h"
+#include "CombatInputBuffer.h"
+#include "GameplayTimerSubsystem.h"
+#include "Engine/NetSerialization.h"
 #include "CombatCharacter.generated.h"
 
 class USpringArmComponent;
@@ -74,7 +77,7 @@ protected:
 	float MaxHP = 5.0f;
 
 	/** Current amount of HP the character has */
-	UPROPERTY(VisibleAnywhere, Category="Damage")
+	UPROPERTY(VisibleAnywhere, Category="Damage", ReplicatedUsing=OnRep_CurrentHP)
 	float CurrentHP = 0.0f;
 
 	/** Life bar widget fill color */
@@ -93,12 +96,18 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack", meta = (ClampMin = 0, ClampMax = 5))
 	float AttackInputCacheTimeTolerance = 1.0f;
 
-	/** Time at which an attack button was last pressed */
-	float CachedAttackInputTime = 0.0f;
+	/** Attack inputs received while another attack was playing */
+	TCombatInputBuffer<16> AttackInputBuffer;
 
 	/** If true, the character is currently playing an attack animation */
 	bool bIsAttacking = false;
 
+	/** Time the last attack montage ended. The server still accepts traces from a remote player for a moment after it */
+	double LastAttackEndTime = -UE_DOUBLE_BIG_NUMBER;
+
+	/** Time the server last accepted a melee trace from a remote player */
+	double LastAttackTraceTime = -UE_DOUBLE_BIG_NUMBER;
+
 	/** Distance ahead of the character that melee attack sphere collision traces will extend */
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta=(ClampMin=0, ClampMax=500, Units="cm"))
 	float MeleeTraceDistance = 75.0f;
@@ -107,6 +116,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 0, ClampMax = 200, Units = "cm"))
 	float MeleeTraceRadius = 75.0f;
 
+	/** Bones recorded for lag compensation in networked games, so limbs reaching outside of the capsule can still be hit */
+	UPROPERTY(EditAnywhere, Category="Melee Attack|Network")
+	TArray<FName> LagCompensatedBones;
+
 	/** Amount of damage a melee attack will deal */
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Damage", meta = (ClampMin = 0, ClampMax = 100))
 	float MeleeDamage = 1.0f;
@@ -152,6 +165,10 @@ protected:
 	/** If true, the charged attack hold check has been tested at least once */
 	bool bHasLoopedChargedAttack = false;
 
+	/** AnimMontage that will play on death if the ragdoll budget is exhausted */
+	UPROPERTY(EditAnywhere, Category="Damage")
+	UAnimMontage* DeathMontage;
+
 	/** Camera boom length while the character is dead */
 	UPROPERTY(EditAnywhere, Category="Camera", meta = (ClampMin = 0, ClampMax = 1000, Units = "cm"))
 	float DeathCameraDistance = 400.0f;
@@ -168,11 +185,14 @@ protected:
 	FOnMontageEnded OnAttackMontageEnded;
 
 	/** Character respawn timer */
-	FTimerHandle RespawnTimer;
+	FGameplayTimerHandle RespawnTimer;
 
 	/** Copy of the mesh's transform so we can reset it after ragdoll animations */
 	FTransform MeshStartingTransform;
 
+	/** Copy of the mesh's collision setting so we can reset it after ragdoll animations */
+	TEnumAsByte<ECollisionEnabled::Type> MeshStartingCollision = ECollisionEnabled::QueryOnly;
+
 public:
 	
 	/** Constructor */
@@ -235,6 +255,39 @@ protected:
 	/** Called from a delegate when the attack montage ends */
 	void AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
+	/** Sweeps the melee attack shape for damageable actors. Damage is only applied if requested, effects only play for the local player */
+	void MeleeSweep(const FVector& TraceStart, const FVector& TraceEnd, const FCollisionObjectQueryParams& ObjectParams, bool bApplyDamage);
+
+	/** Asks the server to validate a melee attack traced by a client, rewinding the other characters to what the client saw */
+	UFUNCTION(Server, Reliable)
+	void ServerDoAttackTrace(FVector_NetQuantize10 TraceStart, FVector_NetQuantizeNormal TraceDirection);
+
+	/** Returns true if the server is running an attack for this character that a melee trace could belong to */
+	bool CanAcceptAttackTrace() const;
+
+	/** Forwards a combo attack press from the owning client, so the server runs the same attack */
+	UFUNCTION(Server, Reliable)
+	void ServerComboAttackStart();
+
+	/** Forwards a charged attack press from the owning client, so the server runs the same attack */
+	UFUNCTION(Server, Reliable)
+	void ServerChargedAttackStart();
+
+	/** Forwards a charged attack release from the owning client, so the server runs the same attack */
+	UFUNCTION(Server, Reliable)
+	void ServerChargedAttackEnd();
+
+	/** Plays an attack montage on the other clients, jumping to a section if one is provided */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastAttackMontage(UAnimMontage* Montage, FName SectionName);
+
+	/** Updates the life bar when the server changes our HP, and plays our death and respawn on clients */
+	UFUNCTION()
+	void OnRep_CurrentHP(float OldHP);
+
+	/** Undoes the ragdoll, montages, attack state, camera and movement changes of a death */
+	void RestoreFromDeath();
+
 	
 public:
 
@@ -264,9 +317,15 @@ public:
 
 	// ~end CombatDamageable interface
 
-	/** Called from the respawn timer to destroy and re-create the character */
+	/** Called from the respawn timer to respawn the character, either in place or by destroying and re-creating it */
 	void RespawnCharacter();
 
+	/** Resets the character to a freshly spawned state at the provided transform, without destroying it */
+	void ResetForRespawn(const FTransform& RespawnTransform);
+
+	/** Logs how many attack inputs were buffered, used and dropped */
+	void LogInputBufferStats() const;
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
@@ -287,6 +346,9 @@ protected:
 
 protected:
 
+	/** Sets up the replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** Initialization */
 	virtual void BeginPlay() override;
 
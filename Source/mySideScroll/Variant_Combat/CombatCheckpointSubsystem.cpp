@@ -0,0 +1,122 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatCheckpointSubsystem.h"
+#include "CombatCheckpointable.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY(LogCombatCheckpoint);
+
+bool UCombatCheckpointSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatCheckpointSubsystem::RegisterCheckpointable(AActor* Actor)
+{
+	if (Cast<ICombatCheckpointable>(Actor))
+	{
+		Checkpointables.AddUnique(Actor);
+	}
+}
+
+void UCombatCheckpointSubsystem::UnregisterCheckpointable(AActor* Actor)
+{
+	Checkpointables.RemoveSwap(Actor, EAllowShrinking::No);
+}
+
+void UCombatCheckpointSubsystem::CaptureSnapshot()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	Snapshot.Reset();
+	Records.Reset(Checkpointables.Num());
+
+	FMemoryWriter Writer(Snapshot);
+
+	// write every actor's state back to back
+	for (const TWeakObjectPtr<AActor>& CurrentActor : Checkpointables)
+	{
+		ICombatCheckpointable* Checkpointable = Cast<ICombatCheckpointable>(CurrentActor.Get());
+
+		if (!Checkpointable)
+		{
+			continue;
+		}
+
+		FCombatCheckpointRecord& NewRecord = Records.AddDefaulted_GetRef();
+		NewRecord.Actor = CurrentActor;
+		NewRecord.Offset = Snapshot.Num();
+
+		if (Checkpointable->ShouldRespawnFromCheckpoint())
+		{
+			NewRecord.RespawnClass = CurrentActor->GetClass();
+			NewRecord.RespawnTransform = CurrentActor->GetActorTransform();
+		}
+
+		Checkpointable->SaveCheckpointState(Writer);
+
+		NewRecord.Size = Snapshot.Num() - NewRecord.Offset;
+	}
+
+	UE_LOG(LogCombatCheckpoint, Log, TEXT("Captured checkpoint snapshot: %d actors, %d bytes in %.3f ms"), Records.Num(), Snapshot.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+bool UCombatCheckpointSubsystem::RestoreSnapshot()
+{
+	if (!HasSnapshot())
+	{
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	int32 NumRestored = 0;
+	int32 NumRespawned = 0;
+
+	for (FCombatCheckpointRecord& CurrentRecord : Records)
+	{
+		// spawn back actors that were destroyed since the snapshot
+		if (!CurrentRecord.Actor.IsValid() && CurrentRecord.RespawnClass)
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+			CurrentRecord.Actor = GetWorld()->SpawnActor<AActor>(CurrentRecord.RespawnClass, CurrentRecord.RespawnTransform, SpawnParams);
+
+			++NumRespawned;
+		}
+
+		ICombatCheckpointable* Checkpointable = Cast<ICombatCheckpointable>(CurrentRecord.Actor.Get());
+
+		if (!Checkpointable)
+		{
+			continue;
+		}
+
+		// serialize the current state so we can skip actors that haven't changed
+		ScratchBuffer.Reset();
+		FMemoryWriter ScratchWriter(ScratchBuffer);
+		Checkpointable->SaveCheckpointState(ScratchWriter);
+
+		if (ScratchBuffer.Num() == CurrentRecord.Size && FMemory::Memcmp(ScratchBuffer.GetData(), Snapshot.GetData() + CurrentRecord.Offset, CurrentRecord.Size) == 0)
+		{
+			continue;
+		}
+
+		// apply the saved state
+		FMemoryReader Reader(Snapshot);
+		Reader.Seek(CurrentRecord.Offset);
+
+		Checkpointable->RestoreCheckpointState(Reader);
+
+		++NumRestored;
+	}
+
+	UE_LOG(LogCombatCheckpoint, Log, TEXT("Restored checkpoint snapshot: %d of %d actors changed, %d respawned, %.3f ms"), NumRestored, Records.Num(), NumRespawned, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	return true;
+}
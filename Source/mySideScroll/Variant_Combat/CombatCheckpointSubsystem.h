@@ -0,0 +1,81 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatCheckpointSubsystem.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatCheckpoint, Log, All);
+
+/**
+ *  Location of a single actor's state inside the checkpoint snapshot
+ */
+struct FCombatCheckpointRecord
+{
+	/** Actor the state belongs to */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Byte offset of the state in the snapshot */
+	int32 Offset = 0;
+
+	/** Size of the state in bytes */
+	int32 Size = 0;
+
+	/** Class to spawn the actor back from if it's destroyed after the snapshot. Null for actors that aren't respawned */
+	TSubclassOf<AActor> RespawnClass;
+
+	/** Transform to spawn the actor back at */
+	FTransform RespawnTransform;
+};
+
+/**
+ *  Captures the state of every ICombatCheckpointable actor into a compact binary snapshot when a checkpoint is reached,
+ *  and restores it in place so encounters can be restarted without reloading the level.
+ *  Restores only touch actors whose state changed since the snapshot was taken.
+ *  Actors that opt in through ShouldRespawnFromCheckpoint are spawned back if they were destroyed after the snapshot
+ */
+UCLASS()
+class UCombatCheckpointSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Actors that take part in checkpoint snapshots */
+	TArray<TWeakObjectPtr<AActor>> Checkpointables;
+
+	/** Serialized state of every checkpointable actor */
+	TArray<uint8> Snapshot;
+
+	/** Where each actor's state lives in the snapshot */
+	TArray<FCombatCheckpointRecord> Records;
+
+	/** Scratch buffer used to compare the current state against the snapshot */
+	TArray<uint8> ScratchBuffer;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+
+	/** Adds an ICombatCheckpointable actor to the snapshots */
+	void RegisterCheckpointable(AActor* Actor);
+
+	/** Removes an actor from the snapshots */
+	void UnregisterCheckpointable(AActor* Actor);
+
+	/** Saves the current state of every checkpointable actor */
+	void CaptureSnapshot();
+
+	/** Restores the last captured snapshot. Returns false if no snapshot has been captured */
+	bool RestoreSnapshot();
+
+	/** Returns true if a snapshot has been captured */
+	bool HasSnapshot() const { return Records.Num() > 0; }
+
+	/** Returns the size of the current snapshot in bytes */
+	int32 GetSnapshotSize() const { return Snapshot.Num(); }
+};
@@ -4,6 +4,13 @@
 #include "CombatCheckpointVolume.h"
 #include "CombatCharacter.h"
 #include "CombatPlayerController.h"
+#include "ActorRegistrySubsystem.h"
+#include "CombatCheckpointSubsystem.h"
+#include "ProgressSaveSubsystem.h"
+#include "CombatCollision.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
 
 ACombatCheckpointVolume::ACombatCheckpointVolume()
 {
@@ -14,13 +21,35 @@ ACombatCheckpointVolume::ACombatCheckpointVolume()
 	// set the box's extent
 	Box->SetBoxExtent(FVector(500.0f, 500.0f, 500.0f));
 
-	// set the default collision profile to overlap all dynamic
-	Box->SetCollisionProfileName(FName("OverlapAllDynamic"));
+	// only overlap player pawns, so ragdolls, props and enemies don't generate overlap events
+	Box->SetCollisionProfileName(CombatCollision::PlayerTriggerProfile);
 
 	// bind the begin overlap 
 	Box->OnComponentBeginOverlap.AddDynamic(this, &ACombatCheckpointVolume::OnOverlap);
 }
 
+void ACombatCheckpointVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// register with the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(this, EActorRegistryCategory::Checkpoint);
+	}
+}
+
+void ACombatCheckpointVolume::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// unregister from the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(this, EActorRegistryCategory::Checkpoint);
+	}
+}
+
 void ACombatCheckpointVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	// ensure we use this only once
@@ -41,6 +70,18 @@ void ACombatCheckpointVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent
 
 			// update the player's respawn checkpoint
 			PC->SetRespawnTransform(PlayerCharacter->GetActorTransform());
+
+			// snapshot the world state so the encounter can be restarted from here
+			if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+			{
+				CheckpointSubsystem->CaptureSnapshot();
+			}
+
+			// save the checkpoint to the player's progress
+			if (UProgressSaveSubsystem* ProgressSave = GetGameInstance()->GetSubsystem<UProgressSaveSubsystem>())
+			{
+				ProgressSave->MarkCheckpointReached(FName(UGameplayStatics::GetCurrentLevelName(this, true)), GetFName());
+			}
 		}
 
 	}
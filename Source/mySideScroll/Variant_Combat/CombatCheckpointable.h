@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "CombatCheckpointable.generated.h"
+
+/**
+ *  Checkpointable Interface
+ *  Allows actors to save their gameplay state into a checkpoint snapshot and restore it in place
+ */
+UINTERFACE(MinimalAPI, NotBlueprintable)
+class UCombatCheckpointable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+class ICombatCheckpointable
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Writes the actor's current gameplay state to the archive */
+	virtual void SaveCheckpointState(FArchive& Ar) = 0;
+
+	/** Reads a previously saved gameplay state from the archive and applies it to the actor */
+	virtual void RestoreCheckpointState(FArchive& Ar) = 0;
+
+	/** If true, the actor is spawned back at its saved transform when it was destroyed after the snapshot */
+	virtual bool ShouldRespawnFromCheckpoint() const { return false; }
+
+protected:
+
+	/** Serializes up to eight flags packed as bits into a single byte */
+	static void SerializeCheckpointFlags(FArchive& Ar, std::initializer_list<bool*> Flags)
+	{
+		check(Flags.size() <= 8);
+
+		uint8 PackedFlags = 0;
+
+		if (Ar.IsSaving())
+		{
+			int32 Bit = 0;
+
+			for (const bool* Flag : Flags)
+			{
+				PackedFlags |= (*Flag ? 1 : 0) << Bit++;
+			}
+		}
+
+		Ar << PackedFlags;
+
+		if (Ar.IsLoading())
+		{
+			int32 Bit = 0;
+
+			for (bool* Flag : Flags)
+			{
+				*Flag = (PackedFlags >> Bit++) & 1;
+			}
+		}
+	}
+};
@@ -0,0 +1,20 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+/**
+ *  Collision channels and profiles used by the combat variant
+ *  Must be kept in sync with the collision settings in DefaultEngine.ini
+ */
+
+/** Object channel for trigger volumes that only player pawns respond to. Everything else ignores it by default */
+#define ECC_PlayerTrigger ECC_GameTraceChannel2
+
+namespace CombatCollision
+{
+	/** Trigger profile that only overlaps pawns responding to the PlayerTrigger channel */
+	inline const FName PlayerTriggerProfile = FName(TEXT("PlayerTrigger"));
+}
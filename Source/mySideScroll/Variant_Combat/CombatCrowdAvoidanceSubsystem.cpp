@@ -0,0 +1,592 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatCrowdAvoidanceSubsystem.h"
+#include "CombatEnemy.h"
+#include "ActorRegistrySubsystem.h"
+#include "mySideScroll.h"
+#include "AIController.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY(LogCombatAvoidance);
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Avoidance Solve"), STAT_CombatAvoidanceSolve, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Avoidance Agents"), STAT_CombatAvoidanceAgents, STATGROUP_SideScroll);
+
+TRACE_DECLARE_INT_COUNTER(CombatAvoidanceAgents, TEXT("Combat/Avoidance/Agents"));
+
+static TAutoConsoleVariable<bool> CVarCombatAvoidanceEnabled(
+	TEXT("Combat.Avoidance.Enabled"),
+	true,
+	TEXT("If true, combat enemies steer around each other and the player."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatAvoidanceTimeHorizon(
+	TEXT("Combat.Avoidance.TimeHorizon"),
+	1.0f,
+	TEXT("How far ahead in seconds enemies avoid collisions."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatAvoidanceNeighborDistance(
+	TEXT("Combat.Avoidance.NeighborDistance"),
+	300.0f,
+	TEXT("Max distance in cm at which enemies consider each other."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCombatAvoidanceMaxNeighbors(
+	TEXT("Combat.Avoidance.MaxNeighbors"),
+	10,
+	TEXT("Max number of nearest agents each enemy avoids."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatAvoidanceRadiusPadding(
+	TEXT("Combat.Avoidance.RadiusPadding"),
+	10.0f,
+	TEXT("Extra distance in cm added to the capsule radius when avoiding."),
+	ECVF_Default);
+
+static FAutoConsoleCommand CCmdCombatAvoidanceBenchmark(
+	TEXT("Combat.Avoidance.Benchmark"),
+	TEXT("Measures crowd avoidance solve time as the number of agents doubles. Usage: Combat.Avoidance.Benchmark [MaxAgents=800] [Iterations=50]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 MaxAgents = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 800;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 50;
+
+		FCombatAvoidanceSolver Solver;
+
+		for (int32 NumAgents = FMath::Min(25, MaxAgents); NumAgents <= MaxAgents; NumAgents *= 2)
+		{
+			// crowd the agents around a target at a constant density, all moving towards it
+			FRandomStream Random(1234);
+			const float ArenaRadius = FMath::Sqrt(float(NumAgents)) * 100.0f;
+
+			Solver.Reset();
+
+			for (int32 i = 0; i < NumAgents; ++i)
+			{
+				const FVector2f Position = FVector2f(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f)) * ArenaRadius;
+				const FVector2f Preferred = -Position.GetSafeNormal() * 400.0f;
+
+				Solver.AddAgent(Position, Preferred, Preferred, 45.0f, 400.0f);
+			}
+
+			double Serial = 0.0;
+			double Parallel = 0.0;
+
+			for (int32 i = 0; i < Iterations; ++i)
+			{
+				double StartTime = FPlatformTime::Seconds();
+				Solver.Solve(1.0f / 60.0f, false);
+				Serial += FPlatformTime::Seconds() - StartTime;
+
+				StartTime = FPlatformTime::Seconds();
+				Solver.Solve(1.0f / 60.0f, true);
+				Parallel += FPlatformTime::Seconds() - StartTime;
+			}
+
+			UE_LOG(LogCombatAvoidance, Log, TEXT("%4d agents: serial %.3f ms, parallel %.3f ms, %.2f us per agent"), NumAgents, Serial * 1000.0 / Iterations, Parallel * 1000.0 / Iterations, Parallel * 1000000.0 / (Iterations * NumAgents));
+		}
+	}));
+
+namespace CombatAvoidance
+{
+	/** Half plane of permitted velocities, to the left of the direction */
+	struct FLine
+	{
+		FVector2f Point;
+		FVector2f Direction;
+	};
+
+	using FLineArray = TArray<FLine, TInlineAllocator<16>>;
+
+	static constexpr float Epsilon = 0.00001f;
+
+	/** 2D cross product */
+	static float Det(const FVector2f& A, const FVector2f& B)
+	{
+		return A.X * B.Y - A.Y * B.X;
+	}
+
+	/** Returns the cell coordinates packed in a key */
+	static uint64 GetCellKey(int32 X, int32 Y)
+	{
+		return (uint64(uint32(X)) << 32) | uint64(uint32(Y));
+	}
+
+	/** Optimizes along a single line, constrained by the lines before it. Returns false if infeasible */
+	static bool LinearProgram1(const FLineArray& Lines, int32 LineNo, float Radius, const FVector2f& OptVelocity, bool bDirectionOpt, FVector2f& Result)
+	{
+		const FLine& Line = Lines[LineNo];
+
+		const float DotProduct = Line.Point | Line.Direction;
+		const float Discriminant = FMath::Square(DotProduct) + FMath::Square(Radius) - Line.Point.SizeSquared();
+
+		// the max speed circle fully invalidates the line
+		if (Discriminant < 0.0f)
+		{
+			return false;
+		}
+
+		const float SqrtDiscriminant = FMath::Sqrt(Discriminant);
+		float TLeft = -DotProduct - SqrtDiscriminant;
+		float TRight = -DotProduct + SqrtDiscriminant;
+
+		for (int32 i = 0; i < LineNo; ++i)
+		{
+			const float Denominator = Det(Line.Direction, Lines[i].Direction);
+			const float Numerator = Det(Lines[i].Direction, Line.Point - Lines[i].Point);
+
+			// parallel lines
+			if (FMath::Abs(Denominator) <= Epsilon)
+			{
+				if (Numerator < 0.0f)
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			const float T = Numerator / Denominator;
+
+			if (Denominator >= 0.0f)
+			{
+				TRight = FMath::Min(TRight, T);
+			}
+			else
+			{
+				TLeft = FMath::Max(TLeft, T);
+			}
+
+			if (TLeft > TRight)
+			{
+				return false;
+			}
+		}
+
+		if (bDirectionOpt)
+		{
+			// take the extreme point in the optimization direction
+			Result = Line.Point + Line.Direction * ((OptVelocity | Line.Direction) > 0.0f ? TRight : TLeft);
+		}
+		else
+		{
+			// take the closest point to the optimization velocity
+			const float T = Line.Direction | (OptVelocity - Line.Point);
+			Result = Line.Point + Line.Direction * FMath::Clamp(T, TLeft, TRight);
+		}
+
+		return true;
+	}
+
+	/** Finds the velocity closest to the optimization velocity that satisfies all lines. Returns the index of the first failed line, or the number of lines on success */
+	static int32 LinearProgram2(const FLineArray& Lines, float Radius, const FVector2f& OptVelocity, bool bDirectionOpt, FVector2f& Result)
+	{
+		if (bDirectionOpt)
+		{
+			Result = OptVelocity * Radius;
+		}
+		else if (OptVelocity.SizeSquared() > FMath::Square(Radius))
+		{
+			Result = OptVelocity.GetSafeNormal() * Radius;
+		}
+		else
+		{
+			Result = OptVelocity;
+		}
+
+		for (int32 i = 0; i < Lines.Num(); ++i)
+		{
+			// does the result violate this line?
+			if (Det(Lines[i].Direction, Lines[i].Point - Result) > 0.0f)
+			{
+				const FVector2f PreviousResult = Result;
+
+				if (!LinearProgram1(Lines, i, Radius, OptVelocity, bDirectionOpt, Result))
+				{
+					Result = PreviousResult;
+					return i;
+				}
+			}
+		}
+
+		return Lines.Num();
+	}
+
+	/** Finds the velocity that minimizes the max penetration of the lines, when they can't all be satisfied */
+	static void LinearProgram3(const FLineArray& Lines, int32 BeginLine, float Radius, FVector2f& Result)
+	{
+		float Distance = 0.0f;
+
+		for (int32 i = BeginLine; i < Lines.Num(); ++i)
+		{
+			if (Det(Lines[i].Direction, Lines[i].Point - Result) <= Distance)
+			{
+				continue;
+			}
+
+			// project the previous lines onto this one
+			FLineArray ProjectedLines;
+
+			for (int32 j = 0; j < i; ++j)
+			{
+				FLine Line;
+
+				const float Determinant = Det(Lines[i].Direction, Lines[j].Direction);
+
+				if (FMath::Abs(Determinant) <= Epsilon)
+				{
+					// same direction lines don't constrain each other
+					if ((Lines[i].Direction | Lines[j].Direction) > 0.0f)
+					{
+						continue;
+					}
+
+					Line.Point = (Lines[i].Point + Lines[j].Point) * 0.5f;
+				}
+				else
+				{
+					Line.Point = Lines[i].Point + Lines[i].Direction * (Det(Lines[j].Direction, Lines[i].Point - Lines[j].Point) / Determinant);
+				}
+
+				Line.Direction = (Lines[j].Direction - Lines[i].Direction).GetSafeNormal();
+				ProjectedLines.Add(Line);
+			}
+
+			const FVector2f PreviousResult = Result;
+
+			if (LinearProgram2(ProjectedLines, Radius, FVector2f(-Lines[i].Direction.Y, Lines[i].Direction.X), true, Result) < ProjectedLines.Num())
+			{
+				// should only happen through floating point error, keep the previous result
+				Result = PreviousResult;
+			}
+
+			Distance = Det(Lines[i].Direction, Lines[i].Point - Result);
+		}
+	}
+}
+
+void FCombatAvoidanceSolver::Reset()
+{
+	Positions.Reset();
+	Velocities.Reset();
+	PreferredVelocities.Reset();
+	Radii.Reset();
+	MaxSpeeds.Reset();
+	Cooperative.Reset();
+	NewVelocities.Reset();
+}
+
+int32 FCombatAvoidanceSolver::AddAgent(const FVector2f& Position, const FVector2f& Velocity, const FVector2f& PreferredVelocity, float Radius, float MaxSpeed, bool bCooperative /*= true*/)
+{
+	Velocities.Add(Velocity);
+	PreferredVelocities.Add(PreferredVelocity);
+	Radii.Add(Radius);
+	MaxSpeeds.Add(MaxSpeed);
+	Cooperative.Add(bCooperative);
+
+	return Positions.Add(Position);
+}
+
+void FCombatAvoidanceSolver::Solve(float DeltaTime, bool bParallel /*= true*/)
+{
+	NewVelocities.SetNumUninitialized(Num());
+
+	BuildGrid();
+
+	// agents only read the packed state and write their own result, so they can be solved in any order
+	ParallelFor(Num(), [this, DeltaTime](int32 Index)
+	{
+		SolveAgent(Index, DeltaTime);
+	}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+}
+
+void FCombatAvoidanceSolver::BuildGrid()
+{
+	const float InvCellSize = 1.0f / FMath::Max(NeighborDistance, 1.0f);
+
+	AgentCells.SetNumUninitialized(Num());
+	SortedAgents.SetNumUninitialized(Num());
+
+	for (int32 i = 0; i < Num(); ++i)
+	{
+		AgentCells[i] = CombatAvoidance::GetCellKey(FMath::FloorToInt32(Positions[i].X * InvCellSize), FMath::FloorToInt32(Positions[i].Y * InvCellSize));
+		SortedAgents[i] = i;
+	}
+
+	// group the agents by cell
+	SortedAgents.Sort([this](int32 A, int32 B) { return AgentCells[A] < AgentCells[B]; });
+
+	CellRanges.Reset();
+
+	for (int32 Start = 0; Start < SortedAgents.Num(); )
+	{
+		const uint64 Cell = AgentCells[SortedAgents[Start]];
+
+		int32 End = Start + 1;
+
+		while (End < SortedAgents.Num() && AgentCells[SortedAgents[End]] == Cell)
+		{
+			++End;
+		}
+
+		CellRanges.Add(Cell, FIntPoint(Start, End - Start));
+		Start = End;
+	}
+}
+
+void FCombatAvoidanceSolver::SolveAgent(int32 Index, float DeltaTime)
+{
+	using namespace CombatAvoidance;
+
+	const FVector2f Position = Positions[Index];
+	const FVector2f Velocity = Velocities[Index];
+
+	// non cooperative agents keep their velocity
+	if (!Cooperative[Index])
+	{
+		NewVelocities[Index] = Velocity;
+		return;
+	}
+
+	// gather the neighbors from the surrounding cells
+	struct FNeighbor
+	{
+		float DistSquared;
+		int32 Index;
+	};
+
+	TArray<FNeighbor, TInlineAllocator<32>> Neighbors;
+
+	const float InvCellSize = 1.0f / FMath::Max(NeighborDistance, 1.0f);
+	const int32 CellX = FMath::FloorToInt32(Position.X * InvCellSize);
+	const int32 CellY = FMath::FloorToInt32(Position.Y * InvCellSize);
+	const float NeighborDistSquared = FMath::Square(NeighborDistance);
+
+	for (int32 OffsetX = -1; OffsetX <= 1; ++OffsetX)
+	{
+		for (int32 OffsetY = -1; OffsetY <= 1; ++OffsetY)
+		{
+			const FIntPoint* Range = CellRanges.Find(GetCellKey(CellX + OffsetX, CellY + OffsetY));
+
+			if (!Range)
+			{
+				continue;
+			}
+
+			for (int32 i = Range->X; i < Range->X + Range->Y; ++i)
+			{
+				const int32 Other = SortedAgents[i];
+				const float DistSquared = FVector2f::DistSquared(Position, Positions[Other]);
+
+				if (Other != Index && DistSquared < NeighborDistSquared)
+				{
+					Neighbors.Add(FNeighbor{ DistSquared, Other });
+				}
+			}
+		}
+	}
+
+	// only avoid the nearest neighbors
+	if (Neighbors.Num() > MaxNeighbors)
+	{
+		Neighbors.Sort([](const FNeighbor& A, const FNeighbor& B) { return A.DistSquared < B.DistSquared; });
+		Neighbors.SetNum(MaxNeighbors, EAllowShrinking::No);
+	}
+
+	// build a half plane of permitted velocities for each neighbor
+	FLineArray Lines;
+
+	const float InvTimeHorizon = 1.0f / FMath::Max(TimeHorizon, KINDA_SMALL_NUMBER);
+	const float InvDeltaTime = 1.0f / FMath::Max(DeltaTime, KINDA_SMALL_NUMBER);
+
+	for (const FNeighbor& Neighbor : Neighbors)
+	{
+		const int32 Other = Neighbor.Index;
+
+		const FVector2f RelativePosition = Positions[Other] - Position;
+		const FVector2f RelativeVelocity = Velocity - Velocities[Other];
+		const float DistSquared = Neighbor.DistSquared;
+		const float CombinedRadius = Radii[Index] + Radii[Other];
+		const float CombinedRadiusSquared = FMath::Square(CombinedRadius);
+
+		FLine Line;
+		FVector2f U;
+
+		if (DistSquared > CombinedRadiusSquared)
+		{
+			// no collision yet. Vector from the cutoff center to the relative velocity
+			const FVector2f W = RelativeVelocity - RelativePosition * InvTimeHorizon;
+			const float WLengthSquared = W.SizeSquared();
+			const float DotProduct = W | RelativePosition;
+
+			if (DotProduct < 0.0f && FMath::Square(DotProduct) > CombinedRadiusSquared * WLengthSquared)
+			{
+				// project on the cutoff circle
+				const float WLength = FMath::Sqrt(WLengthSquared);
+				const FVector2f UnitW = W / WLength;
+
+				Line.Direction = FVector2f(UnitW.Y, -UnitW.X);
+				U = UnitW * (CombinedRadius * InvTimeHorizon - WLength);
+			}
+			else
+			{
+				// project on the legs of the velocity obstacle
+				const float Leg = FMath::Sqrt(DistSquared - CombinedRadiusSquared);
+
+				if (Det(RelativePosition, W) > 0.0f)
+				{
+					Line.Direction = FVector2f(RelativePosition.X * Leg - RelativePosition.Y * CombinedRadius, RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSquared;
+				}
+				else
+				{
+					Line.Direction = -FVector2f(RelativePosition.X * Leg + RelativePosition.Y * CombinedRadius, -RelativePosition.X * CombinedRadius + RelativePosition.Y * Leg) / DistSquared;
+				}
+
+				U = Line.Direction * (RelativeVelocity | Line.Direction) - RelativeVelocity;
+			}
+		}
+		else
+		{
+			// already overlapping, push apart within this step
+			const FVector2f W = RelativeVelocity - RelativePosition * InvDeltaTime;
+			const float WLength = W.Size();
+			const FVector2f UnitW = WLength > Epsilon ? W / WLength : FVector2f(1.0f, 0.0f);
+
+			Line.Direction = FVector2f(UnitW.Y, -UnitW.X);
+			U = UnitW * (CombinedRadius * InvDeltaTime - WLength);
+		}
+
+		// share the avoidance with cooperative neighbors, take all of it otherwise
+		Line.Point = Velocity + U * (Cooperative[Other] ? 0.5f : 1.0f);
+		Lines.Add(Line);
+	}
+
+	FVector2f Result;
+	const int32 LineFail = LinearProgram2(Lines, MaxSpeeds[Index], PreferredVelocities[Index], false, Result);
+
+	if (LineFail < Lines.Num())
+	{
+		LinearProgram3(Lines, LineFail, MaxSpeeds[Index], Result);
+	}
+
+	NewVelocities[Index] = Result;
+}
+
+bool UCombatCrowdAvoidanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UCombatCrowdAvoidanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatCrowdAvoidanceSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatCrowdAvoidanceSubsystem::RegisterEnemy(ACombatEnemy* Enemy)
+{
+	Enemies.AddUnique(Enemy);
+}
+
+void UCombatCrowdAvoidanceSubsystem::UnregisterEnemy(ACombatEnemy* Enemy)
+{
+	Enemies.RemoveSwap(Enemy, EAllowShrinking::No);
+}
+
+void UCombatCrowdAvoidanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatAvoidanceSolve);
+
+	Enemies.RemoveAllSwap([](const TWeakObjectPtr<ACombatEnemy>& Enemy) { return !Enemy.IsValid(); }, EAllowShrinking::No);
+
+	if (!CVarCombatAvoidanceEnabled.GetValueOnGameThread() || Enemies.IsEmpty() || DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	Solver.TimeHorizon = CVarCombatAvoidanceTimeHorizon.GetValueOnGameThread();
+	Solver.NeighborDistance = CVarCombatAvoidanceNeighborDistance.GetValueOnGameThread();
+	Solver.MaxNeighbors = FMath::Max(CVarCombatAvoidanceMaxNeighbors.GetValueOnGameThread(), 1);
+
+	const float RadiusPadding = CVarCombatAvoidanceRadiusPadding.GetValueOnGameThread();
+
+	// pack the enemies walking on the ground
+	Solver.Reset();
+	PackedEnemies.Reset();
+
+	for (const TWeakObjectPtr<ACombatEnemy>& WeakEnemy : Enemies)
+	{
+		ACombatEnemy* Enemy = WeakEnemy.Get();
+		const UCharacterMovementComponent* Movement = Enemy->GetCharacterMovement();
+
+		if (!Movement->IsMovingOnGround())
+		{
+			continue;
+		}
+
+		// prefer to keep following the current path
+		FVector2f Preferred = FVector2f::ZeroVector;
+
+		if (const AAIController* Controller = Cast<AAIController>(Enemy->GetController()))
+		{
+			const UPathFollowingComponent* PathFollowing = Controller->GetPathFollowingComponent();
+
+			if (PathFollowing && PathFollowing->GetStatus() == EPathFollowingStatus::Moving)
+			{
+				Preferred = FVector2f(FVector2D(PathFollowing->GetCurrentDirection())).GetSafeNormal() * Movement->GetMaxSpeed();
+			}
+		}
+
+		const FVector Location = Enemy->GetActorLocation();
+
+		Solver.AddAgent(FVector2f(Location.X, Location.Y), FVector2f(Movement->Velocity.X, Movement->Velocity.Y), Preferred, Enemy->GetCapsuleComponent()->GetScaledCapsuleRadius() + RadiusPadding, Movement->GetMaxSpeed());
+		PackedEnemies.Add(Enemy);
+	}
+
+	// players don't avoid, so the enemies steer around them
+	if (const UActorRegistrySubsystem* Registry = UActorRegistrySubsystem::Get(this))
+	{
+		for (const AActor* Player : Registry->GetActors(EActorRegistryCategory::Player))
+		{
+			if (!IsValid(Player))
+			{
+				continue;
+			}
+
+			const FVector Location = Player->GetActorLocation();
+			const FVector Velocity = Player->GetVelocity();
+
+			Solver.AddAgent(FVector2f(Location.X, Location.Y), FVector2f(Velocity.X, Velocity.Y), FVector2f(Velocity.X, Velocity.Y), Player->GetSimpleCollisionRadius(), Velocity.Size2D(), false);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_CombatAvoidanceAgents, Solver.Num());
+	TRACE_COUNTER_SET(CombatAvoidanceAgents, Solver.Num());
+
+	Solver.Solve(DeltaTime);
+
+	// feed the velocity change back as movement input
+	for (int32 i = 0; i < PackedEnemies.Num(); ++i)
+	{
+		ACombatEnemy* Enemy = PackedEnemies[i];
+
+		const FVector2f Steering = Solver.NewVelocities[i] - Solver.Velocities[i];
+		const float MaxSpeed = FMath::Max(Solver.MaxSpeeds[i], 1.0f);
+
+		if (Steering.SizeSquared() > 1.0f)
+		{
+			Enemy->AddMovementInput(FVector(Steering.X, Steering.Y, 0.0f).GetSafeNormal(), FMath::Min(Steering.Size() / MaxSpeed, 1.0f));
+		}
+	}
+}
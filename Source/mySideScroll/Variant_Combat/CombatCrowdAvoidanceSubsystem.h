@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatCrowdAvoidanceSubsystem.generated.h"
+
+class ACombatEnemy;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatAvoidance, Log, All);
+
+/**
+ *  ORCA (optimal reciprocal collision avoidance) solver over packed 2D agent state
+ *  Neighbors are found through a uniform grid, and each agent's velocity is solved independently, so the solve can run in parallel
+ */
+struct FCombatAvoidanceSolver
+{
+	/** Packed agent state, one entry per agent */
+	TArray<FVector2f> Positions;
+	TArray<FVector2f> Velocities;
+	TArray<FVector2f> PreferredVelocities;
+	TArray<float> Radii;
+	TArray<float> MaxSpeeds;
+
+	/** Agents that don't avoid others, like the player. Other agents take full responsibility for avoiding them */
+	TArray<bool> Cooperative;
+
+	/** Solved velocities, filled by Solve */
+	TArray<FVector2f> NewVelocities;
+
+	/** How far ahead collisions are avoided */
+	float TimeHorizon = 1.0f;
+
+	/** Max distance to consider other agents */
+	float NeighborDistance = 300.0f;
+
+	/** Max number of nearest agents to consider */
+	int32 MaxNeighbors = 10;
+
+	/** Removes all agents, keeping the allocations */
+	void Reset();
+
+	/** Adds an agent and returns its index */
+	int32 AddAgent(const FVector2f& Position, const FVector2f& Velocity, const FVector2f& PreferredVelocity, float Radius, float MaxSpeed, bool bCooperative = true);
+
+	/** Returns the number of agents */
+	int32 Num() const { return Positions.Num(); }
+
+	/** Solves the new velocities for all cooperative agents */
+	void Solve(float DeltaTime, bool bParallel = true);
+
+private:
+
+	/** Sorts the agents into grid cells */
+	void BuildGrid();
+
+	/** Solves the new velocity for a single agent */
+	void SolveAgent(int32 Index, float DeltaTime);
+
+	/** Agent indices sorted by grid cell */
+	TArray<int32> SortedAgents;
+
+	/** Grid cell of each agent */
+	TArray<uint64> AgentCells;
+
+	/** Range of SortedAgents in each occupied cell */
+	TMap<uint64, FIntPoint> CellRanges;
+};
+
+/**
+ *  Steers combat enemies around each other and around the player
+ *  Every frame, registered enemies are packed into an ORCA solver, solved with ParallelFor,
+ *  and the difference between the solved and current velocity is fed back as movement input.
+ *  Controlled through the Combat.Avoidance.* console variables.
+ */
+UCLASS()
+class UCombatCrowdAvoidanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Enemies taking part in avoidance */
+	TArray<TWeakObjectPtr<ACombatEnemy>> Enemies;
+
+	/** Enemies packed into the solver this frame, in agent order */
+	TArray<ACombatEnemy*> PackedEnemies;
+
+	/** Solver reused across frames */
+	FCombatAvoidanceSolver Solver;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Solves avoidance and steers the enemies */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat id for the tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Adds an enemy to the crowd */
+	void RegisterEnemy(ACombatEnemy* Enemy);
+
+	/** Removes an enemy from the crowd */
+	void UnregisterEnemy(ACombatEnemy* Enemy);
+};
@@ -2,9 +2,11 @@
 
 
 #include "CombatDamageableBox.h"
+#include "mySideScroll.h"
 #include "Components/StaticMeshComponent.h"
-#include "TimerManager.h"
 #include "Engine/World.h"
+#include "CombatCheckpointSubsystem.h"
+#include "PhysicsPropSubsystem.h"
 
 ACombatDamageableBox::ACombatDamageableBox()
 {
@@ -23,9 +25,29 @@ ACombatDamageableBox::ACombatDamageableBox()
 	Mesh->bNavigationRelevant = false;
 }
 
+void ACombatDamageableBox::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// save the collision object type so we can restore it after death
+	StartingObjectType = Mesh->GetCollisionObjectType();
+
+	// take part in checkpoint snapshots
+	if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+	{
+		CheckpointSubsystem->RegisterCheckpointable(this);
+	}
+
+	// let the prop manager put the box to sleep when nobody is around
+	if (UPhysicsPropSubsystem* PhysicsProps = GetWorld()->GetSubsystem<UPhysicsPropSubsystem>())
+	{
+		PhysicsProps->RegisterProp(Mesh);
+	}
+}
+
 void ACombatDamageableBox::RemoveFromLevel()
 {
-	// destroy this actor
+	// checkpoint restores spawn the box back if needed
 	Destroy();
 }
 
@@ -34,11 +56,27 @@ void ACombatDamageableBox::EndPlay(EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 
 	// clear the death timer
-	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(DeathTimer);
+	}
+
+	if (UCombatCheckpointSubsystem* CheckpointSubsystem = GetWorld()->GetSubsystem<UCombatCheckpointSubsystem>())
+	{
+		CheckpointSubsystem->UnregisterCheckpointable(this);
+	}
+
+	if (UPhysicsPropSubsystem* PhysicsProps = GetWorld()->GetSubsystem<UPhysicsPropSubsystem>())
+	{
+		PhysicsProps->UnregisterProp(Mesh);
+	}
 }
 
 void ACombatDamageableBox::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
+	SIDESCROLL_SCOPE(CombatBoxApplyDamage);
+	SideScrollCounters::AddDamageEvent();
+
 	// only process damage if we still have HP
 	if (CurrentHP > 0.0f)
 	{
@@ -51,6 +89,12 @@ void ACombatDamageableBox::ApplyDamage(float Damage, AActor* DamageCauser, const
 			HandleDeath();
 		}
 
+		// make sure the box is simulating so it reacts to the hit
+		if (UPhysicsPropSubsystem* PhysicsProps = GetWorld()->GetSubsystem<UPhysicsPropSubsystem>())
+		{
+			PhysicsProps->WakeProp(Mesh);
+		}
+
 		// apply a physics impulse to the box, ignoring its mass
 		Mesh->AddImpulseAtLocation(DamageImpulse * Mesh->GetMass(), DamageLocation);
 
@@ -68,7 +112,10 @@ void ACombatDamageableBox::HandleDeath()
 	OnBoxDestroyed();
 
 	// set up the death cleanup timer
-	GetWorld()->GetTimerManager().SetTimer(DeathTimer, this, &ACombatDamageableBox::RemoveFromLevel, DeathDelayTime);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->SetTimer(DeathTimer, this, &ACombatDamageableBox::RemoveFromLevel, DeathDelayTime);
+	}
 }
 
 void ACombatDamageableBox::ApplyHealing(float Healing, AActor* Healer)
@@ -76,3 +123,39 @@ void ACombatDamageableBox::ApplyHealing(float Healing, AActor* Healer)
 	// stub
 }
 
+void ACombatDamageableBox::SaveCheckpointState(FArchive& Ar)
+{
+	FTransform BoxTransform = GetActorTransform();
+
+	Ar << CurrentHP;
+	Ar << BoxTransform;
+}
+
+void ACombatDamageableBox::RestoreCheckpointState(FArchive& Ar)
+{
+	FTransform BoxTransform;
+
+	Ar << CurrentHP;
+	Ar << BoxTransform;
+
+	// cancel any pending removal
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(DeathTimer);
+	}
+
+	if (CurrentHP > 0.0f)
+	{
+		Mesh->SetCollisionObjectType(StartingObjectType);
+	}
+	else
+	{
+		// the box was dying at the checkpoint, so let it finish
+		HandleDeath();
+	}
+
+	// move the box back and stop it
+	SetActorTransform(BoxTransform, false, nullptr, ETeleportType::ResetPhysics);
+	Mesh->SetPhysicsLinearVelocity(FVector::ZeroVector);
+	Mesh->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+}
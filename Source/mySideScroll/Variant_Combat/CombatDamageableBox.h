@@ -5,13 +5,16 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "CombatDamageable.h"
+#include "CombatCheckpointable.h"
+#include "GameplayTimerSubsystem.h"
 #include "CombatDamageableBox.generated.h"
 
 /**
  *  A simple physics box that reacts to damage through the ICombatDamageable interface
+ *  Destroyed boxes are removed from the level and spawned back by checkpoint restores
  */
 UCLASS(abstract)
-class ACombatDamageableBox : public AActor, public ICombatDamageable
+class ACombatDamageableBox : public AActor, public ICombatDamageable, public ICombatCheckpointable
 {
 	GENERATED_BODY()
 	
@@ -34,7 +37,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Damage")
 	float DeathDelayTime = 6.0f;
 
-	FTimerHandle DeathTimer;
+	FGameplayTimerHandle DeathTimer;
+
+	/** Collision object type the box starts with, so it can be restored after death */
+	TEnumAsByte<ECollisionChannel> StartingObjectType = ECC_WorldDynamic;
 
 	/** Blueprint damage handler for effect playback */
 	UFUNCTION(BlueprintImplementableEvent, Category="Damage")
@@ -49,6 +55,9 @@ protected:
 
 public:
 
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
 	/** EndPlay cleanup */
 	void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
@@ -64,4 +73,17 @@ public:
 	virtual void ApplyHealing(float Healing, AActor* Healer) override;
 
 	// ~End CombatDamageable interface
+
+	// ~Begin CombatCheckpointable interface
+
+	/** Saves the box HP and transform */
+	virtual void SaveCheckpointState(FArchive& Ar) override;
+
+	/** Restores the box HP and transform */
+	virtual void RestoreCheckpointState(FArchive& Ar) override;
+
+	/** Boxes removed after the snapshot are spawned back */
+	virtual bool ShouldRespawnFromCheckpoint() const override { return true; }
+
+	// ~End CombatCheckpointable interface
 };
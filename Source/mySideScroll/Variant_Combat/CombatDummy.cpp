@@ -2,13 +2,14 @@
 
 
 #include "Variant_Combat/CombatDummy.h"
+#include "mySideScroll.h"
 #include "Components/SceneComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
 
 ACombatDummy::ACombatDummy()
 {
- 	PrimaryActorTick.bCanEverTick = true;
+ 	PrimaryActorTick.bCanEverTick = false;
 
 	// create the root
 	Root = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
@@ -33,6 +34,9 @@ ACombatDummy::ACombatDummy()
 
 void ACombatDummy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
+	SIDESCROLL_SCOPE(CombatDummyApplyDamage);
+	SideScrollCounters::AddDamageEvent();
+
 	// apply impulse to the dummy
 	Dummy->AddImpulseAtLocation(DamageImpulse, DamageLocation);
 
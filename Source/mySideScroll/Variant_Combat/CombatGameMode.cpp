@@ -2,8 +2,24 @@
 
 
 #include "Variant_Combat/CombatGameMode.h"
+#include "StartupProfiler.h"
 
 ACombatGameMode::ACombatGameMode()
 {
 
-}
\ No newline at end of file
+}
+
+void ACombatGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// report the map load and menu to gameplay transition times once the first gameplay frame has ticked
+	FStartupProfiler::MarkFirstPlayableFrameNextTick(GetWorld());
+}
+
+APawn* ACombatGameMode::SpawnDefaultPawnFor_Implementation(AController* NewPlayer, AActor* StartSpot)
+{
+	SIDESCROLL_STARTUP_SCOPE("PawnSpawn");
+
+	return Super::SpawnDefaultPawnFor_Implementation(NewPlayer, StartSpot);
+}
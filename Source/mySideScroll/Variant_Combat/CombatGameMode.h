@@ -17,4 +17,12 @@ class ACombatGameMode : public AGameModeBase
 public:
 
 	ACombatGameMode();
+
+protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Times the player pawn spawn */
+	virtual APawn* SpawnDefaultPawnFor_Implementation(AController* NewPlayer, AActor* StartSpot) override;
 };
@@ -0,0 +1,143 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+
+/**
+ *  Attack actions that can be buffered while another attack is playing
+ */
+enum class ECombatInputAction : uint8
+{
+	ComboAttack,
+	ChargedAttack
+};
+
+/**
+ *  A single buffered input
+ */
+struct FCombatBufferedInput
+{
+	/** World time at which the input was received */
+	double Timestamp = 0.0;
+
+	/** Engine frame in which the input was received */
+	uint64 Frame = 0;
+
+	/** Buffered action */
+	ECombatInputAction Action = ECombatInputAction::ComboAttack;
+
+	/** Set once the input has been used or discarded */
+	bool bConsumed = true;
+};
+
+/**
+ *  Fixed size ring buffer of attack inputs
+ *  Inputs are consumed oldest first, so presses keep their order even when several arrive in the same frame.
+ *  An input is considered fresh if it is within the time tolerance, or if it arrived in the current or previous frame,
+ *  so a long frame doesn't make an input stale before game code had a chance to see it.
+ *  Counts inputs lost to overflow or staleness, for tuning the buffer size and tolerances.
+ */
+template<uint32 Capacity>
+class TCombatInputBuffer
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Input buffer capacity must be a power of two");
+
+public:
+
+	/** Records an input. Overwrites the oldest entry if the buffer is full */
+	void Record(ECombatInputAction Action, double Timestamp, uint64 Frame)
+	{
+		FCombatBufferedInput& Entry = Entries[Head & (Capacity - 1)];
+
+		// did we overwrite an input that was never used?
+		if (!Entry.bConsumed)
+		{
+			++NumOverwritten;
+		}
+
+		Entry.Timestamp = Timestamp;
+		Entry.Frame = Frame;
+		Entry.Action = Action;
+		Entry.bConsumed = false;
+
+		++Head;
+		++NumRecorded;
+	}
+
+	/** Consumes the oldest fresh input. Returns false if there is none */
+	bool Consume(double Now, uint64 CurrentFrame, double Tolerance, ECombatInputAction* OutAction = nullptr)
+	{
+		const uint32 Count = FMath::Min(Head, Capacity);
+
+		for (uint32 i = Head - Count; i != Head; ++i)
+		{
+			FCombatBufferedInput& Entry = Entries[i & (Capacity - 1)];
+
+			if (!Entry.bConsumed && IsFresh(Entry, Now, CurrentFrame, Tolerance))
+			{
+				Entry.bConsumed = true;
+				++NumConsumed;
+
+				if (OutAction)
+				{
+					*OutAction = Entry.Action;
+				}
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/** Discards all pending inputs, counting them as expired */
+	void ExpirePending()
+	{
+		for (FCombatBufferedInput& Entry : Entries)
+		{
+			if (!Entry.bConsumed)
+			{
+				Entry.bConsumed = true;
+				++NumExpired;
+			}
+		}
+	}
+
+	/** Discards all pending inputs without counting them. Used when the owner is reset */
+	void Reset()
+	{
+		for (FCombatBufferedInput& Entry : Entries)
+		{
+			Entry.bConsumed = true;
+		}
+	}
+
+	/** Returns true if the input is within the tolerance or arrived in the current or previous frame */
+	static bool IsFresh(const FCombatBufferedInput& Entry, double Now, uint64 CurrentFrame, double Tolerance)
+	{
+		return (Now - Entry.Timestamp <= Tolerance) || (Entry.Frame + 1 >= CurrentFrame);
+	}
+
+	/** Stats accessors */
+	uint64 GetNumRecorded() const { return NumRecorded; }
+	uint64 GetNumConsumed() const { return NumConsumed; }
+	uint64 GetNumOverwritten() const { return NumOverwritten; }
+	uint64 GetNumExpired() const { return NumExpired; }
+	uint64 GetNumDropped() const { return NumOverwritten + NumExpired; }
+
+private:
+
+	/** Buffered inputs */
+	TStaticArray<FCombatBufferedInput, Capacity> Entries;
+
+	/** Index of the next entry to write. Wraps around the buffer */
+	uint32 Head = 0;
+
+	/** Input stats */
+	uint64 NumRecorded = 0;
+	uint64 NumConsumed = 0;
+	uint64 NumOverwritten = 0;
+	uint64 NumExpired = 0;
+};
@@ -0,0 +1,469 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatLagCompensationSubsystem.h"
+#include "mySideScroll.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_LOG_CATEGORY(LogCombatLagCompensation);
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Record"), STAT_CombatLagCompensationRecord, STATGROUP_SideScroll);
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Rewind"), STAT_CombatLagCompensationRewind, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lag Compensation Targets"), STAT_CombatLagCompensationTargets, STATGROUP_SideScroll);
+
+static TAutoConsoleVariable<bool> CVarCombatLagCompEnabled(
+	TEXT("Combat.LagComp.Enabled"),
+	true,
+	TEXT("If true, melee requests from clients are checked against the characters as the client saw them. Otherwise they're checked against the latest recorded frame."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCombatLagCompHistoryFrames(
+	TEXT("Combat.LagComp.HistoryFrames"),
+	64,
+	TEXT("Number of frames kept in the lag compensation history. Read when a world starts."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCombatLagCompMaxTargets(
+	TEXT("Combat.LagComp.MaxTargets"),
+	64,
+	TEXT("Max number of characters recorded in the lag compensation history. Read when a world starts."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatLagCompMaxRewind(
+	TEXT("Combat.LagComp.MaxRewind"),
+	0.25f,
+	TEXT("Max time in seconds a melee request can be rewound. Clients with higher latency have to lead their attacks."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatLagCompInterpolationDelay(
+	TEXT("Combat.LagComp.InterpolationDelay"),
+	0.05f,
+	TEXT("Time in seconds clients display remote characters behind the latest replicated state, added to the round trip time when rewinding."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatLagCompBoneRadius(
+	TEXT("Combat.LagComp.BoneRadius"),
+	15.0f,
+	TEXT("Radius in cm of the spheres tested around recorded bones."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarCombatLagCompMaxStartOffset(
+	TEXT("Combat.LagComp.MaxStartOffset"),
+	200.0f,
+	TEXT("Max distance in cm between a client's melee trace start and the attacker's location on the server."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld CCmdCombatLagCompStats(
+	TEXT("Combat.LagComp.Stats"),
+	TEXT("Logs the lag compensation history size, rewind cost, melee request bandwidth and per connection bandwidth."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const UCombatLagCompensationSubsystem* LagCompensation = World ? World->GetSubsystem<UCombatLagCompensationSubsystem>() : nullptr)
+		{
+			LagCompensation->LogStats();
+		}
+	}));
+
+namespace CombatLagCompensation
+{
+	/** Capsule locations are stored in millimeters */
+	constexpr double LocationScale = 10.0;
+
+	/** Bone offsets are stored in half centimeters */
+	constexpr double BoneScale = 2.0;
+
+	FIntVector QuantizeLocation(const FVector& Location)
+	{
+		return FIntVector(FMath::RoundToInt32(Location.X * LocationScale), FMath::RoundToInt32(Location.Y * LocationScale), FMath::RoundToInt32(Location.Z * LocationScale));
+	}
+
+	FVector DequantizeLocation(const FIntVector& Location)
+	{
+		return FVector(Location) / LocationScale;
+	}
+
+	int16 QuantizeBoneOffset(double Offset)
+	{
+		return static_cast<int16>(FMath::Clamp(FMath::RoundToInt32(Offset * BoneScale), (int32)MIN_int16, (int32)MAX_int16));
+	}
+
+	FVector DequantizeBoneOffset(const int16 Offset[3])
+	{
+		return FVector(Offset[0], Offset[1], Offset[2]) / BoneScale;
+	}
+}
+
+bool UCombatLagCompensationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatLagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// size the history up front so recording never allocates
+	MaxFrames = FMath::Max(CVarCombatLagCompHistoryFrames.GetValueOnGameThread(), 2);
+	MaxTargets = FMath::Max(CVarCombatLagCompMaxTargets.GetValueOnGameThread(), 1);
+
+	Samples.SetNum(MaxFrames * MaxTargets);
+	FrameTimes.SetNumZeroed(MaxFrames);
+	Targets.SetNum(MaxTargets);
+
+	// hand out the lowest slots first
+	FreeTargets.Reserve(MaxTargets);
+
+	for (int32 i = MaxTargets - 1; i >= 0; --i)
+	{
+		FreeTargets.Add(i);
+	}
+}
+
+void UCombatLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (IsServer())
+	{
+		RecordFrame();
+	}
+}
+
+TStatId UCombatLagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatLagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+bool UCombatLagCompensationSubsystem::RegisterTarget(ACharacter* Character, TConstArrayView<FName> Bones)
+{
+	if (!IsValid(Character) || !IsServer())
+	{
+		return false;
+	}
+
+	if (FreeTargets.IsEmpty())
+	{
+		UE_LOG(LogCombatLagCompensation, Warning, TEXT("All %d lag compensation slots are taken, %s won't be rewound. Raise Combat.LagComp.MaxTargets"), MaxTargets, *Character->GetName());
+		return false;
+	}
+
+	const int32 TargetIndex = FreeTargets.Pop(EAllowShrinking::No);
+
+	FCombatLagCompensationTarget& Target = Targets[TargetIndex];
+	Target.Character = Character;
+	Target.NumBones = FMath::Min(Bones.Num(), FCombatLagCompensationSample::NumBones);
+
+	for (int32 i = 0; i < Target.NumBones; ++i)
+	{
+		Target.Bones[i] = Bones[i];
+	}
+
+	Character->GetCapsuleComponent()->GetScaledCapsuleSize(Target.CapsuleRadius, Target.CapsuleHalfHeight);
+
+	// forget the poses recorded for the slot's previous owner
+	for (int32 Frame = 0; Frame < MaxFrames; ++Frame)
+	{
+		Samples[Frame * MaxTargets + TargetIndex].bValid = false;
+	}
+
+	INC_DWORD_STAT(STAT_CombatLagCompensationTargets);
+
+	return true;
+}
+
+void UCombatLagCompensationSubsystem::UnregisterTarget(ACharacter* Character)
+{
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		if (Targets[i].Character.Get() == Character)
+		{
+			Targets[i] = FCombatLagCompensationTarget();
+			FreeTargets.Add(i);
+
+			DEC_DWORD_STAT(STAT_CombatLagCompensationTargets);
+			return;
+		}
+	}
+}
+
+double UCombatLagCompensationSubsystem::GetViewTime(const APlayerController* PlayerController) const
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	if (!CVarCombatLagCompEnabled.GetValueOnGameThread())
+	{
+		return Now;
+	}
+
+	// the request took half the round trip to get here, and the characters the client saw were already half a round trip old
+	double Latency = FMath::Max(CVarCombatLagCompInterpolationDelay.GetValueOnGameThread(), 0.0f);
+
+	if (PlayerController && PlayerController->PlayerState)
+	{
+		Latency += PlayerController->PlayerState->GetPingInMilliseconds() * 0.001;
+	}
+
+	return Now - FMath::Clamp(Latency, 0.0, (double)FMath::Max(CVarCombatLagCompMaxRewind.GetValueOnGameThread(), 0.0f));
+}
+
+bool UCombatLagCompensationSubsystem::IsValidAttackStart(const ACharacter* Attacker, const FVector& Start) const
+{
+	if (!IsValid(Attacker))
+	{
+		return false;
+	}
+
+	// the client may have moved a little further than the server has seen so far
+	const float MaxOffset = FMath::Max(CVarCombatLagCompMaxStartOffset.GetValueOnGameThread(), 0.0f);
+
+	return FVector::DistSquared(Start, Attacker->GetActorLocation()) <= FMath::Square(MaxOffset);
+}
+
+int32 UCombatLagCompensationSubsystem::SweepRewound(const AActor* Attacker, double ViewTime, const FVector& Start, const FVector& End, float Radius, TArray<FCombatLagCompensationHit>& OutHits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatLagCompensationRewind);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	OutHits.Reset();
+
+	if (NumFrames == 0)
+	{
+		return 0;
+	}
+
+	// walk back from the newest frame to the frames around the view time
+	int32 NewerFrame = NewestFrame;
+	int32 OlderFrame = NewestFrame;
+
+	for (int32 Step = 1; Step < NumFrames && FrameTimes[OlderFrame] > ViewTime; ++Step)
+	{
+		NewerFrame = OlderFrame;
+		OlderFrame = (OlderFrame + MaxFrames - 1) % MaxFrames;
+	}
+
+	// clamps to the oldest frame if the view time is older than the history
+	const double FrameDelta = FrameTimes[NewerFrame] - FrameTimes[OlderFrame];
+	const float Alpha = FrameDelta > 0.0 ? FMath::Clamp((ViewTime - FrameTimes[OlderFrame]) / FrameDelta, 0.0, 1.0) : 1.0f;
+
+	const float BoneRadius = FMath::Max(CVarCombatLagCompBoneRadius.GetValueOnGameThread(), 0.0f);
+
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		const FCombatLagCompensationTarget& Target = Targets[i];
+		ACharacter* Character = Target.Character.Get();
+
+		if (!Character || Character == Attacker)
+		{
+			continue;
+		}
+
+		FVector Location;
+		FVector Bones[FCombatLagCompensationSample::NumBones];
+
+		if (!GetRewoundPose(OlderFrame, NewerFrame, Alpha, i, Location, Bones))
+		{
+			continue;
+		}
+
+		// test the sweep against the capsule's axis
+		const FVector AxisOffset = FVector::UpVector * FMath::Max(Target.CapsuleHalfHeight - Target.CapsuleRadius, 0.0f);
+
+		FVector SweepPoint;
+		FVector TargetPoint;
+		FMath::SegmentDistToSegmentSafe(Start, End, Location - AxisOffset, Location + AxisOffset, SweepPoint, TargetPoint);
+
+		float TargetRadius = Target.CapsuleRadius;
+		bool bHit = FVector::DistSquared(SweepPoint, TargetPoint) <= FMath::Square(Radius + TargetRadius);
+
+		// limbs can reach outside of the capsule, e.g. during hit reactions
+		for (int32 Bone = 0; Bone < Target.NumBones && !bHit; ++Bone)
+		{
+			TargetPoint = Bones[Bone];
+			SweepPoint = FMath::ClosestPointOnSegment(TargetPoint, Start, End);
+			TargetRadius = BoneRadius;
+			bHit = FVector::DistSquared(SweepPoint, TargetPoint) <= FMath::Square(Radius + TargetRadius);
+		}
+
+		if (bHit)
+		{
+			FVector Normal = (SweepPoint - TargetPoint).GetSafeNormal();
+
+			// the sweep passes through the target's center, push back towards the attacker
+			if (Normal.IsNearlyZero())
+			{
+				Normal = (Start - TargetPoint).GetSafeNormal();
+			}
+
+			FCombatLagCompensationHit& Hit = OutHits.AddDefaulted_GetRef();
+			Hit.Character = Character;
+			Hit.ImpactNormal = Normal;
+			Hit.ImpactPoint = TargetPoint + Normal * TargetRadius;
+		}
+	}
+
+	// update the stats
+	const double RewindTime = FPlatformTime::Seconds() - StartTime;
+
+	++NumRewinds;
+	NumRewindHits += OutHits.Num();
+	TotalRewindTime += RewindTime;
+	MaxRewindTime = FMath::Max(MaxRewindTime, RewindTime);
+	TotalRewindAge += GetWorld()->GetTimeSeconds() - ViewTime;
+
+	return OutHits.Num();
+}
+
+void UCombatLagCompensationSubsystem::AddAttackRequest(int32 PayloadBits, bool bAccepted)
+{
+	++NumAttackRequests;
+	TotalRequestBits += PayloadBits;
+
+	if (!bAccepted)
+	{
+		++NumRejectedRequests;
+	}
+}
+
+void UCombatLagCompensationSubsystem::LogStats() const
+{
+	const int32 NumRegistered = MaxTargets - FreeTargets.Num();
+	const int64 HistoryBytes = Samples.GetAllocatedSize() + FrameTimes.GetAllocatedSize();
+	const double RecordedTime = NumFrames > 1 ? FrameTimes[NewestFrame] - FrameTimes[(NewestFrame + MaxFrames - NumFrames + 1) % MaxFrames] : 0.0;
+
+	UE_LOG(LogCombatLagCompensation, Log, TEXT("History: %d frames x %d slots, %d registered, %.1f KB, %.2f s recorded%s"),
+		MaxFrames, MaxTargets, NumRegistered, HistoryBytes / 1024.0, RecordedTime, IsServer() ? TEXT("") : TEXT(" (not a server)"));
+
+	if (NumRewinds > 0)
+	{
+		UE_LOG(LogCombatLagCompensation, Log, TEXT("Rewinds: %llu, %llu hits, avg %.2f us, max %.2f us, avg rewind %.0f ms"),
+			NumRewinds, NumRewindHits, TotalRewindTime * 1000000.0 / NumRewinds, MaxRewindTime * 1000000.0, TotalRewindAge * 1000.0 / NumRewinds);
+	}
+
+	if (NumAttackRequests > 0)
+	{
+		UE_LOG(LogCombatLagCompensation, Log, TEXT("Melee requests: %llu, %llu rejected, avg payload %.1f bits"),
+			NumAttackRequests, NumRejectedRequests, (double)TotalRequestBits / NumAttackRequests);
+	}
+
+	// log the bandwidth of every connection
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+
+	if (!NetDriver)
+	{
+		return;
+	}
+
+	auto LogConnection = [](const UNetConnection* Connection)
+	{
+		const APlayerController* PC = Connection->PlayerController;
+		const float Ping = PC && PC->PlayerState ? PC->PlayerState->GetPingInMilliseconds() : 0.0f;
+
+		UE_LOG(LogCombatLagCompensation, Log, TEXT("Connection %s: ping %.0f ms, in %d B/s, out %d B/s"),
+			*Connection->LowLevelGetRemoteAddress(true), Ping, Connection->InBytesPerSecond, Connection->OutBytesPerSecond);
+	};
+
+	if (NetDriver->ServerConnection)
+	{
+		LogConnection(NetDriver->ServerConnection);
+	}
+
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection)
+		{
+			LogConnection(Connection);
+		}
+	}
+}
+
+UCombatLagCompensationSubsystem* UCombatLagCompensationSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+
+	return World ? World->GetSubsystem<UCombatLagCompensationSubsystem>() : nullptr;
+}
+
+bool UCombatLagCompensationSubsystem::IsServer() const
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+
+	return NetMode == NM_ListenServer || NetMode == NM_DedicatedServer;
+}
+
+void UCombatLagCompensationSubsystem::RecordFrame()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatLagCompensationRecord);
+
+	NewestFrame = (NewestFrame + 1) % MaxFrames;
+	NumFrames = FMath::Min(NumFrames + 1, MaxFrames);
+	FrameTimes[NewestFrame] = GetWorld()->GetTimeSeconds();
+
+	FCombatLagCompensationSample* FrameSamples = &Samples[NewestFrame * MaxTargets];
+
+	for (int32 i = 0; i < Targets.Num(); ++i)
+	{
+		const FCombatLagCompensationTarget& Target = Targets[i];
+		FCombatLagCompensationSample& Sample = FrameSamples[i];
+
+		Sample.bValid = false;
+
+		const ACharacter* Character = Target.Character.Get();
+
+		// skip free slots and characters that can't be hit, e.g. dead ones
+		if (!Character || !Character->GetCapsuleComponent()->IsCollisionEnabled())
+		{
+			continue;
+		}
+
+		const FVector Center = Character->GetCapsuleComponent()->GetComponentLocation();
+		Sample.Location = CombatLagCompensation::QuantizeLocation(Center);
+
+		const USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+		for (int32 Bone = 0; Bone < Target.NumBones; ++Bone)
+		{
+			const FVector Offset = Mesh->GetSocketLocation(Target.Bones[Bone]) - Center;
+
+			Sample.BoneOffsets[Bone][0] = CombatLagCompensation::QuantizeBoneOffset(Offset.X);
+			Sample.BoneOffsets[Bone][1] = CombatLagCompensation::QuantizeBoneOffset(Offset.Y);
+			Sample.BoneOffsets[Bone][2] = CombatLagCompensation::QuantizeBoneOffset(Offset.Z);
+		}
+
+		Sample.bValid = true;
+	}
+}
+
+bool UCombatLagCompensationSubsystem::GetRewoundPose(int32 OlderFrame, int32 NewerFrame, float Alpha, int32 TargetIndex, FVector& OutLocation, FVector OutBones[FCombatLagCompensationSample::NumBones]) const
+{
+	const FCombatLagCompensationSample& Newer = GetSample(NewerFrame, TargetIndex);
+
+	if (!Newer.bValid)
+	{
+		return false;
+	}
+
+	// use the newer pose on its own if the target wasn't recorded in the older frame
+	const FCombatLagCompensationSample& Older = GetSample(OlderFrame, TargetIndex).bValid ? GetSample(OlderFrame, TargetIndex) : Newer;
+
+	OutLocation = FMath::Lerp(CombatLagCompensation::DequantizeLocation(Older.Location), CombatLagCompensation::DequantizeLocation(Newer.Location), Alpha);
+
+	for (int32 Bone = 0; Bone < Targets[TargetIndex].NumBones; ++Bone)
+	{
+		const FVector Offset = FMath::Lerp(CombatLagCompensation::DequantizeBoneOffset(Older.BoneOffsets[Bone]), CombatLagCompensation::DequantizeBoneOffset(Newer.BoneOffsets[Bone]), Alpha);
+
+		OutBones[Bone] = OutLocation + Offset;
+	}
+
+	return true;
+}
@@ -0,0 +1,171 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatLagCompensationSubsystem.generated.h"
+
+class ACharacter;
+class APlayerController;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatLagCompensation, Log, All);
+
+/**
+ *  Quantized pose of a lag compensated character for a single recorded frame
+ */
+struct FCombatLagCompensationSample
+{
+	/** Number of bones recorded per character */
+	static constexpr int32 NumBones = 2;
+
+	/** Capsule center in millimeters */
+	FIntVector Location = FIntVector::ZeroValue;
+
+	/** Bone locations relative to the capsule center, in half centimeters */
+	int16 BoneOffsets[NumBones][3] = {};
+
+	/** True if the character was alive and collidable when the frame was recorded */
+	bool bValid = false;
+};
+
+/**
+ *  Character tracked by the lag compensation history
+ */
+struct FCombatLagCompensationTarget
+{
+	/** Tracked character. Null if the slot is free */
+	TWeakObjectPtr<ACharacter> Character;
+
+	/** Bones recorded along with the capsule */
+	FName Bones[FCombatLagCompensationSample::NumBones];
+
+	/** Number of valid entries in the bones array */
+	int32 NumBones = 0;
+
+	/** Capsule size, cached on registration */
+	float CapsuleRadius = 0.0f;
+	float CapsuleHalfHeight = 0.0f;
+};
+
+/**
+ *  Character hit by a rewound melee sweep
+ */
+struct FCombatLagCompensationHit
+{
+	/** Character that was hit */
+	ACharacter* Character = nullptr;
+
+	/** Hit location on the rewound capsule or bone */
+	FVector ImpactPoint = FVector::ZeroVector;
+
+	/** Normal pointing from the rewound target towards the sweep */
+	FVector ImpactNormal = FVector::ZeroVector;
+};
+
+/**
+ *  Server side lag compensation for melee attacks in networked Combat games
+ *  Records the capsule and a few bones of every registered character each frame into a fixed size ring buffer.
+ *  - The history is frame major: each frame is a contiguous block of samples, one per target slot,
+ *    so recording writes a single block and rewinding reads two
+ *  - Positions are quantized to keep the samples small, the memory cost is fixed when the world starts
+ *  - Melee requests from remote clients are swept against the poses the attacker saw, interpolated between the two recorded frames around their view time
+ *  Only records while the world is a listen or dedicated server.
+ */
+UCLASS()
+class UCombatLagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Recorded samples, indexed by frame * MaxTargets + target slot */
+	TArray<FCombatLagCompensationSample> Samples;
+
+	/** World time each frame was recorded at */
+	TArray<double> FrameTimes;
+
+	/** Target slots */
+	TArray<FCombatLagCompensationTarget> Targets;
+
+	/** Free target slots */
+	TArray<int32> FreeTargets;
+
+	/** Number of frames in the history */
+	int32 MaxFrames = 0;
+
+	/** Number of target slots in each frame */
+	int32 MaxTargets = 0;
+
+	/** Frame most recently recorded */
+	int32 NewestFrame = INDEX_NONE;
+
+	/** Number of frames recorded so far, up to MaxFrames */
+	int32 NumFrames = 0;
+
+	/** Rewind stats */
+	uint64 NumRewinds = 0;
+	uint64 NumRewindHits = 0;
+	double TotalRewindTime = 0.0;
+	double MaxRewindTime = 0.0;
+	double TotalRewindAge = 0.0;
+
+	/** Attack request stats */
+	uint64 NumAttackRequests = 0;
+	uint64 NumRejectedRequests = 0;
+	uint64 TotalRequestBits = 0;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Allocates the history */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Records the registered characters */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat id for the tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Starts recording a character along with the provided bones. Returns false if the world isn't a server or all the slots are taken */
+	bool RegisterTarget(ACharacter* Character, TConstArrayView<FName> Bones);
+
+	/** Stops recording a character */
+	void UnregisterTarget(ACharacter* Character);
+
+	/** Returns the world time the player was looking at when they sent a request that arrives now */
+	double GetViewTime(const APlayerController* PlayerController) const;
+
+	/** Returns true if a client provided melee trace start is close enough to the attacker's server side location */
+	bool IsValidAttackStart(const ACharacter* Attacker, const FVector& Start) const;
+
+	/** Sweeps a sphere against the characters as they were at the view time. Returns the number of hits */
+	int32 SweepRewound(const AActor* Attacker, double ViewTime, const FVector& Start, const FVector& End, float Radius, TArray<FCombatLagCompensationHit>& OutHits);
+
+	/** Records a melee request received from a client */
+	void AddAttackRequest(int32 PayloadBits, bool bAccepted);
+
+	/** Logs the history size, rewind cost and network usage */
+	void LogStats() const;
+
+	/** Returns the subsystem for the world the object is in */
+	static UCombatLagCompensationSubsystem* Get(const UObject* WorldContextObject);
+
+protected:
+
+	/** Returns true if the world is a listen or dedicated server */
+	bool IsServer() const;
+
+	/** Writes the current pose of every target into a new frame */
+	void RecordFrame();
+
+	/** Interpolates a target's pose between two frames. Returns false if the target wasn't valid in the newer frame */
+	bool GetRewoundPose(int32 OlderFrame, int32 NewerFrame, float Alpha, int32 TargetIndex, FVector& OutLocation, FVector OutBones[FCombatLagCompensationSample::NumBones]) const;
+
+	/** Returns a sample in the history */
+	FORCEINLINE const FCombatLagCompensationSample& GetSample(int32 Frame, int32 TargetIndex) const { return Samples[Frame * MaxTargets + TargetIndex]; }
+};
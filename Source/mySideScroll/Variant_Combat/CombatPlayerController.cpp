@@ -9,6 +9,9 @@
 #include "CombatCharacter.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
+#include "ActorRegistrySubsystem.h"
+#include "CombatCollision.h"
+#include "Components/PrimitiveComponent.h"
 
 void ACombatPlayerController::SetupInputComponent()
 {
@@ -26,8 +29,40 @@ void ACombatPlayerController::OnPossess(APawn* InPawn)
 {
 	Super::OnPossess(InPawn);
 
-	// subscribe to the pawn's OnDestroyed delegate
-	InPawn->OnDestroyed.AddDynamic(this, &ACombatPlayerController::OnPawnDestroyed);
+	// subscribe to the pawn's OnDestroyed delegate, only once in case the same pawn is possessed again
+	InPawn->OnDestroyed.AddUniqueDynamic(this, &ACombatPlayerController::OnPawnDestroyed);
+
+	// register the pawn as a player with the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(InPawn, EActorRegistryCategory::Player);
+	}
+
+	// let the pawn overlap player only trigger volumes
+	if (UPrimitiveComponent* PawnRoot = Cast<UPrimitiveComponent>(InPawn->GetRootComponent()))
+	{
+		PawnRoot->SetCollisionResponseToChannel(ECC_PlayerTrigger, ECR_Overlap);
+	}
+}
+
+void ACombatPlayerController::OnUnPossess()
+{
+	// unregister the pawn from the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(GetPawn(), EActorRegistryCategory::Player);
+	}
+
+	// unpossessed pawns no longer set off player triggers
+	if (GetPawn())
+	{
+		if (UPrimitiveComponent* PawnRoot = Cast<UPrimitiveComponent>(GetPawn()->GetRootComponent()))
+		{
+			PawnRoot->SetCollisionResponseToChannel(ECC_PlayerTrigger, ECR_Ignore);
+		}
+	}
+
+	Super::OnUnPossess();
 }
 
 void ACombatPlayerController::SetRespawnTransform(const FTransform& NewRespawn)
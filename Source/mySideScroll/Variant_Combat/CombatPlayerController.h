@@ -40,11 +40,17 @@ protected:
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn) override;
 
+	/** Pawn cleanup */
+	virtual void OnUnPossess() override;
+
 public:
 
 	/** Updates the character respawn transform */
 	void SetRespawnTransform(const FTransform& NewRespawn);
 
+	/** Returns the character respawn transform */
+	const FTransform& GetRespawnTransform() const { return RespawnTransform; }
+
 protected:
 
 	/** Called if the possessed pawn is destroyed */
@@ -0,0 +1,229 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatRagdollSubsystem.h"
+#include "SideScrollMemory.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY(LogCombatRagdoll);
+
+static TAutoConsoleVariable<int32> CVarCombatMaxRagdolls(
+	TEXT("Combat.Ragdoll.MaxSimulated"),
+	8,
+	TEXT("Max number of full death ragdolls that can simulate at the same time."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCombatMaxHitReactions(
+	TEXT("Combat.Ragdoll.MaxHitReactions"),
+	8,
+	TEXT("Max number of partial hit reaction ragdolls that can simulate at the same time."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarCombatRagdollEvictionPolicy(
+	TEXT("Combat.Ragdoll.EvictionPolicy"),
+	0,
+	TEXT("Ragdoll to freeze when over budget.\n")
+	TEXT("0: oldest ragdoll\n")
+	TEXT("1: ragdoll farthest from the player camera"),
+	ECVF_Default);
+
+void UCombatRagdollSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// preallocate the bookkeeping so deaths don't allocate
+	ActiveRagdolls.Reserve(FMath::Max(CVarCombatMaxRagdolls.GetValueOnGameThread(), 0) + 1);
+	ActiveHitReactions.Reserve(FMath::Max(CVarCombatMaxHitReactions.GetValueOnGameThread(), 0));
+}
+
+bool UCombatRagdollSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UCombatRagdollSubsystem::RequestRagdoll(USkeletalMeshComponent* Mesh)
+{
+	LLM_SCOPE_BYTAG(SideScroll_Ragdolls);
+
+	if (!IsValid(Mesh))
+	{
+		return false;
+	}
+
+	// a full ragdoll supersedes any hit reaction on the same mesh
+	ActiveHitReactions.RemoveAllSwap([Mesh](const FCombatRagdollEntry& Entry) { return Entry.Mesh.Get() == Mesh; });
+
+	PruneInvalidEntries(ActiveRagdolls);
+
+	FCombatRagdollEntry NewEntry;
+	NewEntry.Mesh = Mesh;
+	NewEntry.StartTime = GetWorld()->GetTimeSeconds();
+
+	// are we over budget?
+	const int32 MaxRagdolls = FMath::Max(CVarCombatMaxRagdolls.GetValueOnGameThread(), 0);
+
+	while (ActiveRagdolls.Num() >= MaxRagdolls)
+	{
+		const int32 EvictionIndex = FindEvictionIndex(NewEntry);
+
+		// is the new mesh the worst candidate? Let the caller fall back to a cheap death
+		if (!ActiveRagdolls.IsValidIndex(EvictionIndex))
+		{
+			UE_LOG(LogCombatRagdoll, Verbose, TEXT("Ragdoll budget full, denying ragdoll for %s"), *GetNameSafe(Mesh->GetOwner()));
+			return false;
+		}
+
+		// freeze the evicted ragdoll in place
+		if (USkeletalMeshComponent* EvictedMesh = ActiveRagdolls[EvictionIndex].Mesh.Get())
+		{
+			FreezePose(EvictedMesh);
+		}
+
+		ActiveRagdolls.RemoveAtSwap(EvictionIndex, EAllowShrinking::No);
+	}
+
+	// enable full ragdoll physics
+	Mesh->SetSimulatePhysics(true);
+
+	ActiveRagdolls.Add(NewEntry);
+
+	return true;
+}
+
+bool UCombatRagdollSubsystem::RequestHitReaction(USkeletalMeshComponent* Mesh, FName PelvisBoneName)
+{
+	LLM_SCOPE_BYTAG(SideScroll_Ragdolls);
+
+	if (!IsValid(Mesh))
+	{
+		return false;
+	}
+
+	// is the mesh already reacting? refresh the partial ragdoll without counting it again
+	const bool bAlreadyReacting = ActiveHitReactions.ContainsByPredicate([Mesh](const FCombatRagdollEntry& Entry) { return Entry.Mesh.Get() == Mesh; });
+
+	if (!bAlreadyReacting)
+	{
+		PruneInvalidEntries(ActiveHitReactions);
+
+		// skip the physics reaction if we're over budget
+		if (ActiveHitReactions.Num() >= FMath::Max(CVarCombatMaxHitReactions.GetValueOnGameThread(), 0))
+		{
+			return false;
+		}
+
+		FCombatRagdollEntry& NewEntry = ActiveHitReactions.AddDefaulted_GetRef();
+		NewEntry.Mesh = Mesh;
+		NewEntry.StartTime = GetWorld()->GetTimeSeconds();
+	}
+
+	// enable partial ragdoll physics, but keep the pelvis vertical
+	Mesh->SetPhysicsBlendWeight(0.5f);
+	Mesh->SetBodySimulatePhysics(PelvisBoneName, false);
+
+	return true;
+}
+
+void UCombatRagdollSubsystem::EndHitReaction(USkeletalMeshComponent* Mesh)
+{
+	// remove the mesh from the hit reaction budget
+	if (ActiveHitReactions.RemoveAllSwap([Mesh](const FCombatRagdollEntry& Entry) { return Entry.Mesh.Get() == Mesh; }) > 0)
+	{
+		// disable ragdoll physics
+		Mesh->SetPhysicsBlendWeight(0.0f);
+	}
+}
+
+void UCombatRagdollSubsystem::ReleaseMesh(USkeletalMeshComponent* Mesh)
+{
+	ActiveRagdolls.RemoveAllSwap([Mesh](const FCombatRagdollEntry& Entry) { return Entry.Mesh.Get() == Mesh; });
+	ActiveHitReactions.RemoveAllSwap([Mesh](const FCombatRagdollEntry& Entry) { return Entry.Mesh.Get() == Mesh; });
+}
+
+void UCombatRagdollSubsystem::ResetMesh(USkeletalMeshComponent* Mesh, ECollisionEnabled::Type CollisionEnabled)
+{
+	if (!IsValid(Mesh))
+	{
+		return;
+	}
+
+	ReleaseMesh(Mesh);
+
+	// stop simulating
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetPhysicsBlendWeight(0.0f);
+
+	// undo a frozen pose
+	Mesh->bNoSkeletonUpdate = false;
+	Mesh->SetComponentTickEnabled(true);
+	Mesh->SetCollisionEnabled(CollisionEnabled);
+}
+
+void UCombatRagdollSubsystem::PruneInvalidEntries(TArray<FCombatRagdollEntry>& Entries)
+{
+	Entries.RemoveAllSwap([](const FCombatRagdollEntry& Entry) { return !Entry.Mesh.IsValid(); });
+}
+
+int32 UCombatRagdollSubsystem::FindEvictionIndex(const FCombatRagdollEntry& Candidate) const
+{
+	// the candidate is represented by an index past the end of the active list
+	int32 BestIndex = ActiveRagdolls.Num();
+
+	if (CVarCombatRagdollEvictionPolicy.GetValueOnGameThread() == 1)
+	{
+		// find the player camera location
+		const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+
+		if (PC && PC->PlayerCameraManager)
+		{
+			const FVector CameraLocation = PC->PlayerCameraManager->GetCameraLocation();
+
+			double BestDistSquared = FVector::DistSquared(Candidate.Mesh->GetComponentLocation(), CameraLocation);
+
+			// evict the ragdoll farthest from the camera
+			for (int32 i = 0; i < ActiveRagdolls.Num(); ++i)
+			{
+				const double DistSquared = FVector::DistSquared(ActiveRagdolls[i].Mesh->GetComponentLocation(), CameraLocation);
+
+				if (DistSquared > BestDistSquared)
+				{
+					BestDistSquared = DistSquared;
+					BestIndex = i;
+				}
+			}
+
+			return BestIndex;
+		}
+	}
+
+	// evict the oldest ragdoll
+	double BestStartTime = Candidate.StartTime;
+
+	for (int32 i = 0; i < ActiveRagdolls.Num(); ++i)
+	{
+		if (ActiveRagdolls[i].StartTime <= BestStartTime)
+		{
+			BestStartTime = ActiveRagdolls[i].StartTime;
+			BestIndex = i;
+		}
+	}
+
+	return BestIndex;
+}
+
+void UCombatRagdollSubsystem::FreezePose(USkeletalMeshComponent* Mesh)
+{
+	// stop updating the skeleton so the last simulated pose is kept as a snapshot
+	Mesh->bNoSkeletonUpdate = true;
+	Mesh->SetComponentTickEnabled(false);
+
+	// take the bodies out of the simulation
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+
+	UE_LOG(LogCombatRagdoll, Verbose, TEXT("Froze ragdoll pose for %s"), *GetNameSafe(Mesh->GetOwner()));
+}
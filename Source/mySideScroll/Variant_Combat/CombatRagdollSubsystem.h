@@ -0,0 +1,88 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatRagdollSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogCombatRagdoll, Log, All);
+
+/**
+ *  Bookkeeping for a single skeletal mesh that is using ragdoll physics
+ */
+struct FCombatRagdollEntry
+{
+	/** Mesh that is simulating */
+	TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+	/** World time at which the simulation started */
+	double StartTime = 0.0;
+};
+
+/**
+ *  Caps the number of skeletal meshes simulating ragdoll physics at the same time.
+ *  - Full death ragdolls over budget evict the oldest or farthest ragdoll, which is frozen in its current pose
+ *  - Partial hit reaction ragdolls over budget are skipped
+ *  Budgets and the eviction policy are controlled through the Combat.Ragdoll.* console variables
+ */
+UCLASS()
+class UCombatRagdollSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Meshes currently simulating a full death ragdoll */
+	TArray<FCombatRagdollEntry> ActiveRagdolls;
+
+	/** Meshes currently simulating a partial hit reaction ragdoll */
+	TArray<FCombatRagdollEntry> ActiveHitReactions;
+
+public:
+
+	/** Initialization */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+
+	/**
+	 *  Starts full ragdoll physics on the provided mesh, evicting another ragdoll if we're over budget.
+	 *  Returns false if the mesh itself was chosen for eviction, in which case the caller should use a cheap death instead.
+	 */
+	bool RequestRagdoll(USkeletalMeshComponent* Mesh);
+
+	/** Starts partial hit reaction physics on the provided mesh. Returns false and does nothing if we're over budget */
+	bool RequestHitReaction(USkeletalMeshComponent* Mesh, FName PelvisBoneName);
+
+	/** Ends partial hit reaction physics on the provided mesh */
+	void EndHitReaction(USkeletalMeshComponent* Mesh);
+
+	/** Removes the mesh from all budgets. Called when the owning actor is reset or removed from the level */
+	void ReleaseMesh(USkeletalMeshComponent* Mesh);
+
+	/** Removes the mesh from all budgets and returns it to animation, undoing any simulation or frozen pose */
+	void ResetMesh(USkeletalMeshComponent* Mesh, ECollisionEnabled::Type CollisionEnabled);
+
+	/** Returns the number of meshes currently simulating full ragdolls */
+	int32 GetNumActiveRagdolls() const { return ActiveRagdolls.Num(); }
+
+	/** Returns the number of meshes currently simulating hit reactions */
+	int32 GetNumActiveHitReactions() const { return ActiveHitReactions.Num(); }
+
+protected:
+
+	/** Removes stale entries from the provided list */
+	void PruneInvalidEntries(TArray<FCombatRagdollEntry>& Entries);
+
+	/** Chooses which ragdoll to evict according to the eviction policy. May return the candidate index */
+	int32 FindEvictionIndex(const FCombatRagdollEntry& Candidate) const;
+
+	/** Stops simulating the mesh and freezes it in its current pose */
+	void FreezePose(USkeletalMeshComponent* Mesh);
+};
@@ -2,6 +2,7 @@
 
 
 #include "PlatformingCharacter.h"
+#include "mySideScroll.h"
 
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
@@ -10,8 +11,8 @@
 #include "Camera/CameraComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
-#include "TimerManager.h"
 #include "Engine/LocalPlayer.h"
+#include "InputLatencyTracker.h"
 
 APlatformingCharacter::APlatformingCharacter()
 {
@@ -102,6 +103,8 @@ void APlatformingCharacter::Dash()
 
 void APlatformingCharacter::MultiJump()
 {
+	SIDESCROLL_SCOPE(PlatformingMultiJump);
+
 	// ignore jumps while dashing
 	if(bIsDashing)
 		return;
@@ -136,6 +139,7 @@ void APlatformingCharacter::MultiJump()
 				const FVector WallJumpImpulse = (OutHit.ImpactNormal * WallJumpBounceImpulse) + (FVector::UpVector * WallJumpVerticalImpulse);
 
 				LaunchCharacter(WallJumpImpulse, true, true);
+				FInputLatencyTracker::EndAction(EInputLatencyAction::Jump);
 
 				// enable the jump trail
 				SetJumpTrailState(true);
@@ -143,7 +147,10 @@ void APlatformingCharacter::MultiJump()
 				// raise the wall jump flag to prevent an immediate second wall jump
 				bHasWallJumped = true;
 
-				GetWorld()->GetTimerManager().SetTimer(WallJumpTimer, this, &APlatformingCharacter::ResetWallJump, DelayBetweenWallJumps, false);
+				if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+				{
+					Timers->SetTimer(WallJumpTimer, this, &APlatformingCharacter::ResetWallJump, DelayBetweenWallJumps);
+				}
 			}
 			// no wall jump, try a double jump next
 			else
@@ -219,6 +226,9 @@ void APlatformingCharacter::DoDash()
 	if (bHasDashed)
 		return;
 
+	// start measuring the dash input latency
+	FInputLatencyTracker::BeginAction(EInputLatencyAction::Dash);
+
 	// raise the dash flags
 	bIsDashing = true;
 	bHasDashed = true;
@@ -240,15 +250,28 @@ void APlatformingCharacter::DoDash()
 		// has the montage played successfully?
 		if (MontageLength > 0.0f)
 		{
+			FInputLatencyTracker::EndAction(EInputLatencyAction::Dash);
 			AnimInstance->Montage_SetEndDelegate(OnDashMontageEnded, DashMontage);
 		}
 	}
+
+	// drop the sample if the montage couldn't play
+	FInputLatencyTracker::CancelAction(EInputLatencyAction::Dash);
 }
 
 void APlatformingCharacter::DoJumpStart()
 {
+	// start measuring the jump input latency
+	FInputLatencyTracker::BeginAction(EInputLatencyAction::Jump);
+
 	// handle special jump cases
 	MultiJump();
+
+	// the jump is measured once the movement component executes it, drop the sample if no jump is coming
+	if (!bPressedJump || !CanJump())
+	{
+		FInputLatencyTracker::CancelAction(EInputLatencyAction::Jump);
+	}
 }
 
 void APlatformingCharacter::DoJumpEnd()
@@ -300,7 +323,10 @@ void APlatformingCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 
 	// clear the wall jump reset timer
-	GetWorld()->GetTimerManager().ClearTimer(WallJumpTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(WallJumpTimer);
+	}
 }
 
 void APlatformingCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
@@ -337,3 +363,14 @@ void APlatformingCharacter::Landed(const FHitResult& Hit)
 	SetJumpTrailState(false);
 }
 
+void APlatformingCharacter::OnJumped_Implementation()
+{
+	Super::OnJumped_Implementation();
+
+	// the jump has executed on the movement component. Only our own input is being measured, not remote players or AI
+	if (IsLocallyControlled() && IsPlayerControlled())
+	{
+		FInputLatencyTracker::EndAction(EInputLatencyAction::Jump);
+	}
+}
+
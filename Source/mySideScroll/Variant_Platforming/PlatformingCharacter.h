@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Animation/AnimInstance.h"
+#include "GameplayTimerSubsystem.h"
 #include "PlatformingCharacter.generated.h"
 
 
@@ -136,6 +137,9 @@ public:
 	/** Handle landings to reset dash and advanced jump state */
 	virtual void Landed(const FHitResult& Hit) override;
 
+	/** Records the jump input latency once the jump actually executes */
+	virtual void OnJumped_Implementation() override;
+
 protected:
 
 	/** movement state flag bits, packed into a uint8 for memory efficiency */
@@ -145,7 +149,7 @@ protected:
 	uint8 bIsDashing : 1;
 
 	/** timer for wall jump input reset */
-	FTimerHandle WallJumpTimer;
+	FGameplayTimerHandle WallJumpTimer;
 
 	/** Dash montage ended delegate */
 	FOnMontageEnded OnDashMontageEnded;
@@ -2,8 +2,24 @@
 
 
 #include "Variant_Platforming/PlatformingGameMode.h"
+#include "StartupProfiler.h"
 
 APlatformingGameMode::APlatformingGameMode()
 {
 	// stub
-}
\ No newline at end of file
+}
+
+void APlatformingGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// report the map load and menu to gameplay transition times once the first gameplay frame has ticked
+	FStartupProfiler::MarkFirstPlayableFrameNextTick(GetWorld());
+}
+
+APawn* APlatformingGameMode::SpawnDefaultPawnFor_Implementation(AController* NewPlayer, AActor* StartSpot)
+{
+	SIDESCROLL_STARTUP_SCOPE("PawnSpawn");
+
+	return Super::SpawnDefaultPawnFor_Implementation(NewPlayer, StartSpot);
+}
@@ -18,4 +18,12 @@ public:
 
 	/** Constructor */
 	APlatformingGameMode();
+
+protected:
+
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
+	/** Times the player pawn spawn */
+	virtual APawn* SpawnDefaultPawnFor_Implementation(AController* NewPlayer, AActor* StartSpot) override;
 };
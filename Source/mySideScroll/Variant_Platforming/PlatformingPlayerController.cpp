@@ -4,11 +4,11 @@
 #include "Variant_Platforming/PlatformingPlayerController.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
-#include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "PlatformingCharacter.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
+#include "ActorRegistrySubsystem.h"
 
 void APlatformingPlayerController::SetupInputComponent()
 {
@@ -28,18 +28,35 @@ void APlatformingPlayerController::OnPossess(APawn* InPawn)
 
 	// subscribe to the pawn's OnDestroyed delegate
 	InPawn->OnDestroyed.AddDynamic(this, &APlatformingPlayerController::OnPawnDestroyed);
+
+	// register the pawn as a player with the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(InPawn, EActorRegistryCategory::Player);
+	}
+}
+
+void APlatformingPlayerController::OnUnPossess()
+{
+	// unregister the pawn from the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(GetPawn(), EActorRegistryCategory::Player);
+	}
+
+	Super::OnUnPossess();
 }
 
 void APlatformingPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 {
 	// find the player start
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
+	UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>();
+	AActor* PlayerStart = Registry ? Registry->GetFirstActor(EActorRegistryCategory::PlayerStart) : nullptr;
 
-	if (ActorList.Num() > 0)
+	if (IsValid(PlayerStart))
 	{
 		// spawn a character at the player start
-		const FTransform SpawnTransform = ActorList[0]->GetActorTransform();
+		const FTransform SpawnTransform = PlayerStart->GetActorTransform();
 
 		if (APlatformingCharacter* RespawnedCharacter = GetWorld()->SpawnActor<APlatformingCharacter>(CharacterClass, SpawnTransform))
 		{
@@ -2,10 +2,13 @@
 
 
 #include "SideScrollingAIController.h"
+#include "SideScrollMemory.h"
 #include "GameplayStateTreeModule/Public/Components/StateTreeAIComponent.h"
 
 ASideScrollingAIController::ASideScrollingAIController()
 {
+	LLM_SCOPE_BYTAG(SideScroll_AI);
+
 	// create the StateTree AI Component
 	StateTreeAI = CreateDefaultSubobject<UStateTreeAIComponent>(TEXT("StateTreeAI"));
 	check(StateTreeAI);
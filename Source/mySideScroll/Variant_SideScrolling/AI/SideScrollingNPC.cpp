@@ -3,7 +3,9 @@
 
 #include "SideScrollingNPC.h"
 #include "GameFramework/CharacterMovementComponent.h"
-#include "TimerManager.h"
+#include "ActorRegistrySubsystem.h"
+#include "SideScrollingCullingSubsystem.h"
+#include "Engine/World.h"
 
 ASideScrollingNPC::ASideScrollingNPC()
 {
@@ -12,12 +14,38 @@ ASideScrollingNPC::ASideScrollingNPC()
 	GetCharacterMovement()->MaxWalkSpeed = 150.0f;
 }
 
+void ASideScrollingNPC::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// register with the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(this, EActorRegistryCategory::Interactable);
+	}
+
+	// stop ticking while off screen. Spawned NPCs aren't picked up with the level actors
+	if (USideScrollingCullingSubsystem* Culling = GetWorld()->GetSubsystem<USideScrollingCullingSubsystem>())
+	{
+		Culling->RegisterActor(this);
+	}
+}
+
 void ASideScrollingNPC::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
 	// clear the deactivation timer
-	GetWorld()->GetTimerManager().ClearTimer(DeactivationTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(DeactivationTimer);
+	}
+
+	// unregister from the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(this, EActorRegistryCategory::Interactable);
+	}
 }
 
 void ASideScrollingNPC::Interaction(AActor* Interactor)
@@ -42,7 +70,10 @@ void ASideScrollingNPC::Interaction(AActor* Interactor)
 	LaunchCharacter(LaunchVector, true, true);
 
 	// set up a timer to schedule reactivation
-	GetWorld()->GetTimerManager().SetTimer(DeactivationTimer, this, &ASideScrollingNPC::ResetDeactivation, DeactivationTime, false);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->SetTimer(DeactivationTimer, this, &ASideScrollingNPC::ResetDeactivation, DeactivationTime);
+	}
 }
 
 void ASideScrollingNPC::ResetDeactivation()
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "SideScrollingInteractable.h"
+#include "GameplayTimerSubsystem.h"
 #include "SideScrollingNPC.generated.h"
 
 /**
@@ -38,7 +39,7 @@ public:
 	bool bDeactivated = false;
 
 	/** Timer to reactivate the NPC */
-	FTimerHandle DeactivationTimer;
+	FGameplayTimerHandle DeactivationTimer;
 
 public:
 
@@ -47,6 +48,9 @@ public:
 
 public:
 
+	/** Initialization */
+	virtual void BeginPlay() override;
+
 	/** Cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
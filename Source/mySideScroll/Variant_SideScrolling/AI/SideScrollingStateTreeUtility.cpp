@@ -2,18 +2,39 @@
 
 
 #include "SideScrollingStateTreeUtility.h"
+#include "mySideScroll.h"
 #include "StateTreeExecutionContext.h"
 #include "StateTreeExecutionTypes.h"
 #include "AIController.h"
 #include "Kismet/GameplayStatics.h"
+#include "ActorRegistrySubsystem.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SideScrollingCharacter.h"
+#include "Engine/World.h"
 
 EStateTreeRunStatus FStateTreeGetPlayerTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
+	SIDESCROLL_SCOPE(StateTreeGetPlayerTick);
+
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// set the player pawn as the target
-	InstanceData.TargetPlayer = UGameplayStatics::GetPlayerPawn(InstanceData.Controller.Get(), 0);
+	// set the closest registered player pawn as the target
+	UActorRegistrySubsystem* Registry = UActorRegistrySubsystem::Get(InstanceData.Controller.Get());
+
+	if (Registry && IsValid(InstanceData.NPC))
+	{
+		InstanceData.TargetPlayer = Registry->GetNearestPlayerPawn(InstanceData.NPC->GetActorLocation());
+	}
+	else if (Registry)
+	{
+		InstanceData.TargetPlayer = Registry->GetPlayerPawn();
+	}
+	else
+	{
+		InstanceData.TargetPlayer = UGameplayStatics::GetPlayerPawn(InstanceData.Controller.Get(), 0);
+	}
 
 	// are the NPC and target valid?
 	if (IsValid(InstanceData.TargetPlayer) && IsValid(InstanceData.NPC))
@@ -29,4 +50,116 @@ FText FStateTreeGetPlayerTask::GetDescription(const FGuid& ID, FStateTreeDataVie
 {
 	return FText::FromString("<b>Get Player</b>");
 }
-#endif // WITH_EDITOR
\ No newline at end of file
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+/** Finds a new platform path to the target. Returns false if the target can't be reached */
+static bool UpdatePlatformPath(FStateTreeMoveAlongPlatformPathInstanceData& InstanceData)
+{
+	const UWorld* World = InstanceData.Character->GetWorld();
+	const UPlatformGraphSubsystem* PlatformGraph = World->GetSubsystem<UPlatformGraphSubsystem>();
+
+	InstanceData.LastPathTime = World->GetTimeSeconds();
+	InstanceData.CurrentPoint = 0;
+
+	// only side scrolling characters can pass through soft platforms, everyone else has to path around them
+	const bool bCanPassThroughSoft = InstanceData.Character->IsA<ASideScrollingCharacter>();
+
+	return PlatformGraph && PlatformGraph->FindPath(InstanceData.Character->GetActorLocation(), InstanceData.TargetActor->GetActorLocation(), bCanPassThroughSoft, InstanceData.Path);
+}
+
+EStateTreeRunStatus FStateTreeMoveAlongPlatformPathTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	SIDESCROLL_SCOPE(StateTreeMoveAlongPlatformPathEnterState);
+
+	// have we transitioned from another state?
+	if (Transition.ChangeType == EStateTreeStateChangeType::Changed)
+	{
+		// get the instance data
+		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+		if (!IsValid(InstanceData.Character) || !IsValid(InstanceData.TargetActor) || !UpdatePlatformPath(InstanceData))
+		{
+			return EStateTreeRunStatus::Failed;
+		}
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FStateTreeMoveAlongPlatformPathTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	SIDESCROLL_SCOPE(StateTreeMoveAlongPlatformPathTick);
+
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	ACharacter* Character = InstanceData.Character;
+
+	if (!IsValid(Character) || !IsValid(InstanceData.TargetActor))
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	const bool bFalling = Character->GetCharacterMovement()->IsFalling();
+
+	// follow a moving target, but only replan while grounded so we don't abandon a jump midair
+	if (!bFalling && Character->GetWorld()->GetTimeSeconds() - InstanceData.LastPathTime >= InstanceData.RepathInterval)
+	{
+		if (!UpdatePlatformPath(InstanceData))
+		{
+			return EStateTreeRunStatus::Failed;
+		}
+	}
+
+	// have we reached the end of the path?
+	if (!InstanceData.Path.Points.IsValidIndex(InstanceData.CurrentPoint))
+	{
+		return EStateTreeRunStatus::Succeeded;
+	}
+
+	const FPlatformPathPoint& Point = InstanceData.Path.Points[InstanceData.CurrentPoint];
+	const float DeltaX = Point.Location.X - Character->GetActorLocation().X;
+
+	// steer towards the point. Keep steering midair so air control carries us onto the next platform
+	if (FMath::Abs(DeltaX) > InstanceData.AcceptanceRadius || bFalling)
+	{
+		Character->AddMovementInput(FVector::ForwardVector, FMath::Sign(DeltaX));
+		return EStateTreeRunStatus::Running;
+	}
+
+	// we've reached the point, traverse the link to the next platform
+	switch (Point.Link)
+	{
+	case EPlatformLinkType::Jump:
+
+		Character->Jump();
+		break;
+
+	case EPlatformLinkType::DropThrough:
+
+		// only side scrolling characters can pass through soft platforms
+		if (ASideScrollingCharacter* SideScrollingCharacter = Cast<ASideScrollingCharacter>(Character))
+		{
+			SideScrollingCharacter->SetSoftCollision(true);
+		}
+		break;
+
+	default:
+
+		// walk, drop and jump pad links are traversed by moving on to the next point
+		break;
+	}
+
+	++InstanceData.CurrentPoint;
+
+	return EStateTreeRunStatus::Running;
+}
+
+#if WITH_EDITOR
+FText FStateTreeMoveAlongPlatformPathTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Move Along Platform Path</b>");
+}
+#endif // WITH_EDITOR
@@ -4,10 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "StateTreeTaskBase.h"
+#include "PlatformGraphSubsystem.h"
 
 #include "SideScrollingStateTreeUtility.generated.h"
 
 class AAIController;
+class ACharacter;
 
 /**
  *  Instance data for the FStateTreeGetPlayerTask task
@@ -56,4 +58,63 @@ struct FStateTreeGetPlayerTask : public FStateTreeTaskCommonBase
 #if WITH_EDITOR
 	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
 #endif // WITH_EDITOR
-};
\ No newline at end of file
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data for the FStateTreeMoveAlongPlatformPathTask task
+ */
+USTRUCT()
+struct FStateTreeMoveAlongPlatformPathInstanceData
+{
+	GENERATED_BODY()
+
+	/** Character owning this task */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<ACharacter> Character;
+
+	/** Actor to move to */
+	UPROPERTY(EditAnywhere, Category = Input)
+	TObjectPtr<AActor> TargetActor;
+
+	/** Horizontal distance at which a path point is considered reached */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0, Units = "cm"))
+	float AcceptanceRadius = 50.0f;
+
+	/** Time between path updates while following a moving target */
+	UPROPERTY(EditAnywhere, Category = Parameter, meta = (ClampMin = 0, Units = "s"))
+	float RepathInterval = 1.0f;
+
+	/** Path currently being followed */
+	FPlatformPath Path;
+
+	/** Index of the path point currently being moved to */
+	int32 CurrentPoint = 0;
+
+	/** World time of the last path update */
+	double LastPathTime = 0.0;
+};
+
+/**
+ *  StateTree task to move a character to a target along the platform graph, jumping and dropping between platforms
+ */
+USTRUCT(meta=(DisplayName="Move Along Platform Path", Category="Side Scrolling"))
+struct FStateTreeMoveAlongPlatformPathTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeMoveAlongPlatformPathInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
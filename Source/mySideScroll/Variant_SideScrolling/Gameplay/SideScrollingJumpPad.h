@@ -31,6 +31,9 @@ public:
 	/** Constructor */
 	ASideScrollingJumpPad();
 
+	/** Returns the vertical launch velocity, used by the AI platform graph to find reachable platforms */
+	float GetZStrength() const { return ZStrength; }
+
 protected:
 
 	UFUNCTION()
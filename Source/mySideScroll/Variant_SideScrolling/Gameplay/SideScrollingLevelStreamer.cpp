@@ -0,0 +1,374 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingLevelStreamer.h"
+#include "SideScrollingTickSuppressionSubsystem.h"
+#include "mySideScroll.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "Engine/World.h"
+#include "Components/SceneComponent.h"
+#include "EngineUtils.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/HUD.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+DEFINE_LOG_CATEGORY(LogSideScrollingStreaming);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streaming Active Chunks"), STAT_SideScrollingActiveChunks, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streaming Dormant Actors"), STAT_SideScrollingDormantActors, STATGROUP_SideScroll);
+
+TRACE_DECLARE_INT_COUNTER(SideScrollingActiveChunks, TEXT("SideScrolling/Streaming/ActiveChunks"));
+TRACE_DECLARE_INT_COUNTER(SideScrollingDormantActors, TEXT("SideScrolling/Streaming/DormantActors"));
+
+static FAutoConsoleCommandWithWorld CCmdSideScrollingStreamingStats(
+	TEXT("SideScrolling.Streaming.Stats"),
+	TEXT("Logs the active chunks and dormant actors of the side scrolling level streamers."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		for (TActorIterator<ASideScrollingLevelStreamer> It(World); It; ++It)
+		{
+			It->LogStats();
+		}
+	}));
+
+ASideScrollingLevelStreamer::ASideScrollingLevelStreamer()
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	// create the root so the streamer can be placed at the start of the level
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void ASideScrollingLevelStreamer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetActorTickInterval(UpdateInterval);
+
+	Chunks.SetNum(FMath::Max(ChunkLevels.Num(), 1));
+	ChunkStreamingLevels.SetNum(ChunkLevels.Num());
+
+	// sort the persistent level actors into chunks
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		AActor* Actor = *It;
+
+		// skip actors that aren't tied to a place in the level
+		if (Actor == this || Actor->GetLevel() != GetLevel() || !Actor->GetRootComponent() || Actor->IsA<AInfo>() || Actor->IsA<AController>() || Actor->IsA<APlayerCameraManager>() || Actor->IsA<AHUD>())
+		{
+			continue;
+		}
+
+		// never put the player to sleep
+		if (const APawn* Pawn = Cast<APawn>(Actor))
+		{
+			if (Pawn->IsPlayerControlled())
+			{
+				continue;
+			}
+		}
+
+		const int32 ChunkIndex = GetChunkIndex(Actor->GetActorLocation().X);
+
+		if (ChunkIndex >= Chunks.Num())
+		{
+			Chunks.SetNum(ChunkIndex + 1);
+		}
+
+		Chunks[ChunkIndex].Actors.Add(Actor);
+
+		// actors that can move are sorted again as they cross chunk borders
+		if (Actor->IsRootComponentMovable())
+		{
+			MovableActors.Add({ Actor, ChunkIndex });
+		}
+	}
+
+	double MinX = GetActorLocation().X;
+	double MaxX = MinX;
+	GetPlayersSpan(MinX, MaxX);
+
+	LastCenterX = (MinX + MaxX) * 0.5;
+
+	UpdateWindow(MinX, MaxX, true);
+}
+
+void ASideScrollingLevelStreamer::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// don't leave actors asleep if the streamer goes away mid game
+	if (EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		for (FSideScrollingChunkState& Chunk : Chunks)
+		{
+			WakeChunk(Chunk);
+		}
+	}
+}
+
+void ASideScrollingLevelStreamer::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	double MinX = 0.0;
+	double MaxX = 0.0;
+
+	if (GetPlayersSpan(MinX, MaxX))
+	{
+		UpdateWindow(MinX, MaxX, false);
+	}
+}
+
+int32 ASideScrollingLevelStreamer::GetChunkIndex(double X) const
+{
+	return FMath::Max(FMath::FloorToInt32((X - GetActorLocation().X) / ChunkSize), 0);
+}
+
+bool ASideScrollingLevelStreamer::GetPlayersSpan(double& OutMinX, double& OutMaxX) const
+{
+	bool bFoundPawn = false;
+
+	// player states replicate to every machine, so clients keep the other players' chunks active too
+	if (const AGameStateBase* GameState = GetWorld()->GetGameState())
+	{
+		for (const APlayerState* PlayerState : GameState->PlayerArray)
+		{
+			const APawn* Pawn = PlayerState ? PlayerState->GetPawn() : nullptr;
+
+			if (!Pawn)
+			{
+				continue;
+			}
+
+			const double X = Pawn->GetActorLocation().X;
+
+			OutMinX = bFoundPawn ? FMath::Min(OutMinX, X) : X;
+			OutMaxX = bFoundPawn ? FMath::Max(OutMaxX, X) : X;
+			bFoundPawn = true;
+		}
+	}
+
+	if (bFoundPawn)
+	{
+		return true;
+	}
+
+	// nobody is possessed yet, so follow the local camera
+	const APlayerController* PC = GetWorld()->GetFirstPlayerController();
+
+	if (!PC || !PC->PlayerCameraManager)
+	{
+		return false;
+	}
+
+	OutMinX = OutMaxX = PC->PlayerCameraManager->GetCameraLocation().X;
+	return true;
+}
+
+void ASideScrollingLevelStreamer::UpdateWindow(double MinX, double MaxX, bool bForce)
+{
+	const double CenterX = (MinX + MaxX) * 0.5;
+
+	// keep the last direction while the players are still
+	if (!FMath::IsNearlyEqual(CenterX, LastCenterX, 1.0))
+	{
+		ScrollDirection = CenterX > LastCenterX ? 1.0f : -1.0f;
+	}
+
+	LastCenterX = CenterX;
+
+	// move the actors that crossed a chunk border before updating the chunks
+	UpdateMovableActors();
+
+	// extend the window further in the scrolling direction
+	const double WindowMin = MinX - (ScrollDirection > 0.0f ? LookbehindDistance : LookaheadDistance);
+	const double WindowMax = MaxX + (ScrollDirection > 0.0f ? LookaheadDistance : LookbehindDistance);
+
+	const double OriginX = GetActorLocation().X;
+
+	int32 NumActive = 0;
+	int32 NumDormant = 0;
+
+	for (int32 i = 0; i < Chunks.Num(); ++i)
+	{
+		const double ChunkMin = OriginX + i * ChunkSize;
+		const double ChunkMax = ChunkMin + ChunkSize;
+
+		bool bActive = Chunks[i].bActive;
+
+		if (ChunkMax >= WindowMin && ChunkMin <= WindowMax)
+		{
+			bActive = true;
+		}
+		else if (ChunkMax < WindowMin - UnloadMargin || ChunkMin > WindowMax + UnloadMargin)
+		{
+			bActive = false;
+		}
+
+		if (bForce || bActive != Chunks[i].bActive)
+		{
+			SetChunkActive(i, bActive);
+		}
+
+		NumActive += Chunks[i].bActive ? 1 : 0;
+		NumDormant += Chunks[i].bActive ? 0 : Chunks[i].Actors.Num();
+	}
+
+	SET_DWORD_STAT(STAT_SideScrollingActiveChunks, NumActive);
+	SET_DWORD_STAT(STAT_SideScrollingDormantActors, NumDormant);
+
+	TRACE_COUNTER_SET(SideScrollingActiveChunks, NumActive);
+	TRACE_COUNTER_SET(SideScrollingDormantActors, NumDormant);
+}
+
+void ASideScrollingLevelStreamer::UpdateMovableActors()
+{
+	for (int32 i = MovableActors.Num() - 1; i >= 0; --i)
+	{
+		FSideScrollingMovableActor& Movable = MovableActors[i];
+		AActor* Actor = Movable.Actor.Get();
+
+		if (!Actor)
+		{
+			MovableActors.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		const int32 ChunkIndex = GetChunkIndex(Actor->GetActorLocation().X);
+
+		if (ChunkIndex == Movable.ChunkIndex)
+		{
+			continue;
+		}
+
+		// new chunks past the end start active, the window update sorts them out
+		if (ChunkIndex >= Chunks.Num())
+		{
+			Chunks.SetNum(ChunkIndex + 1);
+		}
+
+		Chunks[Movable.ChunkIndex].Actors.RemoveSingleSwap(Actor, EAllowShrinking::No);
+
+		FSideScrollingChunkState& NewChunk = Chunks[ChunkIndex];
+		NewChunk.Actors.Add(Actor);
+
+		// take on the new chunk's dormancy
+		if (USideScrollingTickSuppressionSubsystem* TickSuppression = GetWorld()->GetSubsystem<USideScrollingTickSuppressionSubsystem>())
+		{
+			if (NewChunk.bActive)
+			{
+				TickSuppression->Release(Actor, ESideScrollingTickSuppression::Streaming);
+			}
+			else
+			{
+				TickSuppression->Suppress(Actor, ESideScrollingTickSuppression::Streaming);
+			}
+		}
+
+		Movable.ChunkIndex = ChunkIndex;
+	}
+}
+
+void ASideScrollingLevelStreamer::SetChunkActive(int32 ChunkIndex, bool bActive)
+{
+	FSideScrollingChunkState& Chunk = Chunks[ChunkIndex];
+	Chunk.bActive = bActive;
+
+	// stream the chunk sublevel
+	if (ChunkLevels.IsValidIndex(ChunkIndex) && !ChunkLevels[ChunkIndex].IsNull())
+	{
+		TObjectPtr<ULevelStreamingDynamic>& StreamingLevel = ChunkStreamingLevels[ChunkIndex];
+
+		if (bActive && !StreamingLevel)
+		{
+			// starts an async load. The level is made visible once loaded
+			bool bSuccess = false;
+			StreamingLevel = ULevelStreamingDynamic::LoadLevelInstanceBySoftObjectPtr(this, ChunkLevels[ChunkIndex], FVector::ZeroVector, FRotator::ZeroRotator, bSuccess);
+
+			if (!bSuccess)
+			{
+				UE_LOG(LogSideScrollingStreaming, Warning, TEXT("Failed to stream chunk %d level %s"), ChunkIndex, *ChunkLevels[ChunkIndex].ToString());
+			}
+		}
+		else if (StreamingLevel)
+		{
+			StreamingLevel->SetShouldBeLoaded(bActive);
+			StreamingLevel->SetShouldBeVisible(bActive);
+		}
+	}
+
+	// wake or put the persistent level actors to sleep
+	if (bActive)
+	{
+		WakeChunk(Chunk);
+	}
+	else
+	{
+		MakeChunkDormant(Chunk);
+	}
+
+	UE_LOG(LogSideScrollingStreaming, Verbose, TEXT("Chunk %d %s"), ChunkIndex, bActive ? TEXT("activated") : TEXT("deactivated"));
+}
+
+void ASideScrollingLevelStreamer::MakeChunkDormant(FSideScrollingChunkState& Chunk)
+{
+	USideScrollingTickSuppressionSubsystem* TickSuppression = GetWorld()->GetSubsystem<USideScrollingTickSuppressionSubsystem>();
+
+	if (!TickSuppression)
+	{
+		return;
+	}
+
+	Chunk.Actors.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Actor) { return !Actor.IsValid(); }, EAllowShrinking::No);
+
+	// AI pawns sleep along with their controllers
+	for (const TWeakObjectPtr<AActor>& Actor : Chunk.Actors)
+	{
+		TickSuppression->Suppress(Actor.Get(), ESideScrollingTickSuppression::Streaming);
+	}
+}
+
+void ASideScrollingLevelStreamer::WakeChunk(FSideScrollingChunkState& Chunk)
+{
+	USideScrollingTickSuppressionSubsystem* TickSuppression = GetWorld()->GetSubsystem<USideScrollingTickSuppressionSubsystem>();
+
+	if (!TickSuppression)
+	{
+		return;
+	}
+
+	for (const TWeakObjectPtr<AActor>& Actor : Chunk.Actors)
+	{
+		TickSuppression->Release(Actor.Get(), ESideScrollingTickSuppression::Streaming);
+	}
+}
+
+void ASideScrollingLevelStreamer::LogStats() const
+{
+	int32 NumActive = 0;
+	int32 NumLoaded = 0;
+	int32 NumActors = 0;
+	int32 NumDormant = 0;
+
+	for (int32 i = 0; i < Chunks.Num(); ++i)
+	{
+		NumActive += Chunks[i].bActive ? 1 : 0;
+		NumActors += Chunks[i].Actors.Num();
+		NumDormant += Chunks[i].bActive ? 0 : Chunks[i].Actors.Num();
+
+		if (ChunkStreamingLevels.IsValidIndex(i) && ChunkStreamingLevels[i] && ChunkStreamingLevels[i]->IsLevelLoaded())
+		{
+			++NumLoaded;
+		}
+	}
+
+	UE_LOG(LogSideScrollingStreaming, Log, TEXT("%s: %d chunks of %.0f cm, %d active, %d sublevels loaded, %d of %d actors dormant"), *GetName(), Chunks.Num(), ChunkSize, NumActive, NumLoaded, NumDormant, NumActors);
+}
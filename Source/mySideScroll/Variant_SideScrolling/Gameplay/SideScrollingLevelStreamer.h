@@ -0,0 +1,135 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SideScrollingLevelStreamer.generated.h"
+
+class ULevelStreamingDynamic;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSideScrollingStreaming, Log, All);
+
+/**
+ *  Persistent level actor that can move between chunks
+ */
+struct FSideScrollingMovableActor
+{
+	/** Movable actor */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** Chunk the actor is currently sorted into */
+	int32 ChunkIndex = 0;
+};
+
+/**
+ *  Runtime state of a level chunk
+ */
+struct FSideScrollingChunkState
+{
+	/** Persistent level actors located in this chunk */
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	/** True if the chunk is inside the streaming window */
+	bool bActive = true;
+};
+
+/**
+ *  Streams a side scrolling level in fixed size chunks along the X axis
+ *  Chunks inside a window around the players are active. The window spans every player's pawn and extends further in the direction they're scrolling.
+ *  - Chunk sublevels are loaded and made visible asynchronously as they enter the window, and unloaded once they leave it
+ *  - Persistent level actors in inactive chunks stop ticking until their chunk becomes active again, through the tick suppression subsystem shared with culling
+ *  - Actors that can move are sorted into a new chunk when they cross a chunk border
+ *  Place one in the level at the left end of the playable area; chunk 0 starts at its X location.
+ */
+UCLASS()
+class ASideScrollingLevelStreamer : public AActor
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Length of each chunk along X */
+	UPROPERTY(EditAnywhere, Category="Streaming", meta=(ClampMin=100, Units="cm"))
+	float ChunkSize = 5000.0f;
+
+	/** Distance ahead of the players, in the scrolling direction, to keep active */
+	UPROPERTY(EditAnywhere, Category="Streaming", meta=(ClampMin=0, Units="cm"))
+	float LookaheadDistance = 6000.0f;
+
+	/** Distance behind the players to keep active */
+	UPROPERTY(EditAnywhere, Category="Streaming", meta=(ClampMin=0, Units="cm"))
+	float LookbehindDistance = 3000.0f;
+
+	/** Extra distance a chunk must move out of the window before it's deactivated, so chunks on the edge don't thrash */
+	UPROPERTY(EditAnywhere, Category="Streaming", meta=(ClampMin=0, Units="cm"))
+	float UnloadMargin = 1000.0f;
+
+	/** Time between streaming window updates */
+	UPROPERTY(EditAnywhere, Category="Streaming", meta=(ClampMin=0, Units="s"))
+	float UpdateInterval = 0.1f;
+
+	/** Sublevel to stream in for each chunk, in chunk order. Chunks without a level only manage actor dormancy */
+	UPROPERTY(EditAnywhere, Category="Streaming")
+	TArray<TSoftObjectPtr<UWorld>> ChunkLevels;
+
+	/** Streaming level objects for each chunk, created on first load */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ULevelStreamingDynamic>> ChunkStreamingLevels;
+
+	/** Runtime chunk state */
+	TArray<FSideScrollingChunkState> Chunks;
+
+	/** Persistent level actors with a movable root, checked against their chunk on every update */
+	TArray<FSideScrollingMovableActor> MovableActors;
+
+	/** Center of the players' X span at the last update, used to find the scrolling direction */
+	double LastCenterX = 0.0;
+
+	/** Last scrolling direction, kept while the players are still */
+	float ScrollDirection = 1.0f;
+
+public:
+
+	/** Constructor */
+	ASideScrollingLevelStreamer();
+
+protected:
+
+	/** Sorts the level actors into chunks and sets up the initial window */
+	virtual void BeginPlay() override;
+
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	/** Updates the streaming window around the players */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Logs the chunk and dormancy state */
+	void LogStats() const;
+
+protected:
+
+	/** Returns the chunk index containing the X location */
+	int32 GetChunkIndex(double X) const;
+
+	/** Returns the X span covered by all player pawns, falling back to the local camera before any pawn is possessed. Returns false if there's neither */
+	bool GetPlayersSpan(double& OutMinX, double& OutMaxX) const;
+
+	/** Updates the active chunks for the players' X span */
+	void UpdateWindow(double MinX, double MaxX, bool bForce);
+
+	/** Activates or deactivates a chunk */
+	void SetChunkActive(int32 ChunkIndex, bool bActive);
+
+	/** Moves the movable actors that crossed a chunk border into their new chunk */
+	void UpdateMovableActors();
+
+	/** Stops the chunk's actors from ticking */
+	void MakeChunkDormant(FSideScrollingChunkState& Chunk);
+
+	/** Releases the chunk's actors to tick again, unless culling holds them asleep */
+	void WakeChunk(FSideScrollingChunkState& Chunk);
+};
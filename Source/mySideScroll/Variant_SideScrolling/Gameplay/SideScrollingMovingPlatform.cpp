@@ -3,6 +3,8 @@
 
 #include "SideScrollingMovingPlatform.h"
 #include "Components/SceneComponent.h"
+#include "ActorRegistrySubsystem.h"
+#include "Engine/World.h"
 
 ASideScrollingMovingPlatform::ASideScrollingMovingPlatform()
 {
@@ -12,6 +14,28 @@ ASideScrollingMovingPlatform::ASideScrollingMovingPlatform()
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
 }
 
+void ASideScrollingMovingPlatform::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// register with the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(this, EActorRegistryCategory::Interactable);
+	}
+}
+
+void ASideScrollingMovingPlatform::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// unregister from the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(this, EActorRegistryCategory::Interactable);
+	}
+}
+
 void ASideScrollingMovingPlatform::Interaction(AActor* Interactor)
 {
 	// ignore interactions if we're already moving
@@ -2,6 +2,8 @@
 
 
 #include "SideScrollingPickup.h"
+#include "mySideScroll.h"
+#include "SideScrollMemory.h"
 #include "GameFramework/Character.h"
 #include "SideScrollingGameMode.h"
 #include "Components/SphereComponent.h"
@@ -10,6 +12,8 @@
 
 ASideScrollingPickup::ASideScrollingPickup()
 {
+	LLM_SCOPE_BYTAG(SideScroll_Pickups);
+
 	PrimaryActorTick.bCanEverTick = false;
 
 	// create the root comp
@@ -32,6 +36,8 @@ ASideScrollingPickup::ASideScrollingPickup()
 
 void ASideScrollingPickup::BeginOverlap(AActor* OverlappedActor, AActor* OtherActor)
 {
+	SIDESCROLL_SCOPE(SideScrollingPickupOverlap);
+
 	// have we collided against a character?
 	if (ACharacter* OverlappedCharacter = Cast<ACharacter>(OtherActor))
 	{
@@ -42,7 +48,7 @@ void ASideScrollingPickup::BeginOverlap(AActor* OverlappedActor, AActor* OtherAc
 			if (ASideScrollingGameMode* GM = Cast<ASideScrollingGameMode>(GetWorld()->GetAuthGameMode()))
 			{
 				// tell the game mode to process a pickup
-				GM->ProcessPickup();
+				GM->ProcessPickup(this);
 
 				// disable collision so we don't get picked up again
 				SetActorEnableCollision(false);
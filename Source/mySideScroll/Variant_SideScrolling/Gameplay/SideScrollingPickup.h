@@ -21,11 +21,20 @@ class ASideScrollingPickup : public AActor
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category ="Components", meta = (AllowPrivateAccess = "true"))
 	USphereComponent* Sphere;
 
+	/** Index of this pickup in the level's saved progress. Assigned by the game mode */
+	int32 PickupIndex = INDEX_NONE;
+
 public:
 
 	/** Constructor */
 	ASideScrollingPickup();
 
+	/** Returns the index of this pickup in the level's saved progress */
+	int32 GetPickupIndex() const { return PickupIndex; }
+
+	/** Sets the index of this pickup in the level's saved progress */
+	void SetPickupIndex(int32 NewIndex) { PickupIndex = NewIndex; }
+
 protected:
 
 	/** Handles pickup collision */
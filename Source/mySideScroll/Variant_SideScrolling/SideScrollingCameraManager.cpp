@@ -2,6 +2,7 @@
 
 
 #include "SideScrollingCameraManager.h"
+#include "mySideScroll.h"
 #include "GameFramework/Pawn.h"
 #include "Engine/HitResult.h"
 #include "CollisionQueryParams.h"
@@ -9,6 +10,8 @@
 
 void ASideScrollingCameraManager::UpdateViewTarget(FTViewTarget& OutVT, float DeltaTime)
 {
+	SIDESCROLL_SCOPE(SideScrollingCameraUpdate);
+
 	// ensure the view target is a pawn
 	APawn* TargetPawn = Cast<APawn>(OutVT.Target);
 
@@ -2,7 +2,8 @@
 
 
 #include "SideScrollingCharacter.h"
-#include "GameFramework/CharacterMovementComponent.h"
+#include "mySideScroll.h"
+#include "SideScrollingMovementComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Components/InputComponent.h"
@@ -12,9 +13,12 @@
 #include "Engine/World.h"
 #include "SideScrollingInteractable.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "TimerManager.h"
+#include "SideScrollingPlayerController.h"
+#include "InputLatencyTracker.h"
+#include "Net/UnrealNetwork.h"
 
-ASideScrollingCharacter::ASideScrollingCharacter()
+ASideScrollingCharacter::ASideScrollingCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USideScrollingMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -52,19 +56,58 @@ ASideScrollingCharacter::ASideScrollingCharacter()
 	GetCharacterMovement()->RotationRate = FRotator(0.0f, 750.0f, 0.0f);
 	GetCharacterMovement()->bOrientRotationToMovement = true;
 
-	GetCharacterMovement()->SetPlaneConstraintNormal(FVector(0.0f, 1.0f, 0.0f));
-	GetCharacterMovement()->bConstrainToPlane = true;
-
 	// enable double jump
 	JumpMaxCount = 2;
 }
 
+void ASideScrollingCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// the movement component runs the wall jumps and drops so they can be predicted
+	USideScrollingMovementComponent* MoveComp = CastChecked<USideScrollingMovementComponent>(GetCharacterMovement());
+	MoveComp->SetWallJumpSettings(WallJumpTraceDistance, WallJumpHorizontalImpulse, WallJumpVerticalMultiplier, DelayBetweenWallJumps);
+	MoveComp->SetSoftPlatformSettings(SoftCollisionObjectType, SoftCollisionTraceDistance);
+}
+
 void ASideScrollingCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
 	// clear the wall jump timer
-	GetWorld()->GetTimerManager().ClearTimer(WallJumpTimer);
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(WallJumpTimer);
+	}
+}
+
+void ASideScrollingCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// replaced by the 2D movement
+	DISABLE_REPLICATED_PRIVATE_PROPERTY(AActor, ReplicatedMovement);
+
+	DOREPLIFETIME_CONDITION(ASideScrollingCharacter, ReplicatedPlaneMovement, COND_SimulatedOrPhysics);
+}
+
+void ASideScrollingCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	// the actor movement has just been gathered, only send the depth if we're off the plane
+	ReplicatedPlaneMovement.FromRepMovement(GetReplicatedMovement(), CastChecked<USideScrollingMovementComponent>(GetCharacterMovement())->IsUsingPlaneFastPath());
+
+	DOREPLIFETIME_ACTIVE_OVERRIDE_FAST(ASideScrollingCharacter, ReplicatedPlaneMovement, IsReplicatingMovement());
+}
+
+void ASideScrollingCharacter::OnRep_ReplicatedPlaneMovement()
+{
+	// we're already on the plane, so keep our own depth
+	ReplicatedPlaneMovement.ToRepMovement(GetReplicatedMovement_Mutable(), GetActorLocation().Y);
+
+	// let the stock movement smoothing take it from here
+	OnRep_ReplicatedMovement();
 }
 
 void ASideScrollingCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent)
@@ -121,6 +164,17 @@ void ASideScrollingCharacter::Landed(const FHitResult& Hit)
 	bHasDoubleJumped = false;
 }
 
+void ASideScrollingCharacter::OnJumped_Implementation()
+{
+	Super::OnJumped_Implementation();
+
+	// the jump has executed on the movement component. Only our own input is being measured, not remote players or AI
+	if (IsLocallyControlled() && IsPlayerControlled())
+	{
+		FInputLatencyTracker::EndAction(EInputLatencyAction::Jump);
+	}
+}
+
 void ASideScrollingCharacter::Move(const FInputActionValue& Value)
 {
 	FVector2D MoveVector = Value.Get<FVector2D>();
@@ -165,8 +219,17 @@ void ASideScrollingCharacter::DoDrop(float Value)
 
 void ASideScrollingCharacter::DoJumpStart()
 {
+	// start measuring the jump input latency
+	FInputLatencyTracker::BeginAction(EInputLatencyAction::Jump);
+
 	// handle advanced jump behaviors
 	MultiJump();
+
+	// the jump is measured once the movement component executes it, drop the sample if no jump is coming
+	if (!bPressedJump || !CanJump())
+	{
+		FInputLatencyTracker::CancelAction(EInputLatencyAction::Jump);
+	}
 }
 
 void ASideScrollingCharacter::DoJumpEnd()
@@ -176,6 +239,9 @@ void ASideScrollingCharacter::DoJumpEnd()
 
 void ASideScrollingCharacter::DoInteract()
 {
+	// start measuring the interact input latency
+	FInputLatencyTracker::BeginAction(EInputLatencyAction::Interact);
+
 	// do a sphere trace to look for interactive objects
 	FHitResult OutHit;
 
@@ -198,16 +264,24 @@ void ASideScrollingCharacter::DoInteract()
 		if (ISideScrollingInteractable* Interactable = Cast<ISideScrollingInteractable>(OutHit.GetActor()))
 		{
 			// interact
+			FInputLatencyTracker::EndAction(EInputLatencyAction::Interact);
 			Interactable->Interaction(this);
+			return;
 		}
 	}
+
+	// nothing to interact with
+	FInputLatencyTracker::CancelAction(EInputLatencyAction::Interact);
 }
 
 void ASideScrollingCharacter::MultiJump()
 {
+	SIDESCROLL_SCOPE(SideScrollingMultiJump);
+
 	// does the user want to drop to a lower platform?
 	if (DropValue > 0.0f)
 	{
+		FInputLatencyTracker::CancelAction(EInputLatencyAction::Jump);
 		CheckForSoftCollision();
 		return;
 	}
@@ -225,35 +299,30 @@ void ASideScrollingCharacter::MultiJump()
 	// if we have a horizontal input, try for wall jump first
 	if (!bHasWallJumped && !FMath::IsNearlyZero(ActionValueY))
 	{
-		// trace ahead of the character for walls
-		FHitResult OutHit;
+		// let the movement component find the wall
+		USideScrollingMovementComponent* MoveComp = CastChecked<USideScrollingMovementComponent>(GetCharacterMovement());
 
-		const FVector Start = GetActorLocation();
-		const FVector End = Start + (FVector(ActionValueY > 0.0f ? 1.0f : -1.0f, 0.0f, 0.0f) * WallJumpTraceDistance);
+		FVector WallNormal;
 
-		FCollisionQueryParams QueryParams;
-		QueryParams.AddIgnoredActor(this);
-
-		GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
-
-		if (OutHit.bBlockingHit)
+		if (MoveComp->FindWallJumpNormal(ActionValueY, WallJumpTraceDistance, WallNormal))
 		{
+			// the launch runs in the next movement update, so it's predicted and checked by the server
+			MoveComp->RequestWallJump(ActionValueY);
+
 			// rotate to the bounce direction
-			const FRotator BounceRot = UKismetMathLibrary::MakeRotFromX(OutHit.ImpactNormal);
+			const FRotator BounceRot = UKismetMathLibrary::MakeRotFromX(WallNormal);
 			SetActorRotation(FRotator(0.0f, BounceRot.Yaw, 0.0f));
 
-			// calculate the impulse vector
-			FVector WallJumpImpulse = OutHit.ImpactNormal * WallJumpHorizontalImpulse;
-			WallJumpImpulse.Z = GetCharacterMovement()->JumpZVelocity * WallJumpVerticalMultiplier;
-
-			// launch the character away from the wall
-			LaunchCharacter(WallJumpImpulse, true, true);
+			FInputLatencyTracker::EndAction(EInputLatencyAction::Jump);
 
 			// enable wall jump lockout for a bit
 			bHasWallJumped = true;
 
 			// schedule wall jump lockout reset
-			GetWorld()->GetTimerManager().SetTimer(WallJumpTimer, this, &ASideScrollingCharacter::ResetWallJump, DelayBetweenWallJumps, false);
+			if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+			{
+				Timers->SetTimer(WallJumpTimer, this, &ASideScrollingCharacter::ResetWallJump, DelayBetweenWallJumps);
+			}
 
 			return;
 		}
@@ -279,38 +348,55 @@ void ASideScrollingCharacter::CheckForSoftCollision()
 	// reset the drop value
 	DropValue = 0.0f;
 
-	// trace down 
-	FHitResult OutHit;
-
-	const FVector Start = GetActorLocation();
-	const FVector End = Start + (FVector::DownVector * SoftCollisionTraceDistance);
-
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(SoftCollisionObjectType);
-
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	// drop through the floor if we're standing over a soft one. Runs in the next movement update so it's predicted
+	CastChecked<USideScrollingMovementComponent>(GetCharacterMovement())->RequestDropThrough();
+}
 
-	GetWorld()->LineTraceSingleByObjectType(OutHit, Start, End, ObjectParams, QueryParams);
+void ASideScrollingCharacter::ResetWallJump()
+{
+	// reset the wall jump flag
+	bHasWallJumped = false;
+}
 
-	// did we hit a soft floor?
-	if (OutHit.GetActor())
+void ASideScrollingCharacter::FellOutOfWorld(const UDamageType& DamageType)
+{
+	// let the player controller move us back to the start instead of destroying and re-spawning us
+	if (ASideScrollingPlayerController* PC = Cast<ASideScrollingPlayerController>(GetController()))
 	{
-		// drop through the floor
-		SetSoftCollision(true);
+		if (PC->RespawnPawnInPlace(this))
+		{
+			ResetForRespawn();
+			return;
+		}
 	}
+
+	Super::FellOutOfWorld(DamageType);
 }
 
-void ASideScrollingCharacter::ResetWallJump()
+void ASideScrollingCharacter::ResetForRespawn()
 {
-	// reset the wall jump flag
+	// clear the wall jump timer
+	if (UGameplayTimerSubsystem* Timers = UGameplayTimerSubsystem::Get(this))
+	{
+		Timers->ClearTimer(WallJumpTimer);
+	}
+
+	// reset the jump state
 	bHasWallJumped = false;
+	bHasDoubleJumped = false;
+	StopJumping();
+
+	// reset the captured inputs
+	ActionValueY = 0.0f;
+	DropValue = 0.0f;
+
+	// block soft collision platforms again
+	SetSoftCollision(false);
 }
 
 void ASideScrollingCharacter::SetSoftCollision(bool bEnabled)
 {
-	// enable or disable collision response to the soft collision channel
-	GetCapsuleComponent()->SetCollisionResponseToChannel(SoftCollisionObjectType, bEnabled ? ECR_Ignore : ECR_Block);
+	CastChecked<USideScrollingMovementComponent>(GetCharacterMovement())->SetPassThroughSoftPlatforms(SoftCollisionObjectType, bEnabled);
 }
 
 bool ASideScrollingCharacter::HasDoubleJumped() const
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "GameplayTimerSubsystem.h"
+#include "SideScrollingMovementComponent.h"
 #include "SideScrollingCharacter.generated.h"
 
 class UCameraComponent;
@@ -12,6 +14,8 @@ struct FInputActionValue;
 
 /**
  *  A player-controllable character side scrolling game
+ *  Supports networked co-op: wall jumps and drops are predicted through the movement component's saved moves,
+ *  and movement is replicated to other players as quantized 2D values
  */
 UCLASS(abstract)
 class ASideScrollingCharacter : public ACharacter
@@ -73,7 +77,7 @@ protected:
 	float SoftCollisionTraceDistance = 1000.0f;
 
 	/** Wall jump lockout timer */
-	FTimerHandle WallJumpTimer;
+	FGameplayTimerHandle WallJumpTimer;
 
 	/** Last captured horizontal movement input value */
 	float ActionValueY = 0.0f;
@@ -90,16 +94,29 @@ protected:
 	/** If true, this character is moving along the side scrolling axis */
 	bool bMovingHorizontally = false;
 
+	/** Movement replicated to simulated proxies in place of the actor's replicated movement */
+	UPROPERTY(ReplicatedUsing=OnRep_ReplicatedPlaneMovement)
+	FSideScrollingRepMovement ReplicatedPlaneMovement;
+
 public:
 	
-	/** Constructor */
-	ASideScrollingCharacter();
+	/** Constructor. Uses the side scrolling movement component */
+	ASideScrollingCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 
+	/** Gameplay initialization */
+	virtual void BeginPlay() override;
+
 	/** Gameplay cleanup */
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
+	/** Sets up the replicated properties */
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Copies the gathered movement into the 2D replicated movement */
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
 	/** Initialize input action bindings */
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
@@ -109,6 +126,12 @@ protected:
 	/** Landing handling */
 	virtual void Landed(const FHitResult& Hit) override;
 
+	/** Records the jump input latency once the jump actually executes */
+	virtual void OnJumped_Implementation() override;
+
+	/** Respawns in place instead of being destroyed when falling out of the level */
+	virtual void FellOutOfWorld(const class UDamageType& DamageType) override;
+
 protected:
 
 	/** Called for movement input */
@@ -153,6 +176,13 @@ protected:
 	/** Resets wall jump lockout. Called from timer after a wall jump */
 	void ResetWallJump();
 
+	/** Resets the jump and drop state so the character can be reused after respawning */
+	void ResetForRespawn();
+
+	/** Passes the received 2D movement on to the stock movement smoothing */
+	UFUNCTION()
+	void OnRep_ReplicatedPlaneMovement();
+
 public:
 
 	/** Sets the soft collision response. True passes, False blocks */
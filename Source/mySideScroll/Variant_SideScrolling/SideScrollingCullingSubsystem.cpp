@@ -0,0 +1,524 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingCullingSubsystem.h"
+#include "SideScrollingCameraManager.h"
+#include "SideScrollingLevelStreamer.h"
+#include "SideScrollingTickSuppressionSubsystem.h"
+#include "mySideScroll.h"
+#include "Components/ActorComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/HUD.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "EngineUtils.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+DEFINE_LOG_CATEGORY(LogSideScrollingCulling);
+
+DECLARE_CYCLE_STAT(TEXT("Culling Update"), STAT_SideScrollingCullingUpdate, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Culling Tracked Actors"), STAT_SideScrollingCullingTracked, STATGROUP_SideScroll);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Culling Culled Actors"), STAT_SideScrollingCullingCulled, STATGROUP_SideScroll);
+
+TRACE_DECLARE_INT_COUNTER(SideScrollingCullingTracked, TEXT("SideScrolling/Culling/Tracked"));
+TRACE_DECLARE_INT_COUNTER(SideScrollingCullingVisible, TEXT("SideScrolling/Culling/Visible"));
+
+static TAutoConsoleVariable<bool> CVarSideScrollingCullingEnabled(
+	TEXT("SideScrolling.Culling.Enabled"),
+	true,
+	TEXT("If true, actors outside of the side scrolling camera view stop ticking."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarSideScrollingCullingMargin(
+	TEXT("SideScrolling.Culling.Margin"),
+	500.0f,
+	TEXT("Distance in cm around the camera view in which actors keep ticking."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorld CCmdSideScrollingCullingStats(
+	TEXT("SideScrolling.Culling.Stats"),
+	TEXT("Logs the number of tracked, visible and culled actors."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const USideScrollingCullingSubsystem* Culling = World ? World->GetSubsystem<USideScrollingCullingSubsystem>() : nullptr)
+		{
+			Culling->LogStats();
+		}
+	}));
+
+bool USideScrollingCullingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId USideScrollingCullingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USideScrollingCullingSubsystem, STATGROUP_Tickables);
+}
+
+void USideScrollingCullingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// actors in streamed levels are picked up with their level. They unregister on their own when it's removed
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &USideScrollingCullingSubsystem::OnLevelAdded);
+}
+
+void USideScrollingCullingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// pick up the ticking actors placed in the level
+	for (TActorIterator<AActor> It(&InWorld); It; ++It)
+	{
+		RegisterPlacedActor(*It);
+	}
+
+	UE_LOG(LogSideScrollingCulling, Log, TEXT("Culling %d actors"), EntryIndices.Num());
+}
+
+void USideScrollingCullingSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	// levels added before begin play are gathered by OnWorldBeginPlay
+	if (!Level || World != GetWorld() || !World->HasBegunPlay())
+	{
+		return;
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor)
+		{
+			RegisterPlacedActor(Actor);
+		}
+	}
+}
+
+void USideScrollingCullingSubsystem::RegisterPlacedActor(AActor* Actor)
+{
+	// skip actors that aren't tied to a place in the level, and the streamer that drives the level
+	if (!Actor->GetRootComponent() || Actor->IsA<AInfo>() || Actor->IsA<AController>() || Actor->IsA<APlayerCameraManager>() || Actor->IsA<AHUD>() || Actor->IsA<ASideScrollingLevelStreamer>())
+	{
+		return;
+	}
+
+	if (CanCull(Actor))
+	{
+		RegisterActor(Actor);
+	}
+}
+
+void USideScrollingCullingSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+
+	WakeAll();
+
+	Entries.Reset();
+	FreeEntries.Reset();
+	EntryIndices.Reset();
+	SortedEntries.Reset();
+	VisibleEntries.Reset();
+	SimulatingEntries.Reset();
+
+	Super::Deinitialize();
+}
+
+void USideScrollingCullingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FSideScrollingCullingView View;
+
+	// wake everything while culling is off or the camera isn't side on
+	if (!CVarSideScrollingCullingEnabled.GetValueOnGameThread() || !GetView(View))
+	{
+		if (!bSuspended)
+		{
+			WakeAll();
+			bSuspended = true;
+		}
+
+		return;
+	}
+
+	bSuspended = false;
+
+	SCOPE_CYCLE_COUNTER(STAT_SideScrollingCullingUpdate);
+
+	const double Margin = FMath::Max(CVarSideScrollingCullingMargin.GetValueOnGameThread(), 0.0f);
+
+	// check the actors on screen, culling the ones that left the view
+	for (int32 i = VisibleEntries.Num() - 1; i >= 0; --i)
+	{
+		const int32 EntryIndex = VisibleEntries[i];
+		FSideScrollingCullingEntry& Entry = Entries[EntryIndex];
+
+		if (const AActor* Actor = Entry.Actor.Get())
+		{
+			// moving actors need their bounds refreshed while they're awake
+			if (Entry.bMovable)
+			{
+				UpdateBounds(Entry, Actor);
+			}
+
+			if (IsInView(Entry.Bounds, View, Margin) || !Cull(EntryIndex))
+			{
+				continue;
+			}
+		}
+
+		VisibleEntries.RemoveAtSwap(i, EAllowShrinking::No);
+	}
+
+	// physics keeps moving culled bodies, so check them directly. Their sort key is only refreshed once they're culled again
+	for (int32 i = SimulatingEntries.Num() - 1; i >= 0; --i)
+	{
+		const int32 EntryIndex = SimulatingEntries[i];
+		FSideScrollingCullingEntry& Entry = Entries[EntryIndex];
+		const AActor* Actor = Entry.Actor.Get();
+
+		if (!Actor || !Entry.bCulled)
+		{
+			SimulatingEntries.RemoveAtSwap(i, EAllowShrinking::No);
+			continue;
+		}
+
+		UpdateBounds(Entry, Actor);
+
+		if (IsInView(Entry.Bounds, View, Margin))
+		{
+			Wake(Entry);
+			VisibleEntries.Add(EntryIndex);
+			SimulatingEntries.RemoveAtSwap(i, EAllowShrinking::No);
+		}
+	}
+
+	// actors that moved while awake were culled at a new location
+	if (bSortDirty)
+	{
+		Algo::SortBy(SortedEntries, [this](int32 Index) { return Entries[Index].SortKey; });
+		bSortDirty = false;
+	}
+
+	// find the view's X interval at its widest depth. Only the entries starting inside it, or one extent before it, can overlap
+	const double MaxHalfWidth = FMath::Max(View.Location.Y - MinBoundsY, 0.0) * View.HalfWidthPerDepth + View.HalfSpan.X + Margin;
+	const double ViewMinX = View.Location.X - MaxHalfWidth;
+	const double ViewMaxX = View.Location.X + MaxHalfWidth;
+
+	const int32 End = Algo::UpperBoundBy(SortedEntries, ViewMaxX, [this](int32 Index) { return Entries[Index].SortKey; });
+
+	// wake the culled actors that came into view
+	for (int32 i = End - 1; i >= 0; --i)
+	{
+		const int32 EntryIndex = SortedEntries[i];
+		FSideScrollingCullingEntry& Entry = Entries[EntryIndex];
+
+		if (Entry.SortKey < ViewMinX - MaxExtentX)
+		{
+			break;
+		}
+
+		if (Entry.bCulled && IsInView(Entry.Bounds, View, Margin))
+		{
+			Wake(Entry);
+			VisibleEntries.Add(EntryIndex);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_SideScrollingCullingTracked, EntryIndices.Num());
+	SET_DWORD_STAT(STAT_SideScrollingCullingCulled, EntryIndices.Num() - VisibleEntries.Num());
+
+	TRACE_COUNTER_SET(SideScrollingCullingTracked, EntryIndices.Num());
+	TRACE_COUNTER_SET(SideScrollingCullingVisible, VisibleEntries.Num());
+}
+
+void USideScrollingCullingSubsystem::RegisterActor(AActor* Actor)
+{
+	if (!IsValid(Actor) || EntryIndices.Contains(Actor))
+	{
+		return;
+	}
+
+	// reuse a free slot if we have one
+	const int32 EntryIndex = FreeEntries.Num() > 0 ? FreeEntries.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+
+	FSideScrollingCullingEntry& Entry = Entries[EntryIndex];
+	Entry.Actor = Actor;
+	Entry.bMovable = Actor->IsRootComponentMovable();
+
+	UpdateBounds(Entry, Actor);
+	Entry.SortKey = Entry.Bounds.Min.X;
+
+	EntryIndices.Add(Actor, EntryIndex);
+
+	// keep the sorted order
+	const int32 SortedIndex = Algo::LowerBoundBy(SortedEntries, Entry.SortKey, [this](int32 Index) { return Entries[Index].SortKey; });
+	SortedEntries.Insert(EntryIndex, SortedIndex);
+
+	// the actor starts awake. It gets culled on the next update if it's off screen
+	VisibleEntries.Add(EntryIndex);
+
+	Actor->OnEndPlay.AddUniqueDynamic(this, &USideScrollingCullingSubsystem::OnActorEndPlay);
+}
+
+void USideScrollingCullingSubsystem::UnregisterActor(AActor* Actor)
+{
+	int32 EntryIndex;
+
+	if (!EntryIndices.RemoveAndCopyValue(Actor, EntryIndex))
+	{
+		return;
+	}
+
+	Wake(Entries[EntryIndex]);
+
+	SortedEntries.RemoveSingle(EntryIndex);
+	VisibleEntries.RemoveSingleSwap(EntryIndex, EAllowShrinking::No);
+	SimulatingEntries.RemoveSingleSwap(EntryIndex, EAllowShrinking::No);
+
+	Entries[EntryIndex] = FSideScrollingCullingEntry();
+	FreeEntries.Add(EntryIndex);
+
+	Actor->OnEndPlay.RemoveDynamic(this, &USideScrollingCullingSubsystem::OnActorEndPlay);
+}
+
+void USideScrollingCullingSubsystem::OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterActor(Actor);
+}
+
+void USideScrollingCullingSubsystem::LogStats() const
+{
+	const int32 NumTracked = EntryIndices.Num();
+	const int32 NumVisible = VisibleEntries.Num();
+
+	UE_LOG(LogSideScrollingCulling, Log, TEXT("%d tracked actors, %d on screen, %d culled%s"), NumTracked, NumVisible, NumTracked - NumVisible, bSuspended ? TEXT(" (suspended)") : TEXT(""));
+}
+
+bool USideScrollingCullingSubsystem::CanCull(const AActor* Actor)
+{
+	// never cull the player
+	if (const APawn* Pawn = Cast<APawn>(Actor))
+	{
+		if (Pawn->IsPlayerControlled())
+		{
+			return false;
+		}
+	}
+
+	if (Actor->PrimaryActorTick.bCanEverTick)
+	{
+		return true;
+	}
+
+	for (const UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component && Component->PrimaryComponentTick.bCanEverTick)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool USideScrollingCullingSubsystem::IsSimulatingPhysics(const AActor* Actor)
+{
+	bool bSimulating = false;
+
+	Actor->ForEachComponent<UPrimitiveComponent>(false, [&bSimulating](const UPrimitiveComponent* Primitive)
+	{
+		bSimulating |= Primitive->IsSimulatingPhysics();
+	});
+
+	return bSimulating;
+}
+
+bool USideScrollingCullingSubsystem::GetView(FSideScrollingCullingView& OutView) const
+{
+	// remote players need the world simulated outside of the host's view
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+
+	if (NetMode == NM_ListenServer || NetMode == NM_DedicatedServer)
+	{
+		return false;
+	}
+
+	FVector2D ViewportSize = FVector2D::ZeroVector;
+
+	if (UGameViewportClient* Viewport = GetWorld()->GetGameViewport())
+	{
+		Viewport->GetViewportSize(ViewportSize);
+	}
+
+	FVector MinLocation(TNumericLimits<double>::Max());
+	FVector MaxLocation(TNumericLimits<double>::Lowest());
+	int32 NumViews = 0;
+
+	OutView = FSideScrollingCullingView();
+
+	// cull against all local players at once, so split screen players don't put each other's actors to sleep
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+
+		if (!PC || !PC->IsLocalController())
+		{
+			continue;
+		}
+
+		// only the side scrolling camera has a fixed view direction
+		if (!PC->PlayerCameraManager || !PC->PlayerCameraManager->IsA<ASideScrollingCameraManager>())
+		{
+			return false;
+		}
+
+		const FMinimalViewInfo& View = PC->PlayerCameraManager->GetCameraCacheView();
+
+		MinLocation = MinLocation.ComponentMin(View.Location);
+		MaxLocation = MaxLocation.ComponentMax(View.Location);
+
+		const double HalfWidthPerDepth = FMath::Tan(FMath::DegreesToRadians(View.FOV * 0.5));
+
+		// the horizontal FOV is fixed, so the vertical extent depends on the aspect ratio of the player's part of the viewport
+		double AspectRatio = 16.0 / 9.0;
+
+		const ULocalPlayer* LocalPlayer = PC->GetLocalPlayer();
+		const FVector2D PlayerSize = LocalPlayer ? ViewportSize * LocalPlayer->Size : ViewportSize;
+
+		if (PlayerSize.Y > 0.0)
+		{
+			AspectRatio = PlayerSize.X / PlayerSize.Y;
+		}
+
+		OutView.HalfWidthPerDepth = FMath::Max(OutView.HalfWidthPerDepth, HalfWidthPerDepth);
+		OutView.HalfHeightPerDepth = FMath::Max(OutView.HalfHeightPerDepth, HalfWidthPerDepth / AspectRatio);
+
+		++NumViews;
+	}
+
+	if (NumViews == 0)
+	{
+		return false;
+	}
+
+	// the farthest camera sees the most, so the view starts from its depth
+	OutView.Location = FVector((MinLocation.X + MaxLocation.X) * 0.5, MaxLocation.Y, (MinLocation.Z + MaxLocation.Z) * 0.5);
+	OutView.HalfSpan = FVector2D((MaxLocation.X - MinLocation.X) * 0.5, (MaxLocation.Z - MinLocation.Z) * 0.5);
+
+	return true;
+}
+
+bool USideScrollingCullingSubsystem::IsInView(const FBox& Bounds, const FSideScrollingCullingView& View, double Margin)
+{
+	// the camera looks down -Y, so the view is widest at the far side of the bounds
+	const double Depth = View.Location.Y - Bounds.Min.Y;
+
+	// is the actor behind the camera?
+	if (Depth < 0.0)
+	{
+		return false;
+	}
+
+	const double HalfWidth = Depth * View.HalfWidthPerDepth + View.HalfSpan.X + Margin;
+	const double HalfHeight = Depth * View.HalfHeightPerDepth + View.HalfSpan.Y + Margin;
+
+	return Bounds.Min.X <= View.Location.X + HalfWidth && Bounds.Max.X >= View.Location.X - HalfWidth
+		&& Bounds.Min.Z <= View.Location.Z + HalfHeight && Bounds.Max.Z >= View.Location.Z - HalfHeight;
+}
+
+bool USideScrollingCullingSubsystem::Cull(int32 EntryIndex)
+{
+	FSideScrollingCullingEntry& Entry = Entries[EntryIndex];
+	AActor* Actor = Entry.Actor.Get();
+
+	if (!Actor || Entry.bCulled || !CanCull(Actor))
+	{
+		return false;
+	}
+
+	USideScrollingTickSuppressionSubsystem* TickSuppression = GetWorld()->GetSubsystem<USideScrollingTickSuppressionSubsystem>();
+
+	if (!TickSuppression)
+	{
+		return false;
+	}
+
+	Entry.bCulled = true;
+
+	// disables the actor, component and AI controller ticks. The streamer may hold them asleep too
+	TickSuppression->Suppress(Actor, ESideScrollingTickSuppression::Culling);
+
+	// the actor is sorted by its bounds at the time it was culled
+	if (Entry.SortKey != Entry.Bounds.Min.X)
+	{
+		Entry.SortKey = Entry.Bounds.Min.X;
+		bSortDirty = true;
+	}
+
+	// without its tick the actor stays put, unless physics moves it
+	if (IsSimulatingPhysics(Actor))
+	{
+		SimulatingEntries.AddUnique(EntryIndex);
+	}
+
+	return true;
+}
+
+void USideScrollingCullingSubsystem::Wake(FSideScrollingCullingEntry& Entry)
+{
+	if (!Entry.bCulled)
+	{
+		return;
+	}
+
+	Entry.bCulled = false;
+
+	if (USideScrollingTickSuppressionSubsystem* TickSuppression = GetWorld()->GetSubsystem<USideScrollingTickSuppressionSubsystem>())
+	{
+		TickSuppression->Release(Entry.Actor.Get(), ESideScrollingTickSuppression::Culling);
+	}
+}
+
+void USideScrollingCullingSubsystem::WakeAll()
+{
+	for (const TPair<TObjectKey<AActor>, int32>& Pair : EntryIndices)
+	{
+		FSideScrollingCullingEntry& Entry = Entries[Pair.Value];
+
+		if (Entry.bCulled)
+		{
+			Wake(Entry);
+			VisibleEntries.Add(Pair.Value);
+		}
+	}
+}
+
+void USideScrollingCullingSubsystem::UpdateBounds(FSideScrollingCullingEntry& Entry, const AActor* Actor)
+{
+	FVector Origin;
+	FVector Extent;
+	Actor->GetActorBounds(false, Origin, Extent);
+
+	// actors without primitives are treated as a point
+	if (Extent.IsNearlyZero())
+	{
+		Origin = Actor->GetActorLocation();
+	}
+
+	Entry.Bounds = FBox(Origin - Extent, Origin + Extent);
+
+	// grow the sorted search limits
+	MaxExtentX = FMath::Max(MaxExtentX, Entry.Bounds.Max.X - Entry.Bounds.Min.X);
+	MinBoundsY = EntryIndices.Num() > 0 ? FMath::Min(MinBoundsY, Entry.Bounds.Min.Y) : Entry.Bounds.Min.Y;
+}
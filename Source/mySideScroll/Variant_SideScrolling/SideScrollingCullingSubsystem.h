@@ -0,0 +1,170 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SideScrollingCullingSubsystem.generated.h"
+
+class ULevel;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSideScrollingCulling, Log, All);
+
+/**
+ *  Actor tracked by the culling subsystem
+ */
+struct FSideScrollingCullingEntry
+{
+	/** Culled actor */
+	TWeakObjectPtr<AActor> Actor;
+
+	/** World bounds. Refreshed while the actor is on screen or simulating physics, frozen while it's culled otherwise */
+	FBox Bounds = FBox(ForceInit);
+
+	/** Min X the entry was sorted by. Matches the bounds at the time the actor was culled */
+	double SortKey = 0.0;
+
+	/** True if the actor can move, so its bounds need refreshing while on screen */
+	bool bMovable = false;
+
+	/** True if the actor is currently culled */
+	bool bCulled = false;
+};
+
+/**
+ *  Combined view of the local side scrolling cameras
+ */
+struct FSideScrollingCullingView
+{
+	/** Center of the cameras' X/Z span, at the depth of the farthest camera */
+	FVector Location = FVector::ZeroVector;
+
+	/** Half size of the cameras' X/Z span, added to the view at every depth */
+	FVector2D HalfSpan = FVector2D::ZeroVector;
+
+	/** Half width of the view per unit of depth */
+	double HalfWidthPerDepth = 0.0;
+
+	/** Half height of the view per unit of depth */
+	double HalfHeightPerDepth = 0.0;
+};
+
+/**
+ *  Stops actors outside of the side scrolling cameras' view from ticking
+ *  The side scrolling camera always looks down -Y with a fixed FOV, so the view is an X/Z rectangle that grows with depth.
+ *  Split screen players share one view, widened to cover all of their cameras.
+ *  - Tracked actors are kept in an array sorted by their min X, so only the ones in the view's X interval are visited
+ *  - Actors that leave the view plus a margin stop ticking, along with their components, which also suspends their animation
+ *  - Pawns are culled together with their AI controllers
+ *  - Culled actors simulating physics keep moving, so their bounds are refreshed until they come back into view
+ *  Ticks are disabled through the tick suppression subsystem, which the level streamer shares.
+ *  Ticking actors placed in the level and in streamed levels are picked up automatically, actors spawned later register themselves.
+ *  The per frame cost follows the number of actors on screen instead of the size of the level.
+ */
+UCLASS()
+class USideScrollingCullingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Tracked actors. Freed slots are recycled */
+	TArray<FSideScrollingCullingEntry> Entries;
+
+	/** Free slots in the entries array */
+	TArray<int32> FreeEntries;
+
+	/** Entry index for each tracked actor */
+	TMap<TObjectKey<AActor>, int32> EntryIndices;
+
+	/** Entries sorted by their min X */
+	TArray<int32> SortedEntries;
+
+	/** Entries currently on screen */
+	TArray<int32> VisibleEntries;
+
+	/** Culled entries simulating physics, which can move back into view on their own */
+	TArray<int32> SimulatingEntries;
+
+	/** Set when the sorted entries need sorting again */
+	bool bSortDirty = false;
+
+	/** Largest X extent of any tracked actor, bounds how far back the sorted search needs to look */
+	double MaxExtentX = 0.0;
+
+	/** Smallest Y of any tracked actor, the depth at which the view is the widest */
+	double MinBoundsY = 0.0;
+
+	/** Set while culling is paused, e.g. because the camera isn't side on */
+	bool bSuspended = false;
+
+	/** Streamed level delegate handle */
+	FDelegateHandle LevelAddedHandle;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Subscribes to streamed level changes */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Picks up the ticking actors placed in the level */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Updates the culled actors for the camera view */
+	virtual void Tick(float DeltaTime) override;
+
+	/** Returns the stat id for the tickable */
+	virtual TStatId GetStatId() const override;
+
+public:
+
+	/** Starts culling an actor. Does nothing if it's already tracked */
+	void RegisterActor(AActor* Actor);
+
+	/** Stops culling an actor, restoring its tick state */
+	void UnregisterActor(AActor* Actor);
+
+	/** Logs the culling state */
+	void LogStats() const;
+
+protected:
+
+	/** Stops tracking actors as they leave play */
+	UFUNCTION()
+	void OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	/** Picks up the ticking actors placed in a streamed level */
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+
+	/** Registers an actor placed in a level if it can be culled */
+	void RegisterPlacedActor(AActor* Actor);
+
+	/** Returns true if the actor has anything that ticks */
+	static bool CanCull(const AActor* Actor);
+
+	/** Returns true if any of the actor's primitives simulate physics */
+	static bool IsSimulatingPhysics(const AActor* Actor);
+
+	/** Returns the view covering all local players' cameras. Returns false if any local player doesn't use a side scrolling camera, or if we're serving remote players */
+	bool GetView(FSideScrollingCullingView& OutView) const;
+
+	/** Returns true if the bounds overlap the view grown by the margin */
+	static bool IsInView(const FBox& Bounds, const FSideScrollingCullingView& View, double Margin);
+
+	/** Stops the entry's actor from ticking. Returns false if the actor can't be culled */
+	bool Cull(int32 EntryIndex);
+
+	/** Restores the entry's tick state */
+	void Wake(FSideScrollingCullingEntry& Entry);
+
+	/** Wakes every culled entry */
+	void WakeAll();
+
+	/** Reads the actor bounds into the entry */
+	void UpdateBounds(FSideScrollingCullingEntry& Entry, const AActor* Actor);
+};
@@ -2,6 +2,7 @@
 
 
 #include "SideScrollingGameMode.h"
+#include "mySideScroll.h"
 #include "Kismet/GameplayStatics.h"
 #include "Blueprint/UserWidget.h"
 #include "SideScrollingUI.h"
@@ -13,6 +14,113 @@
 #include "../MenuGameMode.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerStart.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/Package.h"
+#include "UObject/ResourceSize.h"
+#include "UObject/UObjectGlobals.h"
+#include "HAL/PlatformTime.h"
+#include "StartupProfiler.h"
+#include "ProgressSaveSubsystem.h"
+#include "EngineUtils.h"
+#include "Engine/GameInstance.h"
+
+DEFINE_LOG_CATEGORY(LogSideScrollingGameMode);
+
+static TAutoConsoleVariable<bool> CVarSideScrollingLoadAllCharacters(
+	TEXT("SideScrolling.LoadAllCharacterVariants"),
+	false,
+	TEXT("If true, the game mode loads every character variant on startup instead of only the selected one.\n")
+	TEXT("Used to compare load times against the selected-only path. SideScrolling.CharacterMemoryReport compares the memory of both paths in one run."),
+	ECVF_Default);
+
+namespace SideScrollingCharacterMemory
+{
+	/** Asset memory reachable from a set of classes */
+	struct FAssetMemory
+	{
+		int32 NumClasses = 0;
+		int32 NumObjects = 0;
+		uint64 Bytes = 0;
+
+		double GetMB() const { return Bytes / (1024.0 * 1024.0); }
+	};
+
+	/** Sums the exclusive resource size of every asset object reachable from the classes and their defaults, counting shared assets once */
+	static FAssetMemory Measure(const TArray<UObject*>& LoadedAssets)
+	{
+		FAssetMemory Result;
+
+		TArray<UObject*> Defaults;
+		TArray<UObject*> Queue;
+
+		for (UObject* Asset : LoadedAssets)
+		{
+			if (UClass* Class = Cast<UClass>(Asset))
+			{
+				++Result.NumClasses;
+				Defaults.Add(Class->GetDefaultObject());
+				Queue.Add(Class);
+				Queue.Add(Class->GetDefaultObject());
+			}
+		}
+
+		TSet<UObject*> Visited;
+
+		while (!Queue.IsEmpty())
+		{
+			UObject* Object = Queue.Pop(EAllowShrinking::No);
+
+			if (!Object || Visited.Contains(Object))
+			{
+				continue;
+			}
+
+			Visited.Add(Object);
+
+			// native objects are always resident, only walk through the classes and their defaults to reach the assets they reference
+			if (Object->GetPackage()->HasAnyPackageFlags(PKG_CompiledIn))
+			{
+				const bool bIsRoot = LoadedAssets.Contains(Object) || Defaults.ContainsByPredicate([Object](const UObject* Default) { return Object == Default || Object->IsIn(Default); });
+
+				if (!bIsRoot)
+				{
+					continue;
+				}
+			}
+			else
+			{
+				FResourceSizeEx ResourceSize(EResourceSizeMode::Exclusive);
+				Object->GetResourceSizeEx(ResourceSize);
+
+				Result.Bytes += ResourceSize.GetTotalMemoryBytes();
+				++Result.NumObjects;
+			}
+
+			// queue the objects this one references
+			TArray<UObject*> References;
+			FReferenceFinder ReferenceFinder(References, nullptr, false, true, false, true);
+			ReferenceFinder.FindReferences(Object);
+
+			Queue.Append(References);
+		}
+
+		return Result;
+	}
+}
+
+static FAutoConsoleCommandWithWorld CCmdSideScrollingCharacterMemoryReport(
+	TEXT("SideScrolling.CharacterMemoryReport"),
+	TEXT("Loads the character classes for the selected variant and for every variant, and logs the asset memory of both side by side."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const ASideScrollingGameMode* GameMode = World ? World->GetAuthGameMode<ASideScrollingGameMode>() : nullptr)
+		{
+			GameMode->LogCharacterMemoryComparison();
+		}
+	}));
 
 ASideScrollingGameMode::ASideScrollingGameMode()
 {
@@ -25,6 +133,27 @@ ASideScrollingGameMode::ASideScrollingGameMode()
 	CombatCharacterClass = ACombatCharacter::StaticClass();
 }
 
+void ASideScrollingGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// gather the character classes to load
+	TArray<FSoftObjectPath> ClassesToLoad;
+	GetCharacterClassPaths(CVarSideScrollingLoadAllCharacters.GetValueOnGameThread(), ClassesToLoad);
+
+	if (ClassesToLoad.IsEmpty())
+	{
+		return;
+	}
+
+	// save the start time for the memory report
+	CharacterLoadStartTime = FPlatformTime::Seconds();
+
+	// request the async load
+	FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+	CharacterClassHandle = StreamableManager.RequestAsyncLoad(ClassesToLoad, FStreamableDelegate::CreateUObject(this, &ASideScrollingGameMode::OnCharacterClassLoaded), FStreamableManager::AsyncLoadHighPriority);
+}
+
 void ASideScrollingGameMode::BeginPlay()
 {
 	Super::BeginPlay();
@@ -34,12 +163,49 @@ void ASideScrollingGameMode::BeginPlay()
 	
 	if (UserInterfaceClass)
 	{
+		SIDESCROLL_STARTUP_SCOPE("WidgetCreation");
+
 		UserInterface = CreateWidget<USideScrollingUI>(OwningPlayer, UserInterfaceClass);
 	}
+
+	// restore the pickups collected in a previous session
+	RestoreSavedPickups();
+
+	// report the map load and menu to gameplay transition times once the first gameplay frame has ticked
+	FStartupProfiler::MarkFirstPlayableFrameNextTick(GetWorld());
+}
+
+void ASideScrollingGameMode::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// release the character classes
+	if (CharacterClassHandle.IsValid())
+	{
+		CharacterClassHandle->ReleaseHandle();
+		CharacterClassHandle.Reset();
+	}
+
+	PendingPlayers.Empty();
+}
+
+void ASideScrollingGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	// is the selected character class still loading?
+	if (CharacterClassHandle.IsValid() && CharacterClassHandle->IsLoadingInProgress())
+	{
+		// hold the player until the class is ready so we don't stall on a synchronous load
+		PendingPlayers.AddUnique(NewPlayer);
+		return;
+	}
+
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
 }
 
 APawn* ASideScrollingGameMode::SpawnDefaultPawnFor_Implementation(AController* NewPlayer, AActor* StartSpot)
 {
+	SIDESCROLL_STARTUP_SCOPE("PawnSpawn");
+
 	// Get the selected character class
 	TSubclassOf<APawn> CharacterClass = GetSelectedCharacterClass();
 	
@@ -70,6 +236,27 @@ APawn* ASideScrollingGameMode::SpawnDefaultPawnFor_Implementation(AController* N
 }
 
 TSubclassOf<APawn> ASideScrollingGameMode::GetSelectedCharacterClass() const
+{
+	const TSoftClassPtr<APawn> SelectedClass = GetSelectedCharacterSoftClass();
+
+	// is the class already loaded?
+	if (UClass* LoadedClass = SelectedClass.Get())
+	{
+		return LoadedClass;
+	}
+
+	if (SelectedClass.IsNull())
+	{
+		return nullptr;
+	}
+
+	// the async load didn't finish in time, fall back to a blocking load
+	UE_LOG(LogSideScrollingGameMode, Warning, TEXT("Character class %s was not preloaded, loading synchronously"), *SelectedClass.ToString());
+
+	return SelectedClass.LoadSynchronous();
+}
+
+TSoftClassPtr<APawn> ASideScrollingGameMode::GetSelectedCharacterSoftClass() const
 {
 	// Get the selected character type from the menu
 	ECharacterType SelectedType = AMenuGameMode::GetSelectedCharacterType();
@@ -77,22 +264,179 @@ TSubclassOf<APawn> ASideScrollingGameMode::GetSelectedCharacterClass() const
 	switch (SelectedType)
 	{
 	case ECharacterType::SideScrolling:
-		return SideScrollingCharacterClass;
+		return TSoftClassPtr<APawn>(SideScrollingCharacterClass.ToSoftObjectPath());
 	case ECharacterType::Platforming:
-		return PlatformingCharacterClass;
+		return TSoftClassPtr<APawn>(PlatformingCharacterClass.ToSoftObjectPath());
 	case ECharacterType::Combat:
-		return CombatCharacterClass;
+		return TSoftClassPtr<APawn>(CombatCharacterClass.ToSoftObjectPath());
 	default:
 		UE_LOG(LogTemp, Warning, TEXT("Unknown character type selected, defaulting to SideScrolling"));
-		return SideScrollingCharacterClass;
+		return TSoftClassPtr<APawn>(SideScrollingCharacterClass.ToSoftObjectPath());
 	}
 }
 
-void ASideScrollingGameMode::ProcessPickup()
+void ASideScrollingGameMode::GetCharacterClassPaths(bool bAllVariants, TArray<FSoftObjectPath>& OutClassPaths) const
 {
+	if (bAllVariants)
+	{
+		// legacy behavior, load every variant for comparison
+		for (const FSoftObjectPath& ClassPath : { SideScrollingCharacterClass.ToSoftObjectPath(), PlatformingCharacterClass.ToSoftObjectPath(), CombatCharacterClass.ToSoftObjectPath(), CustomSideScrollCharacterClass.ToSoftObjectPath() })
+		{
+			if (!ClassPath.IsNull())
+			{
+				OutClassPaths.AddUnique(ClassPath);
+			}
+		}
+	}
+	else
+	{
+		// only load the variant the player selected
+		const TSoftClassPtr<APawn> SelectedClass = GetSelectedCharacterSoftClass();
+
+		if (!SelectedClass.IsNull())
+		{
+			OutClassPaths.AddUnique(SelectedClass.ToSoftObjectPath());
+		}
+	}
+}
+
+void ASideScrollingGameMode::OnCharacterClassLoaded()
+{
+	// report the memory cost of the loaded classes
+	TArray<UObject*> LoadedAssets;
+
+	if (CharacterClassHandle.IsValid())
+	{
+		CharacterClassHandle->GetLoadedAssets(LoadedAssets);
+	}
+
+	LogCharacterMemoryReport(LoadedAssets);
+
+	// start any players that were waiting on the class
+	TArray<TObjectPtr<APlayerController>> PlayersToStart = MoveTemp(PendingPlayers);
+
+	for (APlayerController* CurrentPlayer : PlayersToStart)
+	{
+		if (IsValid(CurrentPlayer))
+		{
+			HandleStartingNewPlayer(CurrentPlayer);
+		}
+	}
+}
+
+void ASideScrollingGameMode::LogCharacterMemoryReport(const TArray<UObject*>& LoadedAssets) const
+{
+	const double LoadTime = FPlatformTime::Seconds() - CharacterLoadStartTime;
+	const SideScrollingCharacterMemory::FAssetMemory AssetMemory = SideScrollingCharacterMemory::Measure(LoadedAssets);
+
+	UE_LOG(LogSideScrollingGameMode, Log, TEXT("Character memory report (%s): %d class(es) loaded in %.3f s, %d asset objects, %.2f MB"),
+		CVarSideScrollingLoadAllCharacters.GetValueOnGameThread() ? TEXT("all variants") : TEXT("selected variant"),
+		AssetMemory.NumClasses,
+		LoadTime,
+		AssetMemory.NumObjects,
+		AssetMemory.GetMB());
+}
+
+void ASideScrollingGameMode::LogCharacterMemoryComparison() const
+{
+	using namespace SideScrollingCharacterMemory;
+
+	// load both configurations, the measurement only counts what each set of classes references so the order doesn't matter
+	auto LoadAndMeasure = [this](bool bAllVariants)
+	{
+		TArray<FSoftObjectPath> ClassPaths;
+		GetCharacterClassPaths(bAllVariants, ClassPaths);
+
+		TArray<UObject*> LoadedClasses;
+
+		for (const FSoftObjectPath& ClassPath : ClassPaths)
+		{
+			if (UObject* LoadedClass = ClassPath.TryLoad())
+			{
+				LoadedClasses.Add(LoadedClass);
+			}
+		}
+
+		return Measure(LoadedClasses);
+	};
+
+	const FAssetMemory Selected = LoadAndMeasure(false);
+	const FAssetMemory All = LoadAndMeasure(true);
+
+	UE_LOG(LogSideScrollingGameMode, Log, TEXT("Character memory comparison:"));
+	UE_LOG(LogSideScrollingGameMode, Log, TEXT("  %-16s %8s %10s %12s"), TEXT("Configuration"), TEXT("Classes"), TEXT("Objects"), TEXT("Memory (MB)"));
+	UE_LOG(LogSideScrollingGameMode, Log, TEXT("  %-16s %8d %10d %12.2f"), TEXT("selected variant"), Selected.NumClasses, Selected.NumObjects, Selected.GetMB());
+	UE_LOG(LogSideScrollingGameMode, Log, TEXT("  %-16s %8d %10d %12.2f"), TEXT("all variants"), All.NumClasses, All.NumObjects, All.GetMB());
+	UE_LOG(LogSideScrollingGameMode, Log, TEXT("  selected variant saves %.2f MB"), All.GetMB() - Selected.GetMB());
+}
+
+void ASideScrollingGameMode::RestoreSavedPickups()
+{
+	LevelName = FName(UGameplayStatics::GetCurrentLevelName(this, true));
+
+	// sort the placed pickups by name so their indices are stable between sessions
+	TArray<ASideScrollingPickup*> Pickups;
+
+	for (TActorIterator<ASideScrollingPickup> It(GetWorld()); It; ++It)
+	{
+		Pickups.Add(*It);
+	}
+
+	Pickups.Sort([](const ASideScrollingPickup& A, const ASideScrollingPickup& B) { return A.GetFName().LexicalLess(B.GetFName()); });
+
+	NumLevelPickups = Pickups.Num();
+
+	for (int32 i = 0; i < Pickups.Num(); ++i)
+	{
+		Pickups[i]->SetPickupIndex(i);
+	}
+
+	UProgressSaveSubsystem* ProgressSave = GetGameInstance()->GetSubsystem<UProgressSaveSubsystem>();
+
+	if (!ProgressSave)
+	{
+		return;
+	}
+
+	const FLevelProgress& Progress = ProgressSave->GetLevelProgress(LevelName);
+
+	// remove the pickups that were already collected
+	const int32 NumSavedPickups = FMath::Min(Progress.CollectedPickups.Num(), Pickups.Num());
+
+	for (int32 i = 0; i < NumSavedPickups; ++i)
+	{
+		if (Progress.CollectedPickups[i])
+		{
+			Pickups[i]->Destroy();
+		}
+	}
+
+	PickupsCollected = Progress.PickupsCollected;
+
+	// show the saved pickup count
+	if (PickupsCollected > 0 && UserInterface)
+	{
+		UserInterface->AddToViewport(0);
+		UserInterface->UpdatePickups(PickupsCollected);
+	}
+}
+
+void ASideScrollingGameMode::ProcessPickup(ASideScrollingPickup* Pickup)
+{
+	SIDESCROLL_SCOPE(SideScrollingProcessPickup);
+
 	// increment the pickups counter
 	++PickupsCollected;
 
+	// save the collected pickup
+	if (Pickup)
+	{
+		if (UProgressSaveSubsystem* ProgressSave = GetGameInstance()->GetSubsystem<UProgressSaveSubsystem>())
+		{
+			ProgressSave->MarkPickupCollected(LevelName, Pickup->GetPickupIndex(), NumLevelPickups);
+		}
+	}
+
 	// if this is the first pickup we collect, show the UI
 	if (PickupsCollected == 1 && UserInterface)
 	{
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameModeBase.h"
 #include "../CharacterSelectionWidget.h"
+#include "UObject/SoftObjectPtr.h"
 #include "SideScrollingGameMode.generated.h"
 
 class USideScrollingUI;
@@ -12,6 +13,10 @@ class ASideScrollingCharacter;
 class APlatformingCharacter;
 class ACombatCharacter;
 class ACustomSideScrollCharacter;
+class ASideScrollingPickup;
+struct FStreamableHandle;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogSideScrollingGameMode, Log, All);
 
 /**
  *  Enhanced Side Scrolling Game Mode
@@ -41,33 +46,76 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Category="Picups")
 	int32 PickupsCollected = 0;
 
-	/** Character classes for different types */
+	/** Number of pickups placed in the level, used to size the saved pickup bitset */
+	int32 NumLevelPickups = 0;
+
+	/** Name of the current level, used to key the saved progress */
+	FName LevelName;
+
+	/** Character classes for different types. Soft referenced so only the selected variant's assets get loaded */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Characters")
-	TSubclassOf<ASideScrollingCharacter> SideScrollingCharacterClass;
+	TSoftClassPtr<ASideScrollingCharacter> SideScrollingCharacterClass;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Characters")
-	TSubclassOf<APlatformingCharacter> PlatformingCharacterClass;
+	TSoftClassPtr<APlatformingCharacter> PlatformingCharacterClass;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Characters")
-	TSubclassOf<ACombatCharacter> CombatCharacterClass;
+	TSoftClassPtr<ACombatCharacter> CombatCharacterClass;
 
 	/** Custom character class - new pure C++ character */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Characters")
-	TSubclassOf<ACustomSideScrollCharacter> CustomSideScrollCharacterClass;
+	TSoftClassPtr<ACustomSideScrollCharacter> CustomSideScrollCharacterClass;
+
+	/** Streaming handle keeping the selected character class loaded */
+	TSharedPtr<FStreamableHandle> CharacterClassHandle;
+
+	/** Players that joined before the selected character class finished loading */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<APlayerController>> PendingPlayers;
+
+	/** Platform time when the character class load was requested, for the memory report */
+	double CharacterLoadStartTime = 0.0;
 
 protected:
 
+	/** Starts loading the selected character class */
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
 	/** Initialization */
 	virtual void BeginPlay() override;
 
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Holds new players until the selected character class has loaded */
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+
 	/** Override to spawn the selected character type */
 	virtual APawn* SpawnDefaultPawnFor_Implementation(AController* NewPlayer, AActor* StartSpot) override;
 
-	/** Get the appropriate character class based on selection */
+	/** Get the appropriate character class based on selection. Loads it synchronously if the async load hasn't finished */
 	TSubclassOf<APawn> GetSelectedCharacterClass() const;
 
+	/** Get the soft reference to the character class based on selection */
+	TSoftClassPtr<APawn> GetSelectedCharacterSoftClass() const;
+
+	/** Gathers the character classes to load, either the selected variant only or every variant */
+	void GetCharacterClassPaths(bool bAllVariants, TArray<FSoftObjectPath>& OutClassPaths) const;
+
+	/** Called when the selected character class finishes loading */
+	void OnCharacterClassLoaded();
+
+	/** Logs the asset memory of the loaded character classes and the time spent loading them */
+	void LogCharacterMemoryReport(const TArray<UObject*>& LoadedAssets) const;
+
+	/** Indexes the level's pickups and removes the ones collected in a previous session */
+	void RestoreSavedPickups();
+
 public:
 
 	/** Receives an interaction event from another actor */
-	virtual void ProcessPickup();
+	virtual void ProcessPickup(ASideScrollingPickup* Pickup);
+
+	/** Loads the character classes for both the selected variant and every variant, and logs their asset memory side by side */
+	void LogCharacterMemoryComparison() const;
 };
@@ -4,11 +4,192 @@
 #include "SideScrollingPlayerController.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
-#include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "SideScrollingCharacter.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
+#include "ActorRegistrySubsystem.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SideScrollingMovementComponent.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<bool> CVarSideScrollingRecyclePawnOnRespawn(
+	TEXT("SideScrolling.Respawn.RecyclePawn"),
+	true,
+	TEXT("If true, the player pawn is moved back to the player start when it falls out of the level instead of being destroyed and re-spawned."),
+	ECVF_Default);
+
+DEFINE_LOG_CATEGORY_STATIC(LogSideScrollingNet, Log, All);
+
+static TAutoConsoleVariable<bool> CVarSideScrollingNetAutopilot(
+	TEXT("SideScrolling.Net.Autopilot"),
+	false,
+	TEXT("If true, locally controlled side scrolling characters run back and forth, jump, wall jump and drop on their own. Used for network benchmarks."),
+	ECVF_Default);
+
+namespace SideScrollingNet
+{
+	/** Bandwidth samples for a client connection */
+	struct FBenchmarkConnection
+	{
+		TWeakObjectPtr<UNetConnection> Connection;
+		FString Name;
+		double InBytes = 0.0;
+		double OutBytes = 0.0;
+		int32 NumSamples = 0;
+	};
+
+	/** State for a running bandwidth benchmark */
+	struct FBenchmarkState
+	{
+		TWeakObjectPtr<UWorld> World;
+		TArray<FBenchmarkConnection> Connections;
+		double Duration = 0.0;
+		double Elapsed = 0.0;
+		double NextSample = 1.0;
+		bool bPreviousAutopilot = false;
+	};
+
+	/** Stops measuring and restores the autopilot setting */
+	static void EndBenchmark(FBenchmarkState& State)
+	{
+		FSideScrollingNetStats::Get().bMeasuring = false;
+
+		CVarSideScrollingNetAutopilot.AsVariable()->Set(State.bPreviousAutopilot, ECVF_SetByConsole);
+	}
+
+	/** Logs the bandwidth per player, and the movement payload against the stock serializers */
+	static void LogBenchmark(const FBenchmarkState& State)
+	{
+		const FSideScrollingNetStats& Stats = FSideScrollingNetStats::Get();
+		const int32 NumClients = FMath::Max(State.Connections.Num(), 1);
+
+		UE_LOG(LogSideScrollingNet, Log, TEXT("Side scrolling network benchmark: %d clients over %.1f s"), State.Connections.Num(), State.Elapsed);
+
+		double TotalIn = 0.0;
+		double TotalOut = 0.0;
+
+		for (const FBenchmarkConnection& Entry : State.Connections)
+		{
+			const double InRate = Entry.NumSamples > 0 ? Entry.InBytes / Entry.NumSamples : 0.0;
+			const double OutRate = Entry.NumSamples > 0 ? Entry.OutBytes / Entry.NumSamples : 0.0;
+
+			TotalIn += InRate;
+			TotalOut += OutRate;
+
+			UE_LOG(LogSideScrollingNet, Log, TEXT("  %s: %.0f B/s from the client, %.0f B/s to the client"), *Entry.Name, InRate, OutRate);
+		}
+
+		UE_LOG(LogSideScrollingNet, Log, TEXT("  per player: %.0f B/s from the client, %.0f B/s to the client"), TotalIn / NumClients, TotalOut / NumClients);
+
+		// the counters are process wide, so moves are only counted if the clients run in this process
+		auto LogPayload = [&State, NumClients](const TCHAR* Label, uint64 Count, uint64 Bits, uint64 StockBits)
+		{
+			if (Count == 0)
+			{
+				return;
+			}
+
+			const double Seconds = FMath::Max(State.Elapsed, 0.001);
+
+			UE_LOG(LogSideScrollingNet, Log, TEXT("  %s: %.1f per second per player, %.1f bits each (stock %.1f), %.0f B/s per player (stock %.0f B/s)"),
+				Label, Count / Seconds / NumClients, (double)Bits / Count, (double)StockBits / Count, Bits / 8.0 / Seconds / NumClients, StockBits / 8.0 / Seconds / NumClients);
+		};
+
+		LogPayload(TEXT("client moves"), Stats.NumMoves, Stats.MoveBits, Stats.StockMoveBits);
+		LogPayload(TEXT("movement updates"), Stats.NumRepMovements, Stats.RepMovementBits, Stats.StockRepMovementBits);
+	}
+
+	/** Samples the connection rates. Returns false once the benchmark is complete */
+	static bool TickBenchmark(FBenchmarkState& State, float DeltaTime)
+	{
+		if (!State.World.IsValid())
+		{
+			EndBenchmark(State);
+			return false;
+		}
+
+		State.Elapsed += DeltaTime;
+
+		// the connection rates are updated about once per second
+		if (State.Elapsed >= State.NextSample)
+		{
+			State.NextSample += 1.0;
+
+			for (FBenchmarkConnection& Entry : State.Connections)
+			{
+				if (const UNetConnection* Connection = Entry.Connection.Get())
+				{
+					Entry.InBytes += Connection->InBytesPerSecond;
+					Entry.OutBytes += Connection->OutBytesPerSecond;
+					++Entry.NumSamples;
+				}
+			}
+		}
+
+		if (State.Elapsed < State.Duration)
+		{
+			return true;
+		}
+
+		LogBenchmark(State);
+		EndBenchmark(State);
+
+		return false;
+	}
+
+	/** Turns on the autopilot and measures the bandwidth of every client connection */
+	static void StartBenchmark(UWorld* World, float Duration)
+	{
+		const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+		if (!NetDriver || !NetDriver->IsServer() || NetDriver->ClientConnections.IsEmpty())
+		{
+			UE_LOG(LogSideScrollingNet, Warning, TEXT("The network benchmark needs to run on a listen server with clients connected"));
+			return;
+		}
+
+		TSharedRef<FBenchmarkState> State = MakeShared<FBenchmarkState>();
+		State->World = World;
+		State->Duration = Duration;
+		State->bPreviousAutopilot = CVarSideScrollingNetAutopilot.GetValueOnGameThread();
+
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection)
+			{
+				FBenchmarkConnection& Entry = State->Connections.AddDefaulted_GetRef();
+				Entry.Connection = Connection;
+				Entry.Name = Connection->LowLevelGetRemoteAddress(true);
+			}
+		}
+
+		FSideScrollingNetStats::Get().Reset();
+		FSideScrollingNetStats::Get().bMeasuring = true;
+
+		// clients in the same process pick this up as well, clients in other processes need it set on their own
+		CVarSideScrollingNetAutopilot.AsVariable()->Set(true, ECVF_SetByConsole);
+
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([State](float DeltaTime)
+		{
+			return TickBenchmark(*State, DeltaTime);
+		}));
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CCmdSideScrollingNetBenchmark(
+	TEXT("SideScrolling.Net.Benchmark"),
+	TEXT("Runs every side scrolling player on autopilot and logs the bytes per second per player, and the movement payload against the stock serializers. Run on a listen server.\n")
+	TEXT("Usage: SideScrolling.Net.Benchmark [Seconds=10]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const float Duration = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 1.0f) : 10.0f;
+
+		SideScrollingNet::StartBenchmark(World, Duration);
+	}));
 
 void ASideScrollingPlayerController::SetupInputComponent()
 {
@@ -26,21 +207,35 @@ void ASideScrollingPlayerController::OnPossess(APawn* InPawn)
 {
 	Super::OnPossess(InPawn);
 
-	// subscribe to the pawn's OnDestroyed delegate
-	InPawn->OnDestroyed.AddDynamic(this, &ASideScrollingPlayerController::OnPawnDestroyed);
+	// subscribe to the pawn's OnDestroyed delegate, only once in case the same pawn is possessed again
+	InPawn->OnDestroyed.AddUniqueDynamic(this, &ASideScrollingPlayerController::OnPawnDestroyed);
+
+	// register the pawn as a player with the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->RegisterActor(InPawn, EActorRegistryCategory::Player);
+	}
+}
+
+void ASideScrollingPlayerController::OnUnPossess()
+{
+	// unregister the pawn from the actor registry
+	if (UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>())
+	{
+		Registry->UnregisterActor(GetPawn(), EActorRegistryCategory::Player);
+	}
+
+	Super::OnUnPossess();
 }
 
 void ASideScrollingPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 {
 	// find the player start
-	TArray<AActor*> ActorList;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), APlayerStart::StaticClass(), ActorList);
+	FTransform SpawnTransform;
 
-	if (ActorList.Num() > 0)
+	if (GetRespawnTransform(SpawnTransform))
 	{
 		// spawn a character at the player start
-		const FTransform SpawnTransform = ActorList[0]->GetActorTransform();
-
 		if (ASideScrollingCharacter* RespawnedCharacter = GetWorld()->SpawnActor<ASideScrollingCharacter>(CharacterClass, SpawnTransform))
 		{
 			// possess the character
@@ -48,3 +243,86 @@ void ASideScrollingPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 		}
 	}
 }
+
+bool ASideScrollingPlayerController::GetRespawnTransform(FTransform& OutTransform) const
+{
+	// find the player start
+	UActorRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UActorRegistrySubsystem>();
+	AActor* PlayerStart = Registry ? Registry->GetFirstActor(EActorRegistryCategory::PlayerStart) : nullptr;
+
+	if (IsValid(PlayerStart))
+	{
+		OutTransform = PlayerStart->GetActorTransform();
+		return true;
+	}
+
+	return false;
+}
+
+bool ASideScrollingPlayerController::RespawnPawnInPlace(APawn* InPawn)
+{
+	// only recycle our own pawn
+	if (!CVarSideScrollingRecyclePawnOnRespawn.GetValueOnGameThread() || !InPawn || InPawn != GetPawn())
+	{
+		return false;
+	}
+
+	FTransform SpawnTransform;
+
+	if (!GetRespawnTransform(SpawnTransform))
+	{
+		return false;
+	}
+
+	// teleport the pawn to the player start
+	InPawn->SetActorLocationAndRotation(SpawnTransform.GetLocation(), SpawnTransform.GetRotation(), false, nullptr, ETeleportType::ResetPhysics);
+	SetControlRotation(SpawnTransform.Rotator());
+
+	// kill any leftover velocity and re-enable movement
+	if (ACharacter* RespawnedCharacter = Cast<ACharacter>(InPawn))
+	{
+		RespawnedCharacter->GetCharacterMovement()->StopMovementImmediately();
+		RespawnedCharacter->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	}
+
+	return true;
+}
+
+void ASideScrollingPlayerController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	if (!CVarSideScrollingNetAutopilot.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	if (ASideScrollingCharacter* SideScrollingCharacter = Cast<ASideScrollingCharacter>(GetPawn()))
+	{
+		UpdateAutopilot(SideScrollingCharacter, DeltaTime);
+	}
+}
+
+void ASideScrollingPlayerController::UpdateAutopilot(ASideScrollingCharacter* SideScrollingCharacter, float DeltaSeconds)
+{
+	const double Time = GetWorld()->GetTimeSeconds();
+
+	// run back and forth
+	SideScrollingCharacter->DoMove(FMath::Fmod(Time, 4.0) < 2.0 ? 1.0f : -1.0f);
+
+	// press jump every half second so ground jumps alternate with double and wall jumps, and drop down now and then
+	const int32 Step = FMath::FloorToInt32(Time * 4.0);
+
+	if (Step != FMath::FloorToInt32((Time - DeltaSeconds) * 4.0))
+	{
+		if (Step % 2 == 0)
+		{
+			SideScrollingCharacter->DoDrop(Step % 16 == 0 ? 1.0f : 0.0f);
+			SideScrollingCharacter->DoJumpStart();
+		}
+		else
+		{
+			SideScrollingCharacter->DoJumpEnd();
+		}
+	}
+}
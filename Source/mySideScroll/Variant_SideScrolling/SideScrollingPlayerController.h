@@ -14,6 +14,7 @@ class UInputMappingContext;
  *  A simple Side Scrolling Player Controller
  *  Manages input mappings
  *  Respawns the player pawn at the player start if it is destroyed
+ *  Drives the pawn on its own while the network benchmark autopilot is enabled
  */
 UCLASS(abstract)
 class ASideScrollingPlayerController : public APlayerController
@@ -38,8 +39,25 @@ protected:
 	/** Pawn initialization */
 	virtual void OnPossess(APawn* InPawn) override;
 
+	/** Pawn cleanup */
+	virtual void OnUnPossess() override;
+
 	/** Called if the possessed pawn is destroyed */
 	UFUNCTION()
 	void OnPawnDestroyed(AActor* DestroyedActor);
 
+	/** Finds the transform to respawn the player at. Returns false if there's none */
+	bool GetRespawnTransform(FTransform& OutTransform) const;
+
+	/** Drives the pawn while the network autopilot is enabled. Only runs for local players */
+	virtual void PlayerTick(float DeltaTime) override;
+
+	/** Runs back and forth and jumps, for network benchmarks */
+	void UpdateAutopilot(ASideScrollingCharacter* SideScrollingCharacter, float DeltaSeconds);
+
+public:
+
+	/** Moves the possessed pawn back to the respawn transform without destroying it. Returns false if the pawn should be destroyed and re-spawned instead */
+	bool RespawnPawnInPlace(APawn* InPawn);
+
 };
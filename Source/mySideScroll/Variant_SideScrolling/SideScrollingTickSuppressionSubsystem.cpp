@@ -0,0 +1,155 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "SideScrollingTickSuppressionSubsystem.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+
+bool USideScrollingTickSuppressionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void USideScrollingTickSuppressionSubsystem::Deinitialize()
+{
+	SuppressedActors.Reset();
+
+	Super::Deinitialize();
+}
+
+void USideScrollingTickSuppressionSubsystem::Suppress(AActor* Actor, ESideScrollingTickSuppression Reason)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	// already held asleep by this system?
+	if (const FSideScrollingSuppressedActor* Suppressed = SuppressedActors.Find(Actor); Suppressed && EnumHasAnyFlags(Suppressed->Reasons, Reason))
+	{
+		return;
+	}
+
+	SuppressSingle(Actor, Reason);
+
+	FSideScrollingSuppressedActor& Suppressed = SuppressedActors.FindChecked(Actor);
+
+	// AI pawns think through their controller, so it sleeps with them. Keep the first one so it's the one that gets released
+	if (!Suppressed.Controller.IsValid())
+	{
+		if (const APawn* Pawn = Cast<APawn>(Actor))
+		{
+			if (AController* Controller = Pawn->GetController(); Controller && !Controller->IsPlayerController())
+			{
+				Suppressed.Controller = Controller;
+			}
+		}
+	}
+
+	if (AActor* Controller = Suppressed.Controller.Get())
+	{
+		SuppressSingle(Controller, Reason);
+	}
+}
+
+void USideScrollingTickSuppressionSubsystem::Release(AActor* Actor, ESideScrollingTickSuppression Reason)
+{
+	const FSideScrollingSuppressedActor* Suppressed = Actor ? SuppressedActors.Find(Actor) : nullptr;
+
+	if (!Suppressed || !EnumHasAnyFlags(Suppressed->Reasons, Reason))
+	{
+		return;
+	}
+
+	// the record may go away with the release
+	AActor* Controller = Suppressed->Controller.Get();
+
+	ReleaseSingle(Actor, Reason);
+
+	if (Controller)
+	{
+		ReleaseSingle(Controller, Reason);
+	}
+}
+
+bool USideScrollingTickSuppressionSubsystem::IsSuppressed(const AActor* Actor) const
+{
+	return Actor && SuppressedActors.Contains(Actor);
+}
+
+int32 USideScrollingTickSuppressionSubsystem::GetNumSuppressed(ESideScrollingTickSuppression Reason) const
+{
+	int32 NumSuppressed = 0;
+
+	for (const TPair<TObjectKey<AActor>, FSideScrollingSuppressedActor>& Pair : SuppressedActors)
+	{
+		NumSuppressed += EnumHasAnyFlags(Pair.Value.Reasons, Reason) ? 1 : 0;
+	}
+
+	return NumSuppressed;
+}
+
+void USideScrollingTickSuppressionSubsystem::SuppressSingle(AActor* Actor, ESideScrollingTickSuppression Reason)
+{
+	FSideScrollingSuppressedActor& Suppressed = SuppressedActors.FindOrAdd(Actor);
+
+	// only the first system sees the actor's own tick state
+	if (Suppressed.Reasons == ESideScrollingTickSuppression::None)
+	{
+		Suppressed.bActorTicked = Actor->IsActorTickEnabled();
+		Actor->SetActorTickEnabled(false);
+
+		// skeletal meshes stop animating along with their component tick
+		for (UActorComponent* Component : Actor->GetComponents())
+		{
+			if (Component && Component->IsComponentTickEnabled())
+			{
+				Suppressed.TickingComponents.Add(Component);
+				Component->SetComponentTickEnabled(false);
+			}
+		}
+
+		Actor->OnEndPlay.AddUniqueDynamic(this, &USideScrollingTickSuppressionSubsystem::OnActorEndPlay);
+	}
+
+	Suppressed.Reasons |= Reason;
+}
+
+void USideScrollingTickSuppressionSubsystem::ReleaseSingle(AActor* Actor, ESideScrollingTickSuppression Reason)
+{
+	FSideScrollingSuppressedActor* Suppressed = SuppressedActors.Find(Actor);
+
+	if (!Suppressed)
+	{
+		return;
+	}
+
+	Suppressed->Reasons &= ~Reason;
+
+	// still held asleep by another system?
+	if (Suppressed->Reasons != ESideScrollingTickSuppression::None)
+	{
+		return;
+	}
+
+	Actor->SetActorTickEnabled(Suppressed->bActorTicked);
+
+	for (const TWeakObjectPtr<UActorComponent>& Component : Suppressed->TickingComponents)
+	{
+		if (Component.IsValid())
+		{
+			Component->SetComponentTickEnabled(true);
+		}
+	}
+
+	SuppressedActors.Remove(Actor);
+
+	Actor->OnEndPlay.RemoveDynamic(this, &USideScrollingTickSuppressionSubsystem::OnActorEndPlay);
+}
+
+void USideScrollingTickSuppressionSubsystem::OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	SuppressedActors.Remove(Actor);
+}
@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SideScrollingTickSuppressionSubsystem.generated.h"
+
+class UActorComponent;
+
+/**
+ *  Systems that can stop an actor from ticking. Each one holds its own flag on the actor
+ */
+enum class ESideScrollingTickSuppression : uint8
+{
+	None		= 0,
+	Culling		= 1 << 0,
+	Streaming	= 1 << 1,
+};
+
+ENUM_CLASS_FLAGS(ESideScrollingTickSuppression);
+
+/**
+ *  Tick state of an actor held asleep by one or more systems
+ */
+struct FSideScrollingSuppressedActor
+{
+	/** Systems currently holding the actor asleep */
+	ESideScrollingTickSuppression Reasons = ESideScrollingTickSuppression::None;
+
+	/** True if the actor was ticking before the first system put it to sleep */
+	bool bActorTicked = false;
+
+	/** Components that were ticking before the first system put the actor to sleep */
+	TArray<TWeakObjectPtr<UActorComponent>, TInlineAllocator<4>> TickingComponents;
+
+	/** AI controller put to sleep along with a pawn */
+	TWeakObjectPtr<AActor> Controller;
+};
+
+/**
+ *  Single owner of the tick state of actors put to sleep by the side scrolling culling and level streaming
+ *  - The tick state is saved when the first system suppresses an actor, and restored once the last one releases it,
+ *    so the systems can't restore each other's disabled state
+ *  - Pawns are suppressed together with their AI controllers
+ *  Records are dropped when their actor leaves play.
+ */
+UCLASS()
+class USideScrollingTickSuppressionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Suppressed actors */
+	TMap<TObjectKey<AActor>, FSideScrollingSuppressedActor> SuppressedActors;
+
+public:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+public:
+
+	/** Stops the actor and its AI controller from ticking on behalf of a system. Does nothing if that system already suppresses it */
+	void Suppress(AActor* Actor, ESideScrollingTickSuppression Reason);
+
+	/** Clears a system's suppression, restoring the tick state once no system holds the actor asleep */
+	void Release(AActor* Actor, ESideScrollingTickSuppression Reason);
+
+	/** Returns true if any system holds the actor asleep */
+	bool IsSuppressed(const AActor* Actor) const;
+
+	/** Returns the number of actors held asleep by a system */
+	int32 GetNumSuppressed(ESideScrollingTickSuppression Reason) const;
+
+protected:
+
+	/** Adds the reason to an actor's record, saving and disabling its ticks if it's the first one */
+	void SuppressSingle(AActor* Actor, ESideScrollingTickSuppression Reason);
+
+	/** Removes the reason from an actor's record, restoring its ticks if it was the last one */
+	void ReleaseSingle(AActor* Actor, ESideScrollingTickSuppression Reason);
+
+	/** Drops the record of actors leaving play */
+	UFUNCTION()
+	void OnActorEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+};
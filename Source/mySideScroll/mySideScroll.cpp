@@ -2,6 +2,102 @@
 
 #include "mySideScroll.h"
 #include "Modules/ModuleManager.h"
+#include "StartupProfiler.h"
+#include "UObject/UObjectGlobals.h"
+#include "Engine/World.h"
+#include "Misc/CoreDelegates.h"
+#include "ProfilingDebugging/CountersTrace.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, mySideScroll, "mySideScroll" );
- 
\ No newline at end of file
+IMPLEMENT_PRIMARY_GAME_MODULE( FmySideScrollModule, mySideScroll, "mySideScroll" );
+
+UE_TRACE_CHANNEL_DEFINE(SideScrollChannel);
+
+DEFINE_STAT(STAT_SideScrollAttackTraces);
+DEFINE_STAT(STAT_SideScrollDamageEvents);
+DEFINE_STAT(STAT_SideScrollEnemiesAlive);
+
+TRACE_DECLARE_INT_COUNTER(SideScrollAttackTraces, TEXT("SideScroll/Attack Traces"));
+TRACE_DECLARE_INT_COUNTER(SideScrollDamageEvents, TEXT("SideScroll/Damage Events"));
+TRACE_DECLARE_INT_COUNTER(SideScrollEnemiesAlive, TEXT("SideScroll/Enemies Alive"));
+
+namespace SideScrollCounters
+{
+	/** Counts for the current frame */
+	static int32 NumAttackTraces = 0;
+	static int32 NumDamageEvents = 0;
+
+	/** Last published enemy count */
+	static int32 NumEnemiesAlive = 0;
+
+	void AddAttackTrace()
+	{
+		++NumAttackTraces;
+		INC_DWORD_STAT(STAT_SideScrollAttackTraces);
+	}
+
+	void AddDamageEvent()
+	{
+		++NumDamageEvents;
+		INC_DWORD_STAT(STAT_SideScrollDamageEvents);
+	}
+
+	void SetEnemiesAlive(int32 NumEnemies)
+	{
+		NumEnemiesAlive = NumEnemies;
+		SET_DWORD_STAT(STAT_SideScrollEnemiesAlive, NumEnemiesAlive);
+	}
+}
+
+void FmySideScrollModule::StartupModule()
+{
+	FDefaultGameModuleImpl::StartupModule();
+
+	// time every map load
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddRaw(this, &FmySideScrollModule::OnPreLoadMap);
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddRaw(this, &FmySideScrollModule::OnPostLoadMap);
+
+	// publish the gameplay counters once per frame
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FmySideScrollModule::OnEndFrame);
+
+	// time the rest of engine initialization
+	PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FmySideScrollModule::OnPostEngineInit);
+
+	// the game module loads during engine init, so this covers everything from process start until our module is ready
+	FStartupProfiler::RecordSinceProcessStart(TEXT("ModuleInit"));
+}
+
+void FmySideScrollModule::ShutdownModule()
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+
+	FDefaultGameModuleImpl::ShutdownModule();
+}
+
+void FmySideScrollModule::OnPreLoadMap(const FString& MapName)
+{
+	FStartupProfiler::BeginMapLoad(MapName);
+}
+
+void FmySideScrollModule::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	FStartupProfiler::EndMapLoad(LoadedWorld);
+}
+
+void FmySideScrollModule::OnPostEngineInit()
+{
+	FStartupProfiler::RecordSinceProcessStart(TEXT("EngineInit"));
+}
+
+void FmySideScrollModule::OnEndFrame()
+{
+	TRACE_COUNTER_SET(SideScrollAttackTraces, SideScrollCounters::NumAttackTraces);
+	TRACE_COUNTER_SET(SideScrollDamageEvents, SideScrollCounters::NumDamageEvents);
+	TRACE_COUNTER_SET(SideScrollEnemiesAlive, SideScrollCounters::NumEnemiesAlive);
+
+	// the stat counters reset themselves every frame
+	SideScrollCounters::NumAttackTraces = 0;
+	SideScrollCounters::NumDamageEvents = 0;
+}
@@ -3,3 +3,76 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Modules/ModuleInterface.h"
+#include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/** Stat group for the game module's own counters. Use "stat SideScroll" to display it */
+DECLARE_STATS_GROUP(TEXT("SideScroll"), STATGROUP_SideScroll, STATCAT_Advanced);
+
+/** Insights trace channel for gameplay scopes. Enable it with -trace=cpu,SideScroll */
+UE_TRACE_CHANNEL_EXTERN(SideScrollChannel, MYSIDESCROLL_API);
+
+/** Gameplay event counters */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Attack Traces"), STAT_SideScrollAttackTraces, STATGROUP_SideScroll, MYSIDESCROLL_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_SideScrollDamageEvents, STATGROUP_SideScroll, MYSIDESCROLL_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Enemies Alive"), STAT_SideScrollEnemiesAlive, STATGROUP_SideScroll, MYSIDESCROLL_API);
+
+/** Times the enclosing scope in the SideScroll stat group and as a CPU event on the SideScroll trace channel */
+#define SIDESCROLL_SCOPE(Name) \
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT(#Name), STAT_SideScroll_##Name, STATGROUP_SideScroll); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, SideScrollChannel)
+
+/**
+ *  Gameplay event counters, published to the SideScroll stat group and to Insights
+ *  Per frame counts are reset at the end of every frame. Game thread only.
+ */
+namespace SideScrollCounters
+{
+	/** Counts a melee attack trace */
+	MYSIDESCROLL_API void AddAttackTrace();
+
+	/** Counts a damage event */
+	MYSIDESCROLL_API void AddDamageEvent();
+
+	/** Sets the number of living enemies, as counted by the actor registry of the world running the game */
+	MYSIDESCROLL_API void SetEnemiesAlive(int32 NumEnemies);
+}
+
+/**
+ *  Primary game module
+ *  Hooks the startup profiler into module initialization, engine initialization and map loads
+ *  Publishes the gameplay counters at the end of every frame
+ */
+class FmySideScrollModule : public FDefaultGameModuleImpl
+{
+public:
+
+	/** Module initialization */
+	virtual void StartupModule() override;
+
+	/** Module cleanup */
+	virtual void ShutdownModule() override;
+
+protected:
+
+	/** Called before a map starts loading */
+	void OnPreLoadMap(const FString& MapName);
+
+	/** Called after a map has finished loading */
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	/** Called once the engine has finished initializing */
+	void OnPostEngineInit();
+
+	/** Publishes and resets the per frame gameplay counters */
+	void OnEndFrame();
+
+	/** Delegate handles */
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle PostLoadMapHandle;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle PostEngineInitHandle;
+};